@@ -22,6 +22,8 @@ CREATE TABLE Game (
     id_owner    INTEGER NOT NULL,
     state       TEXT NOT NULL CHECK (state IN ('new', 'active', 'waiting', 'finished')),
     created_at  TEXT NOT NULL,
+    board_size  INTEGER NOT NULL DEFAULT 3 CHECK (board_size BETWEEN 3 AND 15),
+    win_length  INTEGER NOT NULL DEFAULT 3 CHECK (win_length BETWEEN 3 AND board_size),
 
     FOREIGN KEY (id_creator) REFERENCES Player(id_player)
         ON DELETE RESTRICT ON UPDATE CASCADE,
@@ -45,6 +47,9 @@ CREATE TABLE Round (
         ON DELETE CASCADE ON UPDATE CASCADE
 );
 
+-- Active/last round of a game (forfeits and rematches) without scanning the whole history
+CREATE INDEX IF NOT EXISTS idx_round_game_state ON Round (id_game, state);
+
 -- =========================================================
 -- PLAY
 -- =========================================================
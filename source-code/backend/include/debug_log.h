@@ -1,16 +1,56 @@
 #ifndef DEBUG_LOG_H
 #define DEBUG_LOG_H
 
+#include <stdatomic.h>
 #include <stdio.h>
 #include <time.h>
 
 
 // ====== Defining log levels ======
 
+/**
+ * Compile-time switches: a disabled level leaves no code at all in the binary.
+ * Release builds (`make release`, which defines NDEBUG) drop the debug level by default,
+ * every level can be overridden (e.g. `make CPPFLAGS=-DLOG_LEVEL_INFO=0`).
+ */
+#ifndef LOG_LEVEL_INFO
 #define LOG_LEVEL_INFO  1   // Controls info-level logs.
-#define LOG_LEVEL_DEBUG 1   // Controls debug-level logs.
+#endif
+#ifndef LOG_LEVEL_DEBUG
+#  ifdef NDEBUG
+#    define LOG_LEVEL_DEBUG 0
+#  else
+#    define LOG_LEVEL_DEBUG 1
+#  endif
+#endif
+#ifndef LOG_LEVEL_WARN
 #define LOG_LEVEL_WARN  1   // Controls warn-level logs.
+#endif
+#ifndef LOG_LEVEL_ERROR
 #define LOG_LEVEL_ERROR 1   // Controls error-level logs.
+#endif
+
+// Runtime severities, a log line is written only if its severity reaches the level set with log_set_level()
+typedef enum {
+    LOG_SEVERITY_DEBUG = 0,
+    LOG_SEVERITY_INFO,
+    LOG_SEVERITY_WARN,
+    LOG_SEVERITY_ERROR
+} LogSeverity;
+
+// Runtime level used until log_init() reads the `LOG_LEVEL` environment variable
+#ifndef LOG_DEFAULT_SEVERITY
+#define LOG_DEFAULT_SEVERITY LOG_SEVERITY_INFO
+#endif
+
+// ====== Asynchronous backend settings ======
+
+#ifndef LOG_RING_RECORDS
+#define LOG_RING_RECORDS 512        // Log lines buffered per thread, a power of two. A full ring drops the new lines
+#endif
+#ifndef LOG_MESSAGE_SIZE
+#define LOG_MESSAGE_SIZE 512        // Longest message kept, the rest of the line is cut
+#endif
 
 // ====== Defining ANSI colors ======
 
@@ -20,53 +60,79 @@
 #define COLOR_WARN    "\033[33m"    // Yellow
 #define COLOR_ERROR   "\033[31m"    // Red
 
+// ====== Backend (src/log/debug_log.c) ======
+
+extern atomic_int log_runtime_severity;
+
+/**
+ * Starts the writer thread. Before it runs, and after log_shutdown(), log lines are written synchronously.
+ * The runtime level is read from the `LOG_LEVEL` environment variable (`debug`, `info`, `warn` or `error`).
+ */
+int log_init(void);
+// Writes the buffered lines and stops the writer thread, also registered with atexit()
+void log_shutdown(void);
+void log_set_level(LogSeverity severity);
+
+/**
+ * Formats the message into the ring of the calling thread, the writer thread adds the
+ * timestamp and the context and writes it to stderr. It never blocks on the output.
+ */
+void log_write(LogSeverity severity, const char *file, int line, const char *func, const char *format_string, ...)
+    __attribute__((format(printf, 5, 6)));
+
 // ====== Defining macros ======
 
+// True if lines of this severity are written, to skip work done only for logging
+#define LOG_ENABLED(severity) ((int)(severity) >= atomic_load_explicit(&log_runtime_severity, memory_order_relaxed))
+
 /**
  * Base macro. It adds timestamp and contex to the actual print.
- * @param debug_level The debug-level to print.
+ * Arguments are evaluated only if the severity is enabled at runtime.
+ * @param severity The LogSeverity of the print.
  * @param format_string A string that specifies the data to be printed. It may also contain a format specifier as a placeholder to print the value of any variable or value. E.g. "This is my %d message!".
  * @param __VA_ARGS__... The variable/values corresponding to the format specifier.
- */ 
-#define LOG_BASE(debug_level, format_string, ...) do {                              \
-    time_t seconds = time(NULL);                                                    \
-    struct tm timeStruct;                                                           \
-    localtime_r(&seconds, &timeStruct);                                             \
-    fprintf(stderr, "[%02d:%02d:%02d][%s] %s:%d:%s(): " format_string,              \
-            timeStruct.tm_hour, timeStruct.tm_min, timeStruct.tm_sec, debug_level,  \
-            __FILE__, __LINE__, __func__, ##__VA_ARGS__);                           \
+ */
+#define LOG_BASE(severity, format_string, ...) do {                                 \
+    if (LOG_ENABLED(severity))                                                      \
+        log_write(severity, __FILE__, __LINE__, __func__, format_string, ##__VA_ARGS__); \
+} while (0)
+
+// Disabled levels: the call is type-checked but never compiled in, so its arguments don't look unused
+#define LOG_ELIDED(severity, format_string, ...) do {                               \
+    if (0)                                                                          \
+        log_write(severity, __FILE__, __LINE__, __func__, format_string, ##__VA_ARGS__); \
 } while (0)
 
 // Info-level macro
 #if LOG_LEVEL_INFO
-#  define LOG_INFO(format_string, ...)  LOG_BASE(COLOR_INFO "INFO" COLOR_RESET, format_string, ##__VA_ARGS__)
+#  define LOG_INFO(format_string, ...)  LOG_BASE(LOG_SEVERITY_INFO, format_string, ##__VA_ARGS__)
 #else
-#  define LOG_INFO(format_string, ...)
+#  define LOG_INFO(format_string, ...)  LOG_ELIDED(LOG_SEVERITY_INFO, format_string, ##__VA_ARGS__)
 #endif
 
 // Debug-level macro
 #if LOG_LEVEL_DEBUG
-#  define LOG_DEBUG(format_string, ...) LOG_BASE(COLOR_DEBUG "DEBUG" COLOR_RESET, format_string, ##__VA_ARGS__)
+#  define LOG_DEBUG(format_string, ...) LOG_BASE(LOG_SEVERITY_DEBUG, format_string, ##__VA_ARGS__)
 #else
-#  define LOG_DEBUG(format_string, ...)
+#  define LOG_DEBUG(format_string, ...) LOG_ELIDED(LOG_SEVERITY_DEBUG, format_string, ##__VA_ARGS__)
 #endif
 
 // Warn-level macro
 #if LOG_LEVEL_WARN
-#  define LOG_WARN(format_string, ...)  LOG_BASE(COLOR_WARN "WARN" COLOR_RESET, format_string, ##__VA_ARGS__)
+#  define LOG_WARN(format_string, ...)  LOG_BASE(LOG_SEVERITY_WARN, format_string, ##__VA_ARGS__)
 #else
-#  define LOG_WARN(format_string, ...)
+#  define LOG_WARN(format_string, ...)  LOG_ELIDED(LOG_SEVERITY_WARN, format_string, ##__VA_ARGS__)
 #endif
 
 // Error-level macro
 #if LOG_LEVEL_ERROR
-#  define LOG_ERROR(format_string, ...) LOG_BASE(COLOR_ERROR "ERROR" COLOR_RESET, format_string, ##__VA_ARGS__)
+#  define LOG_ERROR(format_string, ...) LOG_BASE(LOG_SEVERITY_ERROR, format_string, ##__VA_ARGS__)
 #else
-#  define LOG_ERROR(format_string, ...)
+#  define LOG_ERROR(format_string, ...) LOG_ELIDED(LOG_SEVERITY_ERROR, format_string, ##__VA_ARGS__)
 #endif
 
 /**
- * Custom debug-level macro for structs. It uses a custom function defined to print a struct. 
+ * Custom debug-level macro for structs. It uses a custom function defined to print a struct.
  * @param print_fn The print function defined for the struct. This function should take `structPointer` as input.
  * @param structPointer The pointer to the struct to print throught `print_fn` function.
  */
@@ -75,4 +141,4 @@
     print_fn(structPointer);                                                        \
 } while (0)
 
-#endif
\ No newline at end of file
+#endif
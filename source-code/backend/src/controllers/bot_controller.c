@@ -0,0 +1,157 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../include/debug_log.h"
+
+#include "bot_controller.h"
+#include "bot_search.h"
+#include "player_controller.h"
+#include "round_controller.h"
+#include "round_registry.h"
+#include "../server/worker_pool.h"
+
+static int64_t bot_id = -1;             // Set by bot_init(), before any request is served
+static WorkerPool bot_pool;
+
+// ==================== Private functions ====================
+
+static int random_password(char *out, size_t size);
+static int play_bot_move(int64_t id_round, int quick);
+static void bot_move_job(void *arg);
+
+// ===========================================================
+
+// Nobody signs in as the bot: its password is random and never stored anywhere else
+static int random_password(char *out, size_t size) {
+
+    unsigned char bytes[24];
+
+    FILE *urandom = fopen("/dev/urandom", "rb");
+    if (!urandom)
+        return -1;
+
+    size_t read = fread(bytes, 1, sizeof(bytes), urandom);
+    fclose(urandom);
+
+    if (read != sizeof(bytes) || size < 2 * sizeof(bytes) + 1)
+        return -1;
+
+    for (size_t i = 0; i < sizeof(bytes); i++)
+        snprintf(out + 2 * i, 3, "%02x", bytes[i]);
+
+    return 0;
+}
+
+int bot_init(void) {
+
+    bot_search_init();
+
+    Player bot;
+    PlayerControllerStatus status = player_find_one_by_nickname(BOT_NICKNAME, &bot);
+
+    if (status == PLAYER_CONTROLLER_NOT_FOUND) {
+        Player botToCreate = {
+            .current_streak = 0,
+            .max_streak = 0,
+            .registration_date = time(NULL)
+        };
+        strcpy(botToCreate.nickname, BOT_NICKNAME);
+        strcpy(botToCreate.email, BOT_EMAIL);
+
+        if (random_password(botToCreate.password, sizeof(botToCreate.password)) < 0) {
+            LOG_ERROR("%s\n", "Failed to generate the bot password");
+            return -1;
+        }
+
+        status = player_create(&botToCreate);
+        if (status == PLAYER_CONTROLLER_OK)
+            status = player_find_one_by_nickname(BOT_NICKNAME, &bot);
+    }
+
+    if (status != PLAYER_CONTROLLER_OK) {
+        LOG_ERROR("Failed to load the bot player: %s\n", return_player_controller_status_to_string(status));
+        return -1;
+    }
+
+    if (worker_pool_init(&bot_pool, BOT_THREADS, BOT_QUEUE_CAPACITY) < 0)
+        return -1;
+
+    bot_id = bot.id_player;
+    LOG_INFO("Bot player %" PRId64 " ready (%d compute threads)\n", bot_id, BOT_THREADS);
+
+    return 0;
+}
+
+void bot_shutdown(void) {
+    worker_pool_shutdown(&bot_pool);
+}
+
+bool bot_is_player(int64_t id_player) {
+    return bot_id > 0 && id_player == bot_id;
+}
+
+int64_t bot_id_player(void) {
+    return bot_id;
+}
+
+/**
+ * Plays the bot move on the current board of the round.
+ * The board is copied and the entry released during the search, round_make_move() checks the move again.
+ * @param quick Choose the move without searching
+ */
+static int play_bot_move(int64_t id_round, int quick) {
+
+    // The round may be over meanwhile (e.g. the opponent left)
+    ActiveRound *active = round_registry_acquire(id_round);
+    if (!active)
+        return 0;
+
+    Board board = active->round.board;
+    int bot_turn = active->id_players[board_current_turn(&board) - 1] == bot_id;
+    round_registry_release(active);
+
+    if (!bot_turn)
+        return 0;
+
+    int row, col;
+    int found = quick ? bot_search_quick_move(&board, &row, &col) : bot_search_move(&board, &row, &col);
+    if (found != 0)
+        return 0;
+
+    int64_t out_id_round;
+    RoundControllerStatus status = round_make_move(id_round, bot_id, row, col, &out_id_round);
+    if (status != ROUND_CONTROLLER_OK) {
+        LOG_WARN("Bot move (%d, %d) on round %" PRId64 " refused: %s\n", row, col, id_round, return_round_controller_status_to_string(status));
+        return -1;
+    }
+
+    return 0;
+}
+
+static void bot_move_job(void *arg) {
+    int64_t id_round = *(int64_t *)arg;
+    free(arg);
+
+    play_bot_move(id_round, 0);
+}
+
+/**
+ * Schedules the bot move of a round, the search runs on the bot pool and never on a request worker.
+ * If the pool is full the bot still answers, with a move chosen without searching.
+ */
+void bot_request_move(int64_t id_round) {
+
+    int64_t *arg = malloc(sizeof(int64_t));
+    if (arg) {
+        *arg = id_round;
+        if (worker_pool_submit(&bot_pool, bot_move_job, arg) == 0)
+            return;
+        free(arg);
+    }
+
+    LOG_WARN("Bot pool busy, round %" PRId64 " gets a quick move\n", id_round);
+    play_bot_move(id_round, 1);
+}
@@ -0,0 +1,31 @@
+#ifndef BOT_CONTROLLER_H
+#define BOT_CONTROLLER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Bot settings, can be overridden at compile time (e.g. `make CPPFLAGS=-DBOT_THREADS=4`)
+#ifndef BOT_THREADS
+#define BOT_THREADS 2                   // Threads searching the bot moves, apart from the request workers
+#endif
+#ifndef BOT_QUEUE_CAPACITY
+#define BOT_QUEUE_CAPACITY 1024         // Bot moves waiting for a compute thread
+#endif
+#ifndef BOT_NICKNAME
+#define BOT_NICKNAME "ls-tris-bot"
+#endif
+#define BOT_EMAIL BOT_NICKNAME "@localhost"
+
+/**
+ * The server bot is an ordinary player (the BOT_NICKNAME account, created on first start)
+ * that has no session: its moves are searched on a dedicated compute pool and played
+ * through round_make_move(), like the ones received from the clients.
+ */
+int bot_init(void);
+void bot_shutdown(void);
+
+bool bot_is_player(int64_t id_player);
+int64_t bot_id_player(void);
+void bot_request_move(int64_t id_round);
+
+#endif
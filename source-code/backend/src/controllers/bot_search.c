@@ -0,0 +1,412 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "bot_search.h"
+
+#define SOLVED_POSITIONS 19683          // 3^9 encodings of a 3x3 board
+#define WIN_SCORE (1 << 30)             // Score of a won position, minus the stones it took
+
+typedef enum {
+    TABLE_EXACT = 0,
+    TABLE_LOWER_BOUND,
+    TABLE_UPPER_BOUND
+} TableFlag;
+
+typedef struct {
+    uint64_t key;                       // Zobrist hash of the position, `0` if the entry is empty
+    int32_t score;
+    int16_t cell;                       // Best cell found, `-1` if none
+    int8_t depth;                       // Plies searched below the position
+    uint8_t flag;                       // TableFlag
+} TableEntry;
+
+typedef struct {
+    int cell;
+    int order;
+} Candidate;
+
+static const int directions[4][2] = { {0, 1}, {1, 0}, {1, 1}, {1, -1} };
+
+// Written by bot_search_init() only, read-only afterwards
+static int8_t solved_score[SOLVED_POSITIONS];
+static int8_t solved_cell[SOLVED_POSITIONS];
+static bool solved[SOLVED_POSITIONS];
+static uint64_t zobrist[2][BOARD_MAX_CELLS];
+
+// Each compute thread keeps its own table, so positions are shared across the moves it searches without locking
+static _Thread_local TableEntry *table;
+
+// ==================== Private functions ====================
+
+static int cell_owner(const Board *board, int cell);
+static uint64_t split_mix(uint64_t *state);
+static int encode_small(const Board *board);
+static int solve_small(const Board *board);
+static uint64_t hash_board(const Board *board);
+static int run_length(const Board *board, int player, int row, int col, int d_row, int d_col);
+static int collect_candidates(const Board *board, int player, Candidate out[BOT_MAX_CANDIDATES]);
+static int evaluate(const Board *board, int player);
+static int negamax(const Board *board, uint64_t key, int depth, int alpha, int beta, int *out_cell);
+
+// ===========================================================
+
+// Player number holding the cell, `0` if it's empty
+static int cell_owner(const Board *board, int cell) {
+    if (board->cells[0][cell / 64] >> (cell % 64) & 1u) return 1;
+    if (board->cells[1][cell / 64] >> (cell % 64) & 1u) return 2;
+    return 0;
+}
+
+static uint64_t split_mix(uint64_t *state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void bot_search_init(void) {
+
+    uint64_t state = 0x5eed;
+    for (int player = 0; player < 2; player++)
+        for (int cell = 0; cell < BOARD_MAX_CELLS; cell++)
+            zobrist[player][cell] = split_mix(&state);
+
+    // Solves every 3x3 position reachable from the empty board (a few thousands)
+    Board empty;
+    board_init(&empty, 3, 3);
+    solve_small(&empty);
+}
+
+// Base-3 encoding of a 3x3 board: cell `i` is the i-th digit, 0 empty, 1 or 2 the player holding it
+static int encode_small(const Board *board) {
+    int code = 0;
+
+    for (int cell = 8; cell >= 0; cell--)
+        code = code * 3 + cell_owner(board, cell);
+
+    return code;
+}
+
+// Exact minimax value of a 3x3 position for the player to move: positive wins, later losses score higher
+static int solve_small(const Board *board) {
+
+    int code = encode_small(board);
+    if (solved[code])
+        return solved_score[code];
+
+    int stones = board->moves[0] + board->moves[1];
+    int best = -10;
+    int best_cell = -1;
+
+    if (board->winner != 0) {
+        best = stones - 10;
+    } else if (board_is_full(board)) {
+        best = 0;
+    } else {
+        int player = board_current_turn(board);
+
+        for (int cell = 0; cell < 9; cell++) {
+            if (cell_owner(board, cell) != 0)
+                continue;
+
+            Board child = *board;
+            board_play(&child, cell / 3, cell % 3, player);
+
+            int score = -solve_small(&child);
+            if (score > best) {
+                best = score;
+                best_cell = cell;
+            }
+        }
+    }
+
+    solved[code] = true;
+    solved_score[code] = (int8_t)best;
+    solved_cell[code] = (int8_t)best_cell;
+
+    return best;
+}
+
+// Positions of different rules never share an entry
+static uint64_t hash_board(const Board *board) {
+    uint64_t state = (uint64_t)board->size << 8 | board->win_length;
+    uint64_t key = split_mix(&state);
+    int cells = board->size * board->size;
+
+    for (int cell = 0; cell < cells; cell++) {
+        int owner = cell_owner(board, cell);
+        if (owner != 0)
+            key ^= zobrist[owner - 1][cell];
+    }
+
+    return key;
+}
+
+// Stones of `player` next to (row, col) on both sides of the line with direction (d_row, d_col)
+static int run_length(const Board *board, int player, int row, int col, int d_row, int d_col) {
+    int size = board->size;
+    int run = 0;
+
+    for (int sign = -1; sign <= 1; sign += 2) {
+        int r = row + sign * d_row;
+        int c = col + sign * d_col;
+
+        while (r >= 0 && r < size && c >= 0 && c < size && cell_owner(board, r * size + c) == player) {
+            run++;
+            r += sign * d_row;
+            c += sign * d_col;
+        }
+    }
+
+    return run;
+}
+
+/**
+ * Empty cells next to a stone, the most promising first: the ones extending the longest lines of
+ * either player, so that wins and blocks are searched before anything else.
+ * @return Number of candidates, `0` if the board is full
+ */
+static int collect_candidates(const Board *board, int player, Candidate out[BOT_MAX_CANDIDATES]) {
+
+    int size = board->size;
+    int opponent = 3 - player;
+    int count = 0;
+
+    if (board->moves[0] + board->moves[1] == 0) {
+        out[0].cell = (size / 2) * size + size / 2;
+        out[0].order = 0;
+        return 1;
+    }
+
+    for (int row = 0; row < size; row++) {
+        for (int col = 0; col < size; col++) {
+
+            int cell = row * size + col;
+            if (cell_owner(board, cell) != 0)
+                continue;
+
+            int neighbours = 0;
+            for (int r = row - 1; r <= row + 1; r++)
+                for (int c = col - 1; c <= col + 1; c++)
+                    if (r >= 0 && r < size && c >= 0 && c < size && cell_owner(board, r * size + c) != 0)
+                        neighbours++;
+
+            if (neighbours == 0)
+                continue;
+
+            int order = neighbours;
+            for (int d = 0; d < 4; d++) {
+                int mine = run_length(board, player, row, col, directions[d][0], directions[d][1]);
+                int theirs = run_length(board, opponent, row, col, directions[d][0], directions[d][1]);
+
+                if (mine >= board->win_length - 1) mine = 4 * board->win_length;
+                if (theirs >= board->win_length - 1) theirs = 3 * board->win_length;
+
+                order += 4 * mine * mine + 3 * theirs * theirs;
+            }
+
+            // Insertion into the sorted list, dropping the worst once full
+            int i = count < BOT_MAX_CANDIDATES ? count++ : BOT_MAX_CANDIDATES;
+            while (i > 0 && out[i - 1].order < order) {
+                if (i < BOT_MAX_CANDIDATES)
+                    out[i] = out[i - 1];
+                i--;
+            }
+            if (i < BOT_MAX_CANDIDATES)
+                out[i] = (Candidate){ .cell = cell, .order = order };
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Static score of a position for `player`: every window of win_length cells still open to a single
+ * player counts for them, four times more for each stone it already holds.
+ */
+static int evaluate(const Board *board, int player) {
+
+    int size = board->size;
+    int length = board->win_length;
+    int score[3] = { 0, 0, 0 };
+
+    for (int d = 0; d < 4; d++) {
+        int d_row = directions[d][0];
+        int d_col = directions[d][1];
+
+        for (int row = 0; row < size; row++) {
+            for (int col = 0; col < size; col++) {
+
+                int end_row = row + (length - 1) * d_row;
+                int end_col = col + (length - 1) * d_col;
+                if (end_row >= size || end_col < 0 || end_col >= size)
+                    continue;
+
+                int count[3] = { 0, 0, 0 };
+                for (int i = 0; i < length; i++)
+                    count[cell_owner(board, (row + i * d_row) * size + col + i * d_col)]++;
+
+                if (count[1] > 0 && count[2] == 0)
+                    score[1] += 1 << (2 * (count[1] < 9 ? count[1] : 9));
+                else if (count[2] > 0 && count[1] == 0)
+                    score[2] += 1 << (2 * (count[2] < 9 ? count[2] : 9));
+            }
+        }
+    }
+
+    return score[player] - score[3 - player];
+}
+
+// Alpha-beta search (negamax form) of the position for the player to move
+static int negamax(const Board *board, uint64_t key, int depth, int alpha, int beta, int *out_cell) {
+
+    int stones = board->moves[0] + board->moves[1];
+
+    // The last move completed a line: the player to move lost, later losses score higher
+    if (board->winner != 0)
+        return stones - WIN_SCORE;
+
+    if (board_is_full(board))
+        return 0;
+
+    int player = board_current_turn(board);
+
+    if (depth == 0)
+        return evaluate(board, player);
+
+    TableEntry *entry = table ? &table[key & (BOT_TABLE_ENTRIES - 1)] : NULL;
+    int table_cell = -1;
+
+    if (entry && entry->key == key) {
+        table_cell = entry->cell;
+
+        if (entry->depth >= depth) {
+            if (entry->flag == TABLE_EXACT) {
+                if (out_cell) *out_cell = entry->cell;
+                return entry->score;
+            }
+            if (entry->flag == TABLE_LOWER_BOUND && entry->score > alpha) alpha = entry->score;
+            if (entry->flag == TABLE_UPPER_BOUND && entry->score < beta) beta = entry->score;
+
+            if (alpha >= beta) {
+                if (out_cell) *out_cell = entry->cell;
+                return entry->score;
+            }
+        }
+    }
+
+    Candidate candidates[BOT_MAX_CANDIDATES];
+    int count = collect_candidates(board, player, candidates);
+
+    // The best cell of a previous search goes first
+    if (table_cell >= 0 && cell_owner(board, table_cell) == 0) {
+        int i = 0;
+        while (i < count && candidates[i].cell != table_cell)
+            i++;
+        if (i == count)
+            i = count < BOT_MAX_CANDIDATES ? count++ : count - 1;
+        for (; i > 0; i--)
+            candidates[i] = candidates[i - 1];
+        candidates[0].cell = table_cell;
+    }
+
+    int alpha_start = alpha;
+    int best = -WIN_SCORE;
+    int best_cell = -1;
+    int size = board->size;
+
+    for (int i = 0; i < count; i++) {
+        int cell = candidates[i].cell;
+
+        Board child = *board;
+        board_play(&child, cell / size, cell % size, player);
+
+        int score = -negamax(&child, key ^ zobrist[player - 1][cell], depth - 1, -beta, -alpha, NULL);
+        if (score > best) {
+            best = score;
+            best_cell = cell;
+        }
+        if (best > alpha)
+            alpha = best;
+        if (alpha >= beta)
+            break;
+    }
+
+    if (entry) {
+        entry->key = key;
+        entry->score = best;
+        entry->cell = (int16_t)best_cell;
+        entry->depth = (int8_t)depth;
+        entry->flag = best <= alpha_start ? TABLE_UPPER_BOUND : best >= beta ? TABLE_LOWER_BOUND : TABLE_EXACT;
+    }
+
+    if (out_cell)
+        *out_cell = best_cell;
+
+    return best;
+}
+
+/**
+ * Chooses the move of the player to move.
+ * Bigger boards are searched with iterative deepening up to BOT_SEARCH_DEPTH plies,
+ * each pass ordering the moves with the table filled by the previous one.
+ * @return 0 on success, -1 if the round is already over
+ */
+int bot_search_move(const Board *board, int *out_row, int *out_col) {
+
+    if (board->winner != 0 || board_is_full(board))
+        return -1;
+
+    int cell = -1;
+
+    if (board->size == 3) {
+        int code = encode_small(board);
+        if (solved[code])
+            cell = solved_cell[code];
+    }
+
+    if (cell < 0) {
+        if (!table)
+            table = calloc(BOT_TABLE_ENTRIES, sizeof(TableEntry));
+
+        uint64_t key = hash_board(board);
+
+        for (int depth = 1; depth <= BOT_SEARCH_DEPTH; depth++) {
+            int found = -1;
+            int score = negamax(board, key, depth, -WIN_SCORE, WIN_SCORE, &found);
+
+            if (found >= 0)
+                cell = found;
+
+            // A forced win or loss doesn't change with a deeper search
+            if (score > WIN_SCORE - BOARD_MAX_CELLS || score < BOARD_MAX_CELLS - WIN_SCORE)
+                break;
+        }
+    }
+
+    if (cell < 0)
+        return -1;
+
+    *out_row = cell / board->size;
+    *out_col = cell % board->size;
+    return 0;
+}
+
+/**
+ * Chooses a move without searching, e.g. when no compute thread can take the search.
+ * @return 0 on success, -1 if the round is already over
+ */
+int bot_search_quick_move(const Board *board, int *out_row, int *out_col) {
+
+    if (board->winner != 0 || board_is_full(board))
+        return -1;
+
+    Candidate candidates[BOT_MAX_CANDIDATES];
+    if (collect_candidates(board, board_current_turn(board), candidates) == 0)
+        return -1;
+
+    *out_row = candidates[0].cell / board->size;
+    *out_col = candidates[0].cell % board->size;
+    return 0;
+}
@@ -0,0 +1,27 @@
+#ifndef BOT_SEARCH_H
+#define BOT_SEARCH_H
+
+#include "../entities/round_entity.h"
+
+// Search settings, can be overridden at compile time (e.g. `make CPPFLAGS=-DBOT_SEARCH_DEPTH=6`)
+#ifndef BOT_SEARCH_DEPTH
+#define BOT_SEARCH_DEPTH 4              // Plies searched on boards bigger than 3x3
+#endif
+#ifndef BOT_MAX_CANDIDATES
+#define BOT_MAX_CANDIDATES 12           // Most promising cells searched at each ply
+#endif
+#ifndef BOT_TABLE_ENTRIES
+#define BOT_TABLE_ENTRIES (1 << 16)     // Transposition table entries of each search thread, a power of two
+#endif
+
+/**
+ * Move selection of the server bot.
+ * 3x3 boards are solved once by bot_search_init(): every reachable position, keyed by its base-3
+ * encoding, already holds its best move. Bigger boards are searched with depth-limited alpha-beta,
+ * memoizing positions in a per-thread transposition table keyed by a Zobrist hash of the board.
+ */
+void bot_search_init(void);
+int bot_search_move(const Board *board, int *out_row, int *out_col);
+int bot_search_quick_move(const Board *board, int *out_row, int *out_col);
+
+#endif
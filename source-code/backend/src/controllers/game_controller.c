@@ -2,162 +2,208 @@
 #include <string.h>
 #include <pthread.h>
 #include <inttypes.h>
+#include <time.h>
 
 #include "../../include/debug_log.h"
 
 #include "game_controller.h"
 #include "round_controller.h"
+#include "round_registry.h"
+#include "bot_controller.h"
+#include "participation_request_controller.h"
 #include "player_controller.h"
 #include "play_controller.h"
 #include "notification_controller.h"
 #include "../json-parser/json-parser.h"
+#include "../server/arena.h"
 #include "../server/server.h"
 #include "../dao/sqlite/db_connection_sqlite.h"
 #include "../dao/sqlite/game_dao_sqlite.h"
 
-typedef struct {
+/**
+ * Rematch offer waiting for the opponent, chained in the bucket of its game.
+ * Offers nobody answers expire after REMATCH_TTL_SECONDS, freed by their timer.
+ */
+typedef struct PendingRematch {
     int64_t id_game;
     int64_t requested_by;
+    time_t expires_at;
+    Timer expiry_timer;
+    struct PendingRematch *next;
 } PendingRematch;
 
-static PendingRematch *g_pending_rematches = NULL;
-static int g_pending_count = 0;
+static PendingRematch *g_pending_rematches[PENDING_REMATCH_BUCKETS];
 static pthread_mutex_t g_pending_mtx = PTHREAD_MUTEX_INITIALIZER;
 
+static size_t pending_bucket(int64_t id_game) {
+    uint64_t h = (uint64_t)id_game;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (size_t)h & (PENDING_REMATCH_BUCKETS - 1);
+}
+
 /**
- * We check if there are pending rematch request for a given id_game
- * return index if found
- * return -1 if not found
+ * Frees the expired offers of a bucket.
+ * Must be called with `g_pending_mtx` held.
  */
-static int pending_find_index(int64_t id_game) {
-    for (int i = 0; i < g_pending_count; i++) {
-        if (g_pending_rematches[i].id_game == id_game) return i;
+static void pending_expire_bucket(size_t bucket, time_t now) {
+    PendingRematch **link = &g_pending_rematches[bucket];
+
+    while (*link) {
+        PendingRematch *entry = *link;
+
+        if (entry->expires_at <= now) {
+            LOG_INFO("Rematch offer of player %" PRId64 " for game %" PRId64 " expired", entry->requested_by, entry->id_game);
+            *link = entry->next;
+            server_timer_cancel(&entry->expiry_timer);
+            free(entry);
+        } else {
+            link = &entry->next;
+        }
     }
-    return -1;
 }
 
+// Expiry timer of an offer, so abandoned offers are freed even if nobody looks their game up again
+static void pending_expire(int64_t id_game) {
+    pthread_mutex_lock(&g_pending_mtx);
+    pending_expire_bucket(pending_bucket(id_game), time(NULL));
+    pthread_mutex_unlock(&g_pending_mtx);
+}
+
+/**
+ * We check if there is a pending rematch request for a given id_game
+ * return the request if found (expired ones are dropped first)
+ * return NULL if not found
+ */
+static PendingRematch *pending_find(int64_t id_game) {
+    size_t bucket = pending_bucket(id_game);
+    pending_expire_bucket(bucket, time(NULL));
+
+    PendingRematch *entry = g_pending_rematches[bucket];
+    while (entry && entry->id_game != id_game)
+        entry = entry->next;
+
+    return entry;
+}
 
 /**
- * Set/update the rematch request
- * if id_game exists then it updates requested_by only 
- * if id_game doesn't exist then it extends the array and add the element at the bottom
+ * Set/update the rematch request, restarting its TTL
+ * if id_game exists then it updates requested_by only
+ * if id_game doesn't exist then it adds a new entry to its bucket
  */
 static int pending_set(int64_t id_game, int64_t requested_by) {
-    int idx = pending_find_index(id_game);
+    PendingRematch *entry = pending_find(id_game);
 
+    if (!entry) {
+        entry = calloc(1, sizeof(PendingRematch));
+        if (!entry) return 0;
 
-    if (idx >= 0) {
-        g_pending_rematches[idx].requested_by = requested_by;
-        return 1;
+        size_t bucket = pending_bucket(id_game);
+        entry->id_game = id_game;
+        entry->next = g_pending_rematches[bucket];
+        g_pending_rematches[bucket] = entry;
     }
 
-    PendingRematch *tmp = realloc(g_pending_rematches, sizeof(PendingRematch) * (g_pending_count + 1));
-    if (!tmp) return 0;
-
-    g_pending_rematches = tmp;
-    g_pending_rematches[g_pending_count].id_game = id_game;
-    g_pending_rematches[g_pending_count].requested_by = requested_by;
-    g_pending_count++;
+    entry->requested_by = requested_by;
+    entry->expires_at = time(NULL) + REMATCH_TTL_SECONDS;
+    server_timer_schedule(&entry->expiry_timer, REMATCH_TTL_SECONDS, pending_expire, id_game);
     return 1;
 }
 
 static void pending_clear(int64_t id_game) {
-    int idx = pending_find_index(id_game);
-    if (idx < 0) return;
+    PendingRematch **link = &g_pending_rematches[pending_bucket(id_game)];
 
-    g_pending_rematches[idx] = g_pending_rematches[g_pending_count - 1];
-    g_pending_count--;
+    while (*link && (*link)->id_game != id_game)
+        link = &(*link)->next;
 
-    if (g_pending_count == 0) {
-        free(g_pending_rematches);
-        g_pending_rematches = NULL;
-    }
+    if (!*link) return;
+
+    PendingRematch *entry = *link;
+    *link = entry->next;
+    server_timer_cancel(&entry->expiry_timer);
+    free(entry);
 }
 
 // This function provides a query by `status`. 
 // @param status Possible values are `new`, `active`, `waiting`, `finished` and `all` (no filter)
-GameControllerStatus games_get_public_info(char *status, GameDTO **out_dtos, int *out_count) {
+GameControllerStatus games_get_public_info(const char *status, GameDTO **out_dtos, int *out_count) {
+    if (status == NULL)
+        return GAME_CONTROLLER_INVALID_INPUT;
+
     LOG_DEBUG("Status: %s\n", status);
 
-    GameStatus queryStatus = GAME_STATUS_INVALID;
+    // The state filter is applied by the query, "all" means no filter
+    const char *queryState = NULL;
     if (strcmp(status, "all") != 0) {
-        queryStatus = string_to_game_status(status);
+        GameStatus queryStatus = string_to_game_status(status);
         if (queryStatus == GAME_STATUS_INVALID)
             return GAME_CONTROLLER_INVALID_INPUT;
+        queryState = game_status_to_string(queryStatus);
     }
 
+    // A single query returns nicknames and owner streaks too
     GameWithPlayerNickname *games = NULL;
     int games_count = 0;
 
-    if (game_find_all_with_player_info(&games, &games_count)
-        == GAME_CONTROLLER_NOT_FOUND) {
+    GameControllerStatus findStatus = game_find_all_with_player_info(queryState, &games, &games_count);
+    if (findStatus != GAME_CONTROLLER_OK)
+        return findStatus;
 
+    if (games_count == 0) {
         *out_dtos = NULL;
         *out_count = 0;
-        return GAME_CONTROLLER_NOT_FOUND;
+        return GAME_CONTROLLER_OK;
     }
 
-    GameDTO *dtos = NULL;
-    int dto_count = 0;
+    GameDTO *dtos = arena_alloc(arena_thread(), games_count * sizeof(GameDTO));
+    if (!dtos)
+        return GAME_CONTROLLER_INTERNAL_ERROR;
 
     for (int i = 0; i < games_count; i++) {
 
-        if (strcmp(status, "all") != 0 &&
-            games[i].state != queryStatus)
-            continue;
-
         Game game = {
             .id_game    = games[i].id_game,
             .state      = games[i].state,
-            .created_at = games[i].created_at
+            .created_at = games[i].created_at,
+            .board_size = games[i].board_size,
+            .win_length = games[i].win_length
         };
 
-        int owner_current_streak = -1;
-        int owner_max_streak     = -1;
-
-        Player owner;
-        if (player_find_one(games[i].id_owner, &owner)
-            == PLAYER_CONTROLLER_OK) {
-
-            owner_current_streak = owner.current_streak;
-            owner_max_streak     = owner.max_streak;
-        }
-
-        GameDTO *tmp = realloc(dtos, (dto_count + 1) * sizeof(GameDTO));
-        if (!tmp) {
-            free(dtos);
-            free(games);
-            return GAME_CONTROLLER_INTERNAL_ERROR;
-        }
-        dtos = tmp;
-
         map_game_with_streak_to_dto(
             &game,
             games[i].creator,
             games[i].owner,
-            owner_current_streak,
-            owner_max_streak,
-            &dtos[dto_count]
+            games[i].owner_current_streak,
+            games[i].owner_max_streak,
+            &dtos[i]
         );
-
-        dto_count++;
     }
 
-    free(games);
-
     *out_dtos  = dtos;
-    *out_count = dto_count;
+    *out_count = games_count;
     return GAME_CONTROLLER_OK;
 }
 
-GameControllerStatus game_start(int64_t id_creator, int64_t* out_id_game) {
+GameControllerStatus game_start(int64_t id_creator, int board_size, int win_length, int64_t* out_id_game) {
+
+    // Board rules not given by the client fall back to the classic 3x3, three in a row
+    if (board_size <= 0)
+        board_size = DEFAULT_BOARD_SIZE;
+    if (win_length <= 0)
+        win_length = DEFAULT_WIN_LENGTH;
+
+    if (!board_rules_valid(board_size, win_length))
+        return GAME_CONTROLLER_INVALID_INPUT;
 
     // Build game to start
     Game gameToStart = {
         .id_creator = id_creator,
         .id_owner = id_creator,
         .created_at = time(NULL),
-        .state = NEW_GAME
+        .state = NEW_GAME,
+        .board_size = board_size,
+        .win_length = win_length
     };
 
     // Create game
@@ -169,12 +215,12 @@ GameControllerStatus game_start(int64_t id_creator, int64_t* out_id_game) {
     NotificationDTO *out_notification_dto = NULL;
     if (notification_new_game(gameToStart.id_game, id_creator, &out_notification_dto) != NOTIFICATION_CONTROLLER_OK)
         return GAME_CONTROLLER_INTERNAL_ERROR;
-    char *json_message = serialize_notification_to_json("server_game_start_notification", out_notification_dto);
+    Message *json_message = serialize_notification_to_json("server_game_start_notification", out_notification_dto);
     if (send_server_broadcast_message(json_message, id_creator) < 0 ) {
+        message_release(json_message);
         return GAME_CONTROLLER_INTERNAL_ERROR;
     }
-    free(json_message);
-    free(out_notification_dto);
+    message_release(json_message);
 
     // Send updated game
     GameDTO out_game_dto;
@@ -194,9 +240,10 @@ GameControllerStatus game_start(int64_t id_creator, int64_t* out_id_game) {
 
     json_message = serialize_games_with_streak_to_json("server_new_game", &out_game_dto, 1);
     if (send_server_broadcast_message(json_message, gameToStart.id_owner) < 0 ) {
+        message_release(json_message);
         return GAME_CONTROLLER_INTERNAL_ERROR;
     }
-    free(json_message);
+    message_release(json_message);
 
     *out_id_game = gameToStart.id_game;
 
@@ -245,11 +292,12 @@ GameControllerStatus game_end(int64_t id_game, int64_t id_owner, int64_t* out_id
         return status;
     }
     map_game_to_dto(&retrievedGame, retrievedGameWithPlayerNickname.creator, retrievedGameWithPlayerNickname.owner, &out_game_dto);
-    char *json_message = serialize_games_to_json("server_end_game", &out_game_dto, 1);
+    Message *json_message = serialize_games_to_json("server_end_game", &out_game_dto, 1);
     if (send_server_broadcast_message(json_message, retrievedGame.id_owner) < 0 ) {
+        message_release(json_message);
         return GAME_CONTROLLER_INTERNAL_ERROR;
     }
-    free(json_message);
+    message_release(json_message);
 
     *out_id_game = retrievedGame.id_game;
 
@@ -277,12 +325,14 @@ GameControllerStatus game_end(int64_t id_game, int64_t id_owner, int64_t* out_id
  *
  * @param id_game   Game identifier
  * @param id_leaver Player who left the game
+ * @param move_deadline Move deadline that expired for a timeout, checked under the round lock. `0` for a player who left
  * @param out_winner Optional output winner id (can be NULL)
  *
- * @return GAME_CONTROLLER_OK on success, or an error code
+ * @return GAME_CONTROLLER_OK on success, GAME_CONTROLLER_STATE_VIOLATION if the round was finished meanwhile
+ *         or the deadline is no longer current, or an error code
  */
 
-GameControllerStatus game_forfeit(int64_t id_game, int64_t id_leaver, int64_t* out_winner) {
+static GameControllerStatus game_forfeit_checked(int64_t id_game, int64_t id_leaver, time_t move_deadline, int64_t* out_winner) {
     Game game;
     GameControllerStatus gstatus = game_find_one(id_game, &game);
     if (gstatus != GAME_CONTROLLER_OK)
@@ -292,39 +342,20 @@ GameControllerStatus game_forfeit(int64_t id_game, int64_t id_leaver, int64_t* o
     if (game.state == FINISHED_GAME)
         return GAME_CONTROLLER_OK;
 
-    /* 1. Find ACTIVE round for this game                  */
-    Round *rounds = NULL;
-    int round_count = 0;
-
-    RoundControllerStatus rstatus = round_find_all(&rounds, &round_count);
-    if (rstatus != ROUND_CONTROLLER_OK && rstatus != ROUND_CONTROLLER_NOT_FOUND)
-        return GAME_CONTROLLER_INTERNAL_ERROR;
-
-    Round *selected_round = NULL;
+    /* 1. Find ACTIVE round for this game, or the last one if none is active */
+    Round selected;
+    Round *selected_round = &selected;
 
-    /* 1. Try to find an ACTIVE round */
-    for (int i = 0; i < round_count; i++) {
-        if (rounds[i].id_game == id_game &&
-            rounds[i].state == ACTIVE_ROUND) {
-            selected_round = &rounds[i];
-            break;
-        }
-    }
-
-    /* 2. Fallback: use the last round of the game (if no ACTIVE one exists) */
-    if (!selected_round) {
-        for (int i = 0; i < round_count; i++) {
-            if (rounds[i].id_game == id_game) {
-                selected_round = &rounds[i];
-            }
-        }
-    }
+    RoundControllerStatus rstatus = round_find_active_by_game(id_game, selected_round);
+    if (rstatus == ROUND_CONTROLLER_NOT_FOUND)
+        rstatus = round_find_last_by_game(id_game, selected_round);
 
-    /* 3. No rounds at all → real NOT_FOUND */
-    if (!selected_round) {
-        free(rounds);
+    /* No rounds at all → real NOT_FOUND */
+    if (rstatus == ROUND_CONTROLLER_NOT_FOUND)
         return GAME_CONTROLLER_NOT_FOUND;
-    }
+
+    if (rstatus != ROUND_CONTROLLER_OK)
+        return GAME_CONTROLLER_INTERNAL_ERROR;
 
     /* 2. Retrieve Play entries for the active round       */
     Play *plays = NULL;
@@ -334,7 +365,6 @@ GameControllerStatus game_forfeit(int64_t id_game, int64_t id_leaver, int64_t* o
         play_find_all_by_id_round(&plays, selected_round->id_round, &play_count);
 
     if (pstatus != PLAY_CONTROLLER_OK || play_count != 2) {
-        free(rounds);
         return GAME_CONTROLLER_INTERNAL_ERROR;
     }
 
@@ -351,11 +381,43 @@ GameControllerStatus game_forfeit(int64_t id_game, int64_t id_leaver, int64_t* o
     }
 
     if (winner < 0 || loser < 0) {
-        free(plays);
-        free(rounds);
         return GAME_CONTROLLER_FORBIDDEN;
     }
 
+    /* Moves are applied in memory: wait for the one in progress and hold the round until it is finalized,
+       so no move lands between the checks below and the writes */
+    ActiveRound *active = NULL;
+    if (selected_round->state == ACTIVE_ROUND) {
+
+        /* The round was read before it was held: another forfeit or the end of the round may have finished it since,
+           and its result must not be applied twice */
+        RoundControllerStatus acquired = round_acquire_active(selected_round->id_round, &active);
+        if (acquired != ROUND_CONTROLLER_OK)
+            return acquired == ROUND_CONTROLLER_STATE_VIOLATION ? GAME_CONTROLLER_STATE_VIOLATION : GAME_CONTROLLER_INTERNAL_ERROR;
+
+        if (round_find_one(selected_round->id_round, selected_round) != ROUND_CONTROLLER_OK) {
+            round_registry_release(active);
+            return GAME_CONTROLLER_INTERNAL_ERROR;
+        }
+
+        if (selected_round->state != ACTIVE_ROUND) {
+            round_registry_release(active);
+            return GAME_CONTROLLER_STATE_VIOLATION;
+        }
+
+        selected_round->board = active->round.board;
+    }
+
+    /* A timeout only applies if the deadline that expired is still the current one: a move made meanwhile
+       re-armed it, and a round that ended meanwhile left the registry */
+    if (move_deadline != 0 && (!active || active->move_deadline != move_deadline)) {
+        if (active)
+            round_registry_release(active);
+        return GAME_CONTROLLER_STATE_VIOLATION;
+    }
+
+    GameControllerStatus status = GAME_CONTROLLER_OK;
+
     /* 4. Update Play results (WIN / LOSE)                 */
     for (int i = 0; i < play_count; i++) {
         if (plays[i].id_player == winner) {
@@ -365,9 +427,8 @@ GameControllerStatus game_forfeit(int64_t id_game, int64_t id_leaver, int64_t* o
         }
 
         if (play_update(&plays[i]) != PLAY_CONTROLLER_OK) {
-            free(plays);
-            free(rounds);
-            return GAME_CONTROLLER_DATABASE_ERROR;
+            status = GAME_CONTROLLER_DATABASE_ERROR;
+            goto release;
         }
     }
                               
@@ -382,9 +443,8 @@ GameControllerStatus game_forfeit(int64_t id_game, int64_t id_leaver, int64_t* o
             p.max_streak = p.current_streak;
 
         if (player_update(&p) != PLAYER_CONTROLLER_OK) {
-            free(plays);
-            free(rounds);
-            return GAME_CONTROLLER_DATABASE_ERROR;
+            status = GAME_CONTROLLER_DATABASE_ERROR;
+            goto release;
         }
     }
 
@@ -395,9 +455,8 @@ GameControllerStatus game_forfeit(int64_t id_game, int64_t id_leaver, int64_t* o
             p.current_streak = 0;
 
             if (player_update(&p) != PLAYER_CONTROLLER_OK) {
-                free(plays);
-                free(rounds);
-                return GAME_CONTROLLER_DATABASE_ERROR;
+                status = GAME_CONTROLLER_DATABASE_ERROR;
+                goto release;
             }
         }
     }
@@ -407,29 +466,85 @@ GameControllerStatus game_forfeit(int64_t id_game, int64_t id_leaver, int64_t* o
         selected_round->state = FINISHED_ROUND;
         selected_round->end_time = (int64_t)time(NULL);
 
-        if (round_update(selected_round) != ROUND_CONTROLLER_OK) {
-            free(plays);
-            free(rounds);
-            return GAME_CONTROLLER_DATABASE_ERROR;
+        if (round_update_state(selected_round) != ROUND_CONTROLLER_OK) {
+            status = GAME_CONTROLLER_DATABASE_ERROR;
+            goto release;
         }
+
+        if (active)
+            round_registry_remove(active);
     }
 
-    /* 7. Finalize Game                                    */
-    game.id_owner = winner;
+    /* 7. Finalize Game (the bot never owns a game: it stays with the player) */
+    game.id_owner = bot_is_player(winner) ? loser : winner;
     game.state = WAITING_GAME;
 
-    gstatus = game_update(&game);
-    if (gstatus != GAME_CONTROLLER_OK) {
-        free(plays);
-        free(rounds);
-        return gstatus;
+    status = game_update(&game);
+    if (status == GAME_CONTROLLER_OK && out_winner)
+        *out_winner = winner;
+
+release:
+    if (active)
+        round_registry_release(active);
+
+    return status;
+}
+
+GameControllerStatus game_forfeit(int64_t id_game, int64_t id_leaver, int64_t* out_winner) {
+    return game_forfeit_checked(id_game, id_leaver, 0, out_winner);
+}
+
+/**
+ * Ends the game of a player who ran out of time to move, through the same path as game_forfeit.
+ * Nothing happens if `move_deadline` is no longer the deadline of the round (a move was made meanwhile).
+ * Both players get the final board, the winner the forfeit notification and everyone the updated game.
+ */
+GameControllerStatus game_forfeit_timeout(int64_t id_game, int64_t id_playerLate, time_t move_deadline) {
+
+    // The round is read before the forfeit finishes it
+    Round round;
+    RoundControllerStatus roundStatus = round_find_active_by_game(id_game, &round);
+    if (roundStatus != ROUND_CONTROLLER_OK)
+        return roundStatus == ROUND_CONTROLLER_NOT_FOUND ? GAME_CONTROLLER_NOT_FOUND : GAME_CONTROLLER_INTERNAL_ERROR;
+
+    int64_t winner = -1;
+    GameControllerStatus status = game_forfeit_checked(id_game, id_playerLate, move_deadline, &winner);
+    if (status != GAME_CONTROLLER_OK)
+        return status;
+
+    RoundDTO round_dto;
+    if (round_find_one(round.id_round, &round) == ROUND_CONTROLLER_OK) {
+        map_round_to_dto(&round, &round_dto);
+        Message *json_round = serialize_rounds_to_json("server_updated_round_end", &round_dto, 1);
+
+        int64_t players[2] = { winner, id_playerLate };
+        for (int i = 0; i < 2; i++) {
+            if (!bot_is_player(players[i]))
+                send_server_unicast_message(json_round, players[i]);
+        }
+        message_release(json_round);
     }
 
-    if (out_winner)
-        *out_winner = winner;
+    NotificationDTO *out_notification = NULL;
+    if (!bot_is_player(winner) && notification_game_forfeit(id_game, winner, id_playerLate, &out_notification) == NOTIFICATION_CONTROLLER_OK) {
+        Message *json_notification = serialize_notification_to_json("server_game_forfeit_notification", out_notification);
+        send_server_unicast_message(json_notification, winner);
+        message_release(json_notification);
+    }
+
+    Game updatedGame;
+    GameWithPlayerNickname info;
+    if (game_find_one(id_game, &updatedGame) == GAME_CONTROLLER_OK &&
+        game_find_one_with_player_info(id_game, &info) == GAME_CONTROLLER_OK) {
+
+        GameDTO dto;
+        map_game_with_streak_to_dto(&updatedGame, info.creator, info.owner, info.owner_current_streak, info.owner_max_streak, &dto);
+
+        Message *json_broadcast = serialize_game_with_streak_to_json("server_game_updated", &dto);
+        send_server_broadcast_message(json_broadcast, -1);
+        message_release(json_broadcast);
+    }
 
-    free(plays);
-    free(rounds);
     return GAME_CONTROLLER_OK;
 }
 
@@ -456,12 +571,12 @@ GameControllerStatus game_refuse_rematch(int64_t id_game, int64_t* out_id_game)
     NotificationDTO *out_notification_dto = NULL;
     if (notification_waiting_game(retrievedGame.id_game, retrievedGame.id_owner, &out_notification_dto) != NOTIFICATION_CONTROLLER_OK)
         return GAME_CONTROLLER_INTERNAL_ERROR;
-    char *json_message = serialize_notification_to_json("server_game_waiting_notification", out_notification_dto);
+    Message *json_message = serialize_notification_to_json("server_game_waiting_notification", out_notification_dto);
     if (send_server_broadcast_message(json_message, retrievedGame.id_owner) < 0 ) {
+        message_release(json_message);
         return GAME_CONTROLLER_INTERNAL_ERROR;
     }
-    free(json_message);
-    free(out_notification_dto);
+    message_release(json_message);
 
     // Send updated game
     GameDTO out_game_dto;
@@ -473,9 +588,10 @@ GameControllerStatus game_refuse_rematch(int64_t id_game, int64_t* out_id_game)
     map_game_to_dto(&retrievedGame, retrievedGameWithPlayerNickname.creator, retrievedGameWithPlayerNickname.owner, &out_game_dto);
     json_message = serialize_games_to_json("server_waiting_game", &out_game_dto, 1);
     if (send_server_broadcast_message(json_message, retrievedGame.id_owner) < 0 ) {
+        message_release(json_message);
         return GAME_CONTROLLER_INTERNAL_ERROR;
     }
-    free(json_message);
+    message_release(json_message);
 
     *out_id_game = retrievedGame.id_game;
 
@@ -487,6 +603,7 @@ GameControllerStatus game_refuse_rematch(int64_t id_game, int64_t* out_id_game)
  *
  * The first player requesting a rematch is put in a waiting state.
  * When the other player also requests a rematch, a new round is created.
+ * An offer the opponent doesn't answer within REMATCH_TTL_SECONDS expires.
  *
  * Active rounds are checked to prevent duplicate rematch creation.
  * No database schema or persistent state is modified.
@@ -513,32 +630,25 @@ GameControllerStatus game_accept_rematch(int64_t id_game, int64_t id_playerAccep
     int64_t new_round_id;
 
     /* Step 1: Prevent duplicate ACTIVE rounds for the same game */
-    Round *rounds = NULL;
-    int count = 0;
-
-    RoundControllerStatus roundStatus1 = round_find_all(&rounds, &count);
-    if (roundStatus1 != ROUND_CONTROLLER_OK && roundStatus1 != ROUND_CONTROLLER_NOT_FOUND)
-        return GAME_CONTROLLER_INTERNAL_ERROR;
-
-    for (int i = 0; i < count; i++) {
-        if (rounds[i].id_game == id_game && rounds[i].state == ACTIVE_ROUND) {
-            LOG_INFO("An ACTIVE round already exists, avoiding duplicate creation");
-            free(rounds);
-            *out_id_game = id_game;
-            if (out_waiting) *out_waiting = 0;
-            return GAME_CONTROLLER_OK;
-        }
+    Round activeRound;
+    RoundControllerStatus roundStatus1 = round_find_active_by_game(id_game, &activeRound);
+    if (roundStatus1 == ROUND_CONTROLLER_OK) {
+        LOG_INFO("An ACTIVE round already exists, avoiding duplicate creation");
+        *out_id_game = id_game;
+        if (out_waiting) *out_waiting = 0;
+        return GAME_CONTROLLER_OK;
     }
 
-    if (rounds) free(rounds);
+    if (roundStatus1 != ROUND_CONTROLLER_NOT_FOUND)
+        return GAME_CONTROLLER_INTERNAL_ERROR;
 
     /* Step 2: In-memory handshake for rematch */
     pthread_mutex_lock(&g_pending_mtx);
 
-    int idx = pending_find_index(id_game);
+    PendingRematch *pending = pending_find(id_game);
 
-    /* First player requests rematch */
-    if (idx < 0) {
+    /* First player requests rematch (or the previous offer expired) */
+    if (!pending) {
         if (!pending_set(id_game, id_playerAcceptingRematch)) {
             pthread_mutex_unlock(&g_pending_mtx);
             return GAME_CONTROLLER_INTERNAL_ERROR;
@@ -548,12 +658,20 @@ GameControllerStatus game_accept_rematch(int64_t id_game, int64_t id_playerAccep
 
         LOG_INFO("Rematch requested by player %" PRId64 ", waiting for opponent", id_playerAcceptingRematch);
 
+        // The bot always accepts a rematch
+        Round lastRound;
+        if (!bot_is_player(id_playerAcceptingRematch) && round_find_last_by_game(id_game, &lastRound) == ROUND_CONTROLLER_OK) {
+            Play botPlay;
+            if (play_find_one(bot_id_player(), lastRound.id_round, &botPlay) == PLAY_CONTROLLER_OK)
+                return game_accept_rematch(id_game, bot_id_player(), out_id_game, out_waiting);
+        }
+
         *out_id_game = id_game;
         if (out_waiting) *out_waiting = 1;
         return GAME_CONTROLLER_OK;
     }
 
-    int64_t firstRequester = g_pending_rematches[idx].requested_by;
+    int64_t firstRequester = pending->requested_by;
 
     /* Same player clicked rematch again */
     if (firstRequester == id_playerAcceptingRematch) {
@@ -582,7 +700,7 @@ GameControllerStatus game_accept_rematch(int64_t id_game, int64_t id_playerAccep
     if (round_find_full_info_by_id_round(new_round_id, &out_full_round) != ROUND_CONTROLLER_OK)
         return GAME_CONTROLLER_INTERNAL_ERROR;
 
-    char *json_new_round_for_rematch = serialize_round_full_to_json("server_round_start", &out_full_round);
+    Message *json_new_round_for_rematch = serialize_round_full_to_json("server_round_start", &out_full_round);
     if (!json_new_round_for_rematch)
         return GAME_CONTROLLER_INTERNAL_ERROR;
 
@@ -592,13 +710,13 @@ GameControllerStatus game_accept_rematch(int64_t id_game, int64_t id_playerAccep
     LOG_INFO("Sending server_round_start to players %" PRId64 " and %" PRId64, id_player1, id_player2);
 
     /* Best-effort delivery: do not fail the rematch if a websocket send fails */
-    if (send_server_unicast_message(json_new_round_for_rematch, id_player1) < 0)
+    if (!bot_is_player(id_player1) && send_server_unicast_message(json_new_round_for_rematch, id_player1) < 0)
         LOG_WARN("Failed to unicast server_round_start to player %" PRId64, id_player1);
 
-    if (send_server_unicast_message(json_new_round_for_rematch, id_player2) < 0)
+    if (!bot_is_player(id_player2) && send_server_unicast_message(json_new_round_for_rematch, id_player2) < 0)
         LOG_WARN("Failed to unicast server_round_start to player %" PRId64, id_player2);
 
-    free(json_new_round_for_rematch);
+    message_release(json_new_round_for_rematch);
 
     LOG_INFO("Rematch accepted, new round started with id_round=%" PRId64, new_round_id);
 
@@ -613,15 +731,13 @@ GameControllerStatus game_cancel(int64_t id_game, int64_t id_owner, int64_t* out
     NotificationDTO *out_notification_dto = NULL;
     if(notification_game_cancel(id_game, id_owner, &out_notification_dto) != NOTIFICATION_CONTROLLER_OK)
         return GAME_CONTROLLER_INTERNAL_ERROR;
-    char *json_message = serialize_notification_to_json("server_game_cancel", out_notification_dto);
+    Message *json_message = serialize_notification_to_json("server_game_cancel", out_notification_dto);
     if (send_server_broadcast_message(json_message, id_owner) < 0 ) {
-        free(json_message);
-        free(out_notification_dto);
+        message_release(json_message);
         return GAME_CONTROLLER_INTERNAL_ERROR;
     }
 
-    free(json_message);
-    free(out_notification_dto);
+    message_release(json_message);
 
     GameControllerStatus status = game_delete(id_game);
 
@@ -635,6 +751,56 @@ GameControllerStatus game_cancel(int64_t id_game, int64_t id_owner, int64_t* out
 
 // ===================== Controllers Helper Functions =====================
 
+/**
+ * Starts a round of the game against the server bot, in place of a participation request.
+ * The owner plays first, the pending participation requests are rejected as on an accept.
+ * @param out_id_round The new round
+ */
+GameControllerStatus game_play_bot(int64_t id_game, int64_t id_owner, int64_t* out_id_round) {
+
+    Game retrievedGame;
+    GameControllerStatus status = game_find_one(id_game, &retrievedGame);
+    if (status != GAME_CONTROLLER_OK)
+        return status;
+
+    if (retrievedGame.id_owner != id_owner || bot_is_player(id_owner))
+        return GAME_CONTROLLER_FORBIDDEN;
+
+    if (retrievedGame.state != NEW_GAME && retrievedGame.state != WAITING_GAME)
+        return GAME_CONTROLLER_STATE_VIOLATION;
+
+    int64_t new_round_id = -1;
+    if (round_start(id_game, id_owner, bot_id_player(), &new_round_id) != ROUND_CONTROLLER_OK)
+        return GAME_CONTROLLER_INTERNAL_ERROR;
+
+    // Nobody else can join now
+    ParticipationRequest *pending = NULL;
+    int count = 0;
+    if (participation_request_find_all_pending_by_id_game(&pending, id_game, &count) != PARTICIPATION_REQUEST_CONTROLLER_OK)
+        return GAME_CONTROLLER_INTERNAL_ERROR;
+
+    ParticipationRequestControllerStatus rejectStatus = participation_request_reject_all(pending, count);
+    if (rejectStatus != PARTICIPATION_REQUEST_CONTROLLER_OK)
+        return GAME_CONTROLLER_INTERNAL_ERROR;
+
+    RoundFullDTO out_full_round;
+    if (round_find_full_info_by_id_round(new_round_id, &out_full_round) != ROUND_CONTROLLER_OK)
+        return GAME_CONTROLLER_INTERNAL_ERROR;
+
+    Message *json_message = serialize_round_full_to_json("server_round_start", &out_full_round);
+    if (!json_message)
+        return GAME_CONTROLLER_INTERNAL_ERROR;
+
+    if (send_server_unicast_message(json_message, id_owner) < 0)
+        LOG_WARN("Failed to unicast server_round_start to player %" PRId64, id_owner);
+
+    message_release(json_message);
+
+    *out_id_round = new_round_id;
+
+    return GAME_CONTROLLER_OK;
+}
+
 GameControllerStatus game_change_owner(int64_t id_game, int64_t id_newOwner) {
 
     Game retrievedGame;
@@ -655,7 +821,7 @@ const char *return_game_controller_status_to_string(GameControllerStatus status)
         case GAME_CONTROLLER_OK:               return "GAME_CONTROLLER_OK";
         case GAME_CONTROLLER_INVALID_INPUT:    return "GAME_CONTROLLER_INVALID_INPUT";
         case GAME_CONTROLLER_NOT_FOUND:        return "GAME_CONTROLLER_NOT_FOUND";
-        // case GAME_CONTROLLER_STATE_VIOLATION:  return "GAME_CONTROLLER_STATE_VIOLATION";
+        case GAME_CONTROLLER_STATE_VIOLATION:  return "GAME_CONTROLLER_STATE_VIOLATION";
         case GAME_CONTROLLER_DATABASE_ERROR:   return "GAME_CONTROLLER_DATABASE_ERROR";
         // case GAME_CONTROLLER_CONFLICT:         return "GAME_CONTROLLER_CONFLICT";
         case GAME_CONTROLLER_FORBIDDEN:        return "GAME_CONTROLLER_FORBIDDEN";
@@ -666,9 +832,9 @@ const char *return_game_controller_status_to_string(GameControllerStatus status)
 
 // Create
 GameControllerStatus game_create(Game* gameToCreate) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     GameDaoStatus status = insert_game(db, gameToCreate);
-    db_close(db);
+    db_release(db);
     if (status != GAME_DAO_OK) {
         LOG_WARN("%s\n", return_game_dao_status_to_string(status));
         return GAME_CONTROLLER_DATABASE_ERROR;
@@ -679,9 +845,9 @@ GameControllerStatus game_create(Game* gameToCreate) {
 
 // Read all
 GameControllerStatus game_find_all(Game **retrievedGameArray, int* retrievedObjectCount) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     GameDaoStatus status = get_all_games(db, retrievedGameArray, retrievedObjectCount);
-    db_close(db);
+    db_release(db);
     if (status != GAME_DAO_OK) {
         LOG_WARN("%s\n", return_game_dao_status_to_string(status));
         return GAME_CONTROLLER_DATABASE_ERROR;
@@ -692,9 +858,9 @@ GameControllerStatus game_find_all(Game **retrievedGameArray, int* retrievedObje
 
 // Read one
 GameControllerStatus game_find_one(int64_t id_game, Game* retrievedGame) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     GameDaoStatus status = get_game_by_id(db, id_game, retrievedGame);
-    db_close(db);
+    db_release(db);
     if (status != GAME_DAO_OK) {
         LOG_WARN("%s\n", return_game_dao_status_to_string(status));
         return status == GAME_DAO_NOT_FOUND ? GAME_CONTROLLER_NOT_FOUND : GAME_CONTROLLER_DATABASE_ERROR;
@@ -705,10 +871,10 @@ GameControllerStatus game_find_one(int64_t id_game, Game* retrievedGame) {
 
 // Update
 GameControllerStatus game_update(Game* updatedGame) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     LOG_INFO("UPDATE GAME_ID: %d", updatedGame->id_game);
     GameDaoStatus status = update_game_by_id(db, updatedGame);
-    db_close(db);
+    db_release(db);
 
     if (status == GAME_DAO_NOT_MODIFIED) {
         LOG_INFO("No changes detected for game %d, skipping update.", updatedGame->id_game);
@@ -725,9 +891,9 @@ GameControllerStatus game_update(Game* updatedGame) {
 
 // Delete
 GameControllerStatus game_delete(int64_t id_game) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     GameDaoStatus status = delete_game_by_id(db, id_game);
-    db_close(db);
+    db_release(db);
     if (status != GAME_DAO_OK) {
         LOG_WARN("%s\n", return_game_dao_status_to_string(status));
         return status == GAME_DAO_NOT_FOUND ? GAME_CONTROLLER_NOT_FOUND : GAME_CONTROLLER_DATABASE_ERROR;
@@ -738,9 +904,9 @@ GameControllerStatus game_delete(int64_t id_game) {
 
 // Read one with player info
 GameControllerStatus game_find_one_with_player_info(int64_t id_game, GameWithPlayerNickname* retrievedGame) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     GameDaoStatus status = get_game_by_id_with_player_info(db, id_game, retrievedGame);
-    db_close(db);
+    db_release(db);
     if (status != GAME_DAO_OK) {
         LOG_WARN("%s\n", return_game_dao_status_to_string(status));
         return status == GAME_DAO_NOT_FOUND ? GAME_CONTROLLER_NOT_FOUND : GAME_CONTROLLER_DATABASE_ERROR;
@@ -750,10 +916,11 @@ GameControllerStatus game_find_one_with_player_info(int64_t id_game, GameWithPla
 }
 
 // Read all with player info
-GameControllerStatus game_find_all_with_player_info(GameWithPlayerNickname **retrievedGameArray, int* retrievedObjectCount) {
-    sqlite3* db = db_open();
-    GameDaoStatus status = get_all_games_with_player_info(db, retrievedGameArray, retrievedObjectCount);
-    db_close(db);
+// Read all, `state` NULL for every game
+GameControllerStatus game_find_all_with_player_info(const char *state, GameWithPlayerNickname **retrievedGameArray, int* retrievedObjectCount) {
+    sqlite3* db = db_acquire();
+    GameDaoStatus status = get_all_games_with_player_info(db, state, retrievedGameArray, retrievedObjectCount);
+    db_release(db);
     if (status != GAME_DAO_OK) {
         LOG_WARN("%s\n", return_game_dao_status_to_string(status));
         return GAME_CONTROLLER_DATABASE_ERROR;
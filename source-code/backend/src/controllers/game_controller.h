@@ -2,16 +2,25 @@
 #define GAME_CONTROLLER_H
 
 #include <stdbool.h>
+#include <time.h>
 
 #include "../entities/game_entity.h"
 #include "../dto/game_dto.h"
 #include "../dao/dto/game_join_player.h"
 
+// Rematch offers, can be overridden at compile time (e.g. `make CPPFLAGS=-DREMATCH_TTL_SECONDS=60`)
+#ifndef REMATCH_TTL_SECONDS
+#define REMATCH_TTL_SECONDS 300         // Seconds an offer waits for the opponent before expiring
+#endif
+#ifndef PENDING_REMATCH_BUCKETS
+#define PENDING_REMATCH_BUCKETS 1024    // Buckets of the pending offers table, a power of two
+#endif
+
 typedef enum {
     GAME_CONTROLLER_OK = 0,
     GAME_CONTROLLER_INVALID_INPUT,
     GAME_CONTROLLER_NOT_FOUND,
-    // GAME_CONTROLLER_STATE_VIOLATION,
+    GAME_CONTROLLER_STATE_VIOLATION,
     GAME_CONTROLLER_DATABASE_ERROR,
     // GAME_CONTROLLER_CONFLICT,
     GAME_CONTROLLER_FORBIDDEN,
@@ -19,13 +28,15 @@ typedef enum {
 } GameControllerStatus;
 
 
-GameControllerStatus games_get_public_info(char *status, GameDTO **out_dtos, int *out_count);
-GameControllerStatus game_start(int64_t id_creator, int64_t* out_id_game);
+GameControllerStatus games_get_public_info(const char *status, GameDTO **out_dtos, int *out_count);
+GameControllerStatus game_start(int64_t id_creator, int board_size, int win_length, int64_t* out_id_game);
 GameControllerStatus game_end(int64_t id_game, int64_t id_owner, int64_t* out_id_game);
 GameControllerStatus game_forfeit(int64_t id_game, int64_t id_leaver, int64_t* out_winner);
+GameControllerStatus game_forfeit_timeout(int64_t id_game, int64_t id_playerLate, time_t move_deadline);
 GameControllerStatus game_refuse_rematch(int64_t id_game, int64_t* out_id_game);
 GameControllerStatus game_accept_rematch(int64_t id_game, int64_t id_playerAcceptingRematch, int64_t* out_id_game, int* out_waiting);
 GameControllerStatus game_cancel(int64_t id_game, int64_t id_owner, int64_t* out_id_game);
+GameControllerStatus game_play_bot(int64_t id_game, int64_t id_owner, int64_t* out_id_round);
 
 // ===================== Controllers Helper Functions =====================
 
@@ -40,7 +51,7 @@ GameControllerStatus game_update(Game* updatedGame);
 GameControllerStatus game_delete(int64_t id_game);
 
 GameControllerStatus game_find_one_with_player_info(int64_t id_game, GameWithPlayerNickname* retrievedGame);
-GameControllerStatus game_find_all_with_player_info(GameWithPlayerNickname **retrievedGameArray, int* retrievedObjectCount);
+GameControllerStatus game_find_all_with_player_info(const char *state, GameWithPlayerNickname **retrievedGameArray, int* retrievedObjectCount);
 
 // Funzione di utilità per messaggi di errore
 const char *return_game_controller_status_to_string(GameControllerStatus status);
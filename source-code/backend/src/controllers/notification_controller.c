@@ -8,6 +8,7 @@
 #include "game_controller.h"
 #include "round_controller.h"
 #include "participation_request_controller.h"
+#include "../server/arena.h"
 
 NotificationControllerStatus notification_rematch_game(int64_t id_game, int64_t id_sender, int64_t id_receiver, NotificationDTO **out_dto) {
 
@@ -20,7 +21,7 @@ NotificationControllerStatus notification_rematch_game(int64_t id_game, int64_t
         return NOTIFICATION_CONTROLLER_FORBIDDEN;
     }
 
-    NotificationDTO *dynamicDTO = malloc(sizeof(NotificationDTO));
+    NotificationDTO *dynamicDTO = arena_alloc(arena_thread(), sizeof(NotificationDTO));
 
     if (dynamicDTO == NULL) {
         LOG_WARN("%s\n", "Memory not allocated");
@@ -62,7 +63,7 @@ NotificationControllerStatus notification_participation_request_cancel(int64_t i
     if (game_status != GAME_CONTROLLER_OK)
         return NOTIFICATION_CONTROLLER_INTERNAL_ERROR;
 
-    NotificationDTO *dynamicDTO = malloc(sizeof(NotificationDTO));
+    NotificationDTO *dynamicDTO = arena_alloc(arena_thread(), sizeof(NotificationDTO));
 
     if (dynamicDTO == NULL) {
         LOG_WARN("%s\n", "Memory not allocated");
@@ -81,9 +82,9 @@ NotificationControllerStatus notification_participation_request_cancel(int64_t i
     return NOTIFICATION_CONTROLLER_OK;
 }
 
-NotificationControllerStatus notification_participation_request_change(int64_t id_request, int64_t id_sender, int64_t id_receiver, char *status, NotificationDTO **out_dto) {
+NotificationControllerStatus notification_participation_request_change(int64_t id_request, int64_t id_sender, int64_t id_receiver, const char *status, NotificationDTO **out_dto) {
 
-    NotificationDTO *dynamicDTO = malloc(sizeof(NotificationDTO));
+    NotificationDTO *dynamicDTO = arena_alloc(arena_thread(), sizeof(NotificationDTO));
 
     if (dynamicDTO == NULL) {
         LOG_WARN("%s\n", "Memory not allocated");
@@ -117,7 +118,7 @@ NotificationControllerStatus notification_new_game(int64_t id_game, int64_t id_s
         return NOTIFICATION_CONTROLLER_FORBIDDEN;
     }
 
-    NotificationDTO *dynamicDTO = malloc(sizeof(NotificationDTO));
+    NotificationDTO *dynamicDTO = arena_alloc(arena_thread(), sizeof(NotificationDTO));
 
     if (dynamicDTO == NULL) {
         LOG_WARN("%s\n", "Memory not allocated");
@@ -147,7 +148,7 @@ NotificationControllerStatus notification_game_cancel(int64_t id_game, int64_t i
         return NOTIFICATION_CONTROLLER_FORBIDDEN;
     }
 
-    NotificationDTO *dynamicDTO = malloc(sizeof(NotificationDTO));
+    NotificationDTO *dynamicDTO = arena_alloc(arena_thread(), sizeof(NotificationDTO));
 
     if (dynamicDTO == NULL) {
         LOG_WARN("%s\n", "Memory not allocated");
@@ -180,7 +181,7 @@ NotificationControllerStatus notification_waiting_game(int64_t id_game, int64_t
         return NOTIFICATION_CONTROLLER_FORBIDDEN;
     }
 
-    NotificationDTO *dynamicDTO = malloc(sizeof(NotificationDTO));
+    NotificationDTO *dynamicDTO = arena_alloc(arena_thread(), sizeof(NotificationDTO));
 
     if (dynamicDTO == NULL) {
         LOG_WARN("%s\n", "Memory not allocated");
@@ -205,7 +206,7 @@ NotificationControllerStatus notification_finished_round(int64_t id_round, int64
     if (status != ROUND_CONTROLLER_OK)
         return NOTIFICATION_CONTROLLER_INTERNAL_ERROR;
 
-    NotificationDTO *dynamicDTO = malloc(sizeof(NotificationDTO));
+    NotificationDTO *dynamicDTO = arena_alloc(arena_thread(), sizeof(NotificationDTO));
 
     if (dynamicDTO == NULL) {
         LOG_WARN("%s\n", "Memory not allocated");
@@ -235,7 +236,7 @@ NotificationControllerStatus notification_game_forfeit(int64_t id_game, int64_t
     if (status != GAME_CONTROLLER_OK)
         return NOTIFICATION_CONTROLLER_INTERNAL_ERROR;
 
-    NotificationDTO *dynamicDTO = malloc(sizeof(NotificationDTO));
+    NotificationDTO *dynamicDTO = arena_alloc(arena_thread(), sizeof(NotificationDTO));
     if (dynamicDTO == NULL) {
         LOG_WARN("%s\n", "Memory not allocated");
         return NOTIFICATION_CONTROLLER_INTERNAL_ERROR;
@@ -10,6 +10,7 @@
 #include "player_controller.h"
 #include "notification_controller.h"
 #include "../json-parser/json-parser.h"
+#include "../server/arena.h"
 #include "../server/server.h"
 #include "../dao/sqlite/db_connection_sqlite.h"
 #include "../dao/sqlite/participation_request_dao_sqlite.h"
@@ -23,7 +24,7 @@ static ParticipationRequestControllerStatus participation_request_accept_helper(
 // This function provides a query by `state` and `id_game`. 
 // @param state Possible values are `pending`, `accepted`, `rejected` and `all` (no filter)
 // @param id_game Possible values are all integer positive number and -1 (no filter)
-ParticipationRequestControllerStatus participation_requests_get_public_info(char *state, int64_t id_game, ParticipationRequestDTO **out_dtos, int *out_count) {
+ParticipationRequestControllerStatus participation_requests_get_public_info(const char *state, int64_t id_game, ParticipationRequestDTO **out_dtos, int *out_count) {
 
     RequestStatus queryState = REQUEST_STATUS_INVALID;
     if (strcmp(state, "all") != 0) {
@@ -53,7 +54,7 @@ ParticipationRequestControllerStatus participation_requests_get_public_info(char
                 .state = retrievedParticipationRequestsWithPlayerNickname[i].state
             };
 
-            dynamicDTOs = realloc(dynamicDTOs, (filteredObjectCount + 1) * sizeof(ParticipationRequestDTO));
+            dynamicDTOs = arena_grow(arena_thread(), dynamicDTOs, filteredObjectCount * sizeof(ParticipationRequestDTO), (filteredObjectCount + 1) * sizeof(ParticipationRequestDTO));
             if (dynamicDTOs == NULL) {
                 LOG_WARN("%s\n", "Memory not allocated");
                 return PARTICIPATION_REQUEST_CONTROLLER_INTERNAL_ERROR;
@@ -95,24 +96,23 @@ ParticipationRequestControllerStatus participation_request_send(int64_t id_game,
     }
     ParticipationRequestDTO out_participation_request_dto; // Build message
     map_participation_request_to_dto(&participationRequestToSend, retrievedPlayer.nickname, &out_participation_request_dto);
-    char *json_message = serialize_participation_requests_to_json("server_new_participation_request", &out_participation_request_dto, 1);
-    if (send_server_unicast_message(json_message, retrievedGame.id_owner) < 0 ) {
-        return PARTICIPATION_REQUEST_CONTROLLER_INTERNAL_ERROR;
-    }
+    Message *json_message = serialize_participation_requests_to_json("server_new_participation_request", &out_participation_request_dto, 1);
+    int sent = send_server_unicast_message(json_message, retrievedGame.id_owner);
+    message_release(json_message);
 
     /**
      * Create participation request only if the session exists
      * Because send_server_unicast_message returns an error if the session doesn't exists
      */
-
-    free(json_message);
+    if (sent < 0)
+        return PARTICIPATION_REQUEST_CONTROLLER_INTERNAL_ERROR;
     
     *out_id_participation_request = participationRequestToSend.id_request;
 
     return PARTICIPATION_REQUEST_CONTROLLER_OK;
 }
 
-ParticipationRequestControllerStatus participation_request_change_state(int64_t id_participation_request, char *newState, int64_t* out_id_participation_request) {
+ParticipationRequestControllerStatus participation_request_change_state(int64_t id_participation_request, const char *newState, int64_t* out_id_participation_request) {
 
     ParticipationRequest req;
     ParticipationRequestControllerStatus status = participation_request_find_one(id_participation_request, &req);
@@ -155,24 +155,23 @@ ParticipationRequestControllerStatus participation_request_change_state(int64_t
             return PARTICIPATION_REQUEST_CONTROLLER_INTERNAL_ERROR;
         }
 
-        char *notif_json = serialize_notification_to_json("server_participation_request_change", notif);
+        Message *notif_json = serialize_notification_to_json("server_participation_request_change", notif);
         send_server_unicast_message(notif_json, notif->id_playerReceiver);
-        free(notif_json);
-        free(notif);
+        message_release(notif_json);
 
-        char *json_owner = serialize_round_full_to_json("server_round_start", &fullRound);
-        char *json_player = serialize_round_full_to_json("server_round_start", &fullRound);
+        Message *json_owner = serialize_round_full_to_json("server_round_start", &fullRound);
+        Message *json_player = serialize_round_full_to_json("server_round_start", &fullRound);
 
         if (!json_owner || !json_player) {
-            free(json_owner);
-            free(json_player);
+            message_release(json_owner);
+            message_release(json_player);
             return PARTICIPATION_REQUEST_CONTROLLER_INTERNAL_ERROR;
         }
 
         // Owner
         if (send_server_unicast_message(json_owner, game.id_owner) < 0) {
-            free(json_owner);
-            free(json_player);
+            message_release(json_owner);
+            message_release(json_player);
             return PARTICIPATION_REQUEST_CONTROLLER_INTERNAL_ERROR;
         }
 
@@ -180,15 +179,15 @@ ParticipationRequestControllerStatus participation_request_change_state(int64_t
 
         // Accepted player
         if (send_server_unicast_message(json_player, req.id_player) < 0) {
-            free(json_owner);
-            free(json_player);
+            message_release(json_owner);
+            message_release(json_player);
             return PARTICIPATION_REQUEST_CONTROLLER_INTERNAL_ERROR;
         }
 
         LOG_INFO("ID OWNER: %d", req.id_player);
 
-        free(json_owner);
-        free(json_player);
+        message_release(json_owner);
+        message_release(json_player);
 
         *out_id_participation_request = req.id_request;
         return PARTICIPATION_REQUEST_CONTROLLER_OK;
@@ -208,13 +207,12 @@ ParticipationRequestControllerStatus participation_request_change_state(int64_t
         return PARTICIPATION_REQUEST_CONTROLLER_INTERNAL_ERROR;
     }
 
-    char *json_message = serialize_notification_to_json("server_participation_request_change", notif);
+    Message *json_message = serialize_notification_to_json("server_participation_request_change", notif);
 
     if (notif->id_playerReceiver > 0)
         send_server_unicast_message(json_message, notif->id_playerReceiver);
 
-    free(json_message);
-    free(notif);
+    message_release(json_message);
 
     *out_id_participation_request = req.id_request;
     return PARTICIPATION_REQUEST_CONTROLLER_OK;
@@ -231,15 +229,15 @@ static ParticipationRequestControllerStatus participation_request_accept_helper(
 
     int64_t new_round_id;
 
+    if (round_start(game.id_game, game.id_owner, id_player, &new_round_id)
+        != ROUND_CONTROLLER_OK)
+        return PARTICIPATION_REQUEST_CONTROLLER_INTERNAL_ERROR;
+
     if (new_round_id <= 0) {
         LOG_ERROR("round_start returned invalid round id: %" PRId64, new_round_id);
         return PARTICIPATION_REQUEST_CONTROLLER_INTERNAL_ERROR;
     }
 
-    if (round_start(game.id_game, game.id_owner, id_player, &new_round_id)
-        != ROUND_CONTROLLER_OK)
-        return PARTICIPATION_REQUEST_CONTROLLER_INTERNAL_ERROR;
-
     // Game → ACTIVE
     game.state = ACTIVE_GAME;
     if (game_update(&game) != GAME_CONTROLLER_OK)
@@ -320,19 +318,17 @@ ParticipationRequestControllerStatus participation_request_reject_all(Participat
             return PARTICIPATION_REQUEST_CONTROLLER_INTERNAL_ERROR;
         }
 
-        char *json_message = serialize_notification_to_json("server_participation_request_change", out_notification_dto);
+        Message *json_message = serialize_notification_to_json("server_participation_request_change", out_notification_dto);
 
         if (out_notification_dto->id_playerReceiver > 0) {
             if (send_server_unicast_message(json_message, out_notification_dto->id_playerReceiver) < 0) {
 
-                free(json_message);
-                free(out_notification_dto);
+                message_release(json_message);
                 return PARTICIPATION_REQUEST_CONTROLLER_INTERNAL_ERROR;
             }
         }
 
-        free(json_message);
-        free(out_notification_dto);
+        message_release(json_message);
     }
 
     return PARTICIPATION_REQUEST_CONTROLLER_OK;
@@ -346,19 +342,18 @@ ParticipationRequestControllerStatus participation_request_cancel(int64_t id_par
         return PARTICIPATION_REQUEST_CONTROLLER_INTERNAL_ERROR;
     }
 
-    char *json_message = serialize_notification_to_json("server_participation_request_cancel", out_notification_dto);
-    LOG_DEBUG("%s", json_message);
+    Message *json_message = serialize_notification_to_json("server_participation_request_cancel", out_notification_dto);
+    if (json_message)
+        LOG_DEBUG("%s\n", message_body(json_message));
 
     if(out_notification_dto->id_playerReceiver > 0) {
         if(send_server_unicast_message(json_message, out_notification_dto->id_playerReceiver) < 0) {
-            free(json_message);
-            free(out_notification_dto);
+            message_release(json_message);
             return PARTICIPATION_REQUEST_CONTROLLER_INTERNAL_ERROR;
         }
     }
 
-    free(json_message);
-    free(out_notification_dto);
+    message_release(json_message);
 
     ParticipationRequestControllerStatus status = participation_request_delete(id_participation_request);
     if (status != PARTICIPATION_REQUEST_CONTROLLER_OK)
@@ -387,9 +382,9 @@ const char *return_participation_request_controller_status_to_string(Participati
 
 // Create
 ParticipationRequestControllerStatus participation_request_create(ParticipationRequest* participationRequestToCreate) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     ParticipationRequestDaoStatus status = insert_participation_request(db, participationRequestToCreate);
-    db_close(db);
+    db_release(db);
     if (status != PARTICIPATION_DAO_REQUEST_OK) {
         LOG_WARN("%s\n", return_participation_request_dao_status_to_string(status));
         return PARTICIPATION_REQUEST_CONTROLLER_DATABASE_ERROR;
@@ -400,9 +395,9 @@ ParticipationRequestControllerStatus participation_request_create(ParticipationR
 
 // Read all
 ParticipationRequestControllerStatus participation_request_find_all(ParticipationRequest **retrievedParticipationRequestArray, int* retrievedObjectCount) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     ParticipationRequestDaoStatus status = get_all_participation_requests(db, retrievedParticipationRequestArray, retrievedObjectCount);
-    db_close(db);
+    db_release(db);
     if (status != PARTICIPATION_DAO_REQUEST_OK) {
         LOG_WARN("%s\n", return_participation_request_dao_status_to_string(status));
         return PARTICIPATION_REQUEST_CONTROLLER_DATABASE_ERROR;
@@ -413,9 +408,9 @@ ParticipationRequestControllerStatus participation_request_find_all(Participatio
 
 // Read one
 ParticipationRequestControllerStatus participation_request_find_one(int64_t id_participation_request, ParticipationRequest* retrievedParticipationRequest) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     ParticipationRequestDaoStatus status = get_participation_request_by_id(db, id_participation_request, retrievedParticipationRequest);
-    db_close(db);
+    db_release(db);
     if (status != PARTICIPATION_DAO_REQUEST_OK) {
         LOG_WARN("%s\n", return_participation_request_dao_status_to_string(status));
         return status == PARTICIPATION_DAO_REQUEST_NOT_FOUND ? PARTICIPATION_REQUEST_CONTROLLER_NOT_FOUND : PARTICIPATION_REQUEST_CONTROLLER_DATABASE_ERROR;
@@ -426,9 +421,9 @@ ParticipationRequestControllerStatus participation_request_find_one(int64_t id_p
 
 // Update
 ParticipationRequestControllerStatus participation_request_update(ParticipationRequest* updatedParticipationRequest) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     ParticipationRequestDaoStatus status = update_participation_request_by_id(db, updatedParticipationRequest);
-    db_close(db);
+    db_release(db);
     if (status != PARTICIPATION_DAO_REQUEST_OK) {
         LOG_WARN("%s\n", return_participation_request_dao_status_to_string(status));
         return PARTICIPATION_REQUEST_CONTROLLER_DATABASE_ERROR;
@@ -439,9 +434,9 @@ ParticipationRequestControllerStatus participation_request_update(ParticipationR
 
 // Delete
 ParticipationRequestControllerStatus participation_request_delete(int64_t id_participation_request) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     ParticipationRequestDaoStatus status = delete_participation_request_by_id(db, id_participation_request);
-    db_close(db);
+    db_release(db);
     if (status != PARTICIPATION_DAO_REQUEST_OK) {
         LOG_WARN("%s\n", return_participation_request_dao_status_to_string(status));
         return status == PARTICIPATION_DAO_REQUEST_NOT_FOUND ? PARTICIPATION_REQUEST_CONTROLLER_NOT_FOUND : PARTICIPATION_REQUEST_CONTROLLER_DATABASE_ERROR;
@@ -452,9 +447,9 @@ ParticipationRequestControllerStatus participation_request_delete(int64_t id_par
 
 // Read one with player info
 ParticipationRequestControllerStatus participation_request_find_one_with_player_info(int64_t id_participation_request, ParticipationRequestWithPlayerNickname* retrievedParticipationRequest) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     ParticipationRequestDaoStatus status = get_participation_request_by_id_with_player_info(db, id_participation_request, retrievedParticipationRequest);
-    db_close(db);
+    db_release(db);
     if (status != PARTICIPATION_DAO_REQUEST_OK) {
         LOG_WARN("%s\n", return_participation_request_dao_status_to_string(status));
         return status == PARTICIPATION_DAO_REQUEST_NOT_FOUND ? PARTICIPATION_REQUEST_CONTROLLER_NOT_FOUND : PARTICIPATION_REQUEST_CONTROLLER_DATABASE_ERROR;
@@ -465,9 +460,9 @@ ParticipationRequestControllerStatus participation_request_find_one_with_player_
 
 // Read all with player info
 ParticipationRequestControllerStatus participation_request_find_all_with_player_info(ParticipationRequestWithPlayerNickname **retrievedParticipationRequestArray, int* retrievedObjectCount) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     ParticipationRequestDaoStatus status = get_all_participation_requests_with_player_info(db, retrievedParticipationRequestArray, retrievedObjectCount);
-    db_close(db);
+    db_release(db);
     if (status != PARTICIPATION_DAO_REQUEST_OK) {
         LOG_WARN("%s\n", return_participation_request_dao_status_to_string(status));
         return PARTICIPATION_REQUEST_CONTROLLER_DATABASE_ERROR;
@@ -478,9 +473,9 @@ ParticipationRequestControllerStatus participation_request_find_all_with_player_
 
 // Read all (state="pending" by id_game)
 ParticipationRequestControllerStatus participation_request_find_all_pending_by_id_game(ParticipationRequest **retrievedParticipationRequestArray, int64_t id_game, int* retrievedObjectCount) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     ParticipationRequestDaoStatus status = get_all_pending_participation_request_by_id_game(db, id_game, retrievedParticipationRequestArray, retrievedObjectCount);
-    db_close(db);
+    db_release(db);
     if (status != PARTICIPATION_DAO_REQUEST_OK) {
         LOG_WARN("%s\n", return_participation_request_dao_status_to_string(status));
         return PARTICIPATION_REQUEST_CONTROLLER_DATABASE_ERROR;
@@ -19,9 +19,9 @@ typedef enum {
 } ParticipationRequestControllerStatus;
 
 
-ParticipationRequestControllerStatus participation_requests_get_public_info(char *state, int64_t id_game, ParticipationRequestDTO **out_dtos, int *out_count);
+ParticipationRequestControllerStatus participation_requests_get_public_info(const char *state, int64_t id_game, ParticipationRequestDTO **out_dtos, int *out_count);
 ParticipationRequestControllerStatus participation_request_send(int64_t id_game, int64_t id_player, int64_t* out_id_participation_request);
-ParticipationRequestControllerStatus participation_request_change_state(int64_t id_participation_request, char *newState, int64_t* out_id_participation_request);
+ParticipationRequestControllerStatus participation_request_change_state(int64_t id_participation_request, const char *newState, int64_t* out_id_participation_request);
 ParticipationRequestControllerStatus participation_request_accept(int64_t id_participation_request, int64_t id_owner);
 ParticipationRequestControllerStatus participation_request_cancel(int64_t id_participation_request, int64_t id_sender, int64_t* out_id_participation_request);
 ParticipationRequestControllerStatus participation_request_reject_all(ParticipationRequest* pendingRequestsToReject, int retrievedObjectCount);
@@ -5,6 +5,7 @@
 #include "play_controller.h"
 #include "../dao/sqlite/db_connection_sqlite.h"
 #include "../dao/sqlite/play_dao_sqlite.h"
+#include "../server/arena.h"
 
 // This function provides a query by `id_player` and `id_round`. 
 // @param id_player Possible values are all integer positive number and -1 (no filter)
@@ -32,7 +33,7 @@ PlayControllerStatus plays_get_public_info(int64_t id_player, int64_t id_round,
                 .result = retrievedPlaysWithPlayerNickname[i].result
             };
 
-            dynamicDTOs = realloc(dynamicDTOs, (filteredObjectCount + 1) * sizeof(PlayDTO));
+            dynamicDTOs = arena_grow(arena_thread(), dynamicDTOs, filteredObjectCount * sizeof(PlayDTO), (filteredObjectCount + 1) * sizeof(PlayDTO));
             if (dynamicDTOs == NULL) {
                 LOG_WARN("%s\n", "Memory not allocated");
                 return PLAY_CONTROLLER_INTERNAL_ERROR;
@@ -187,9 +188,9 @@ const char *return_play_controller_status_to_string(PlayControllerStatus status)
 
 // Create
 PlayControllerStatus play_create(Play* playToCreate) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     PlayDaoStatus status = insert_play(db, playToCreate);
-    db_close(db);
+    db_release(db);
     if (status != PLAY_DAO_OK) {
         LOG_WARN("%s\n", return_play_dao_status_to_string(status));
         return PLAY_CONTROLLER_DATABASE_ERROR;
@@ -200,9 +201,9 @@ PlayControllerStatus play_create(Play* playToCreate) {
 
 // Read all
 PlayControllerStatus play_find_all(Play **retrievedPlayArray, int* retrievedObjectCount) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     PlayDaoStatus status = get_all_plays(db, retrievedPlayArray, retrievedObjectCount);
-    db_close(db);
+    db_release(db);
     if (status != PLAY_DAO_OK) {
         LOG_WARN("%s\n", return_play_dao_status_to_string(status));
         return PLAY_CONTROLLER_DATABASE_ERROR;
@@ -213,9 +214,9 @@ PlayControllerStatus play_find_all(Play **retrievedPlayArray, int* retrievedObje
 
 // Read one
 PlayControllerStatus play_find_one(int64_t id_player, int64_t id_round, Play* retrievedPlay) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     PlayDaoStatus status = get_play_by_pk(db, id_player, id_round, retrievedPlay);
-    db_close(db);
+    db_release(db);
     if (status != PLAY_DAO_OK) {
         LOG_WARN("%s\n", return_play_dao_status_to_string(status));
         return status == PLAY_DAO_NOT_FOUND ? PLAY_CONTROLLER_NOT_FOUND : PLAY_CONTROLLER_DATABASE_ERROR;
@@ -226,9 +227,9 @@ PlayControllerStatus play_find_one(int64_t id_player, int64_t id_round, Play* re
 
 // Update
 PlayControllerStatus play_update(Play* updatedPlay) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     PlayDaoStatus status = update_play_by_pk(db, updatedPlay);
-    db_close(db);
+    db_release(db);
     if (status != PLAY_DAO_OK) {
         LOG_WARN("%s\n", return_play_dao_status_to_string(status));
         return PLAY_CONTROLLER_DATABASE_ERROR;
@@ -239,9 +240,9 @@ PlayControllerStatus play_update(Play* updatedPlay) {
 
 // Delete
 PlayControllerStatus play_delete(int64_t id_player, int64_t id_round) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     PlayDaoStatus status = delete_play_by_pk(db, id_player, id_round);
-    db_close(db);
+    db_release(db);
     if (status != PLAY_DAO_OK) {
         LOG_WARN("%s\n", return_play_dao_status_to_string(status));
         return status == PLAY_DAO_NOT_FOUND ? PLAY_CONTROLLER_NOT_FOUND : PLAY_CONTROLLER_DATABASE_ERROR;
@@ -252,9 +253,9 @@ PlayControllerStatus play_delete(int64_t id_player, int64_t id_round) {
 
 // Read one with player info
 PlayControllerStatus play_find_one_with_player_info(int64_t id_player, int64_t id_round, PlayWithPlayerNickname* retrievedPlay) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     PlayDaoStatus status = get_play_by_pk_with_player_info(db, id_player, id_round, retrievedPlay);
-    db_close(db);
+    db_release(db);
     if (status != PLAY_DAO_OK) {
         LOG_WARN("%s\n", return_play_dao_status_to_string(status));
         return status == PLAY_DAO_NOT_FOUND ? PLAY_CONTROLLER_NOT_FOUND : PLAY_CONTROLLER_DATABASE_ERROR;
@@ -265,9 +266,9 @@ PlayControllerStatus play_find_one_with_player_info(int64_t id_player, int64_t i
 
 // Read all with player info
 PlayControllerStatus play_find_all_with_player_info(PlayWithPlayerNickname **retrievedPlayArray, int* retrievedObjectCount) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     PlayDaoStatus status = get_all_plays_with_player_info(db, retrievedPlayArray, retrievedObjectCount);
-    db_close(db);
+    db_release(db);
     if (status != PLAY_DAO_OK) {
         LOG_WARN("%s\n", return_play_dao_status_to_string(status));
         return PLAY_CONTROLLER_DATABASE_ERROR;
@@ -278,9 +279,9 @@ PlayControllerStatus play_find_all_with_player_info(PlayWithPlayerNickname **ret
 
 // Read all (by id_round)
 PlayControllerStatus play_find_all_by_id_round(Play **retrievedPlayArray, int64_t id_round, int* retrievedObjectCount) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     PlayDaoStatus status = get_all_plays_by_round(db, id_round, retrievedPlayArray, retrievedObjectCount);
-    db_close(db);
+    db_release(db);
     if (status != PLAY_DAO_OK) {
         LOG_WARN("%s\n", return_play_dao_status_to_string(status));
         return PLAY_CONTROLLER_DATABASE_ERROR;
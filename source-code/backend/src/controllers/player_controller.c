@@ -7,8 +7,9 @@
 #include "player_controller.h"
 #include "../dao/sqlite/db_connection_sqlite.h"
 #include "../dao/sqlite/player_dao_sqlite.h"
+#include "../server/arena.h"
 
-PlayerControllerStatus player_get_public_info(char *nickname, PlayerDTO **out_dto, int *out_count) {
+PlayerControllerStatus player_get_public_info(const char *nickname, PlayerDTO **out_dto, int *out_count) {
 
     // Check if there's a player with this nickname
     Player retrievedPlayer;
@@ -18,7 +19,7 @@ PlayerControllerStatus player_get_public_info(char *nickname, PlayerDTO **out_dt
         return PLAYER_CONTROLLER_NOT_FOUND;
     }
 
-    PlayerDTO *dynamicDTO = malloc(sizeof(PlayerDTO));
+    PlayerDTO *dynamicDTO = arena_alloc(arena_thread(), sizeof(PlayerDTO));
 
     if (dynamicDTO == NULL) {
         LOG_WARN("%s\n", "Memory not allocated");
@@ -33,7 +34,7 @@ PlayerControllerStatus player_get_public_info(char *nickname, PlayerDTO **out_dt
     return PLAYER_CONTROLLER_OK;
 }
 
-PlayerControllerStatus player_signup(char *nickname, char *email, char *password) {
+PlayerControllerStatus player_signup(const char *nickname, const char *email, const char *password) {
 
     // Input validation
     if (strlen(nickname) >= NICKNAME_MAX ||
@@ -66,7 +67,7 @@ PlayerControllerStatus player_signup(char *nickname, char *email, char *password
     return player_create(&playerToSignup);
 }
 
-PlayerControllerStatus player_signin(char *nickname, char *password, bool* signedIn, int64_t* out_id_player) {
+PlayerControllerStatus player_signin(const char *nickname, const char *password, bool* signedIn, int64_t* out_id_player) {
 
     *signedIn = false;
 
@@ -105,9 +106,9 @@ const char *return_player_controller_status_to_string(PlayerControllerStatus sta
 // Create
 PlayerControllerStatus player_create(Player* playerToCreate) {
 
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     PlayerDaoStatus status = insert_player(db, playerToCreate);
-    db_close(db);
+    db_release(db);
     if (status != PLAYER_DAO_OK) {
         LOG_WARN("%s\n", return_player_dao_status_to_string(status));
         return PLAYER_CONTROLLER_DATABASE_ERROR;
@@ -118,9 +119,9 @@ PlayerControllerStatus player_create(Player* playerToCreate) {
 
 // Read all
 PlayerControllerStatus player_find_all(Player **retrievedPlayerArray, int* retrievedObjectCount) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     PlayerDaoStatus status = get_all_players(db, retrievedPlayerArray, retrievedObjectCount);
-    db_close(db);
+    db_release(db);
     if (status != PLAYER_DAO_OK) {
         LOG_WARN("%s\n", return_player_dao_status_to_string(status));
         return PLAYER_CONTROLLER_DATABASE_ERROR;
@@ -131,9 +132,9 @@ PlayerControllerStatus player_find_all(Player **retrievedPlayerArray, int* retri
 
 // Read one
 PlayerControllerStatus player_find_one(int64_t id_player, Player* retrievedPlayer) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     PlayerDaoStatus status = get_player_by_id(db, id_player, retrievedPlayer);
-    db_close(db);
+    db_release(db);
     if (status != PLAYER_DAO_OK) {
         LOG_WARN("%s\n", return_player_dao_status_to_string(status));
         return status == PLAYER_DAO_NOT_FOUND ? PLAYER_CONTROLLER_NOT_FOUND : PLAYER_CONTROLLER_DATABASE_ERROR;
@@ -144,9 +145,9 @@ PlayerControllerStatus player_find_one(int64_t id_player, Player* retrievedPlaye
 
 // Update
 PlayerControllerStatus player_update(Player* updatedPlayer) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     PlayerDaoStatus status = update_player_by_id(db, updatedPlayer);
-    db_close(db);
+    db_release(db);
 
     if (status == PLAYER_DAO_OK || status == PLAYER_DAO_NOT_MODIFIED) {
         return PLAYER_CONTROLLER_OK;
@@ -158,9 +159,9 @@ PlayerControllerStatus player_update(Player* updatedPlayer) {
 
 // Delete
 PlayerControllerStatus player_delete(int64_t id_player) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     PlayerDaoStatus status = delete_player_by_id(db, id_player);
-    db_close(db);
+    db_release(db);
     if (status != PLAYER_DAO_OK) {
         LOG_WARN("%s\n", return_player_dao_status_to_string(status));
         return status == PLAYER_DAO_NOT_FOUND ? PLAYER_CONTROLLER_NOT_FOUND : PLAYER_CONTROLLER_DATABASE_ERROR;
@@ -171,9 +172,9 @@ PlayerControllerStatus player_delete(int64_t id_player) {
 
 // Read one (by nickname)
 PlayerControllerStatus player_find_one_by_nickname(const char *nickname, Player* retrievedPlayer) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     PlayerDaoStatus status = get_player_by_nickname(db, nickname, retrievedPlayer);
-    db_close(db);
+    db_release(db);
     if (status != PLAYER_DAO_OK) {
         LOG_WARN("%s\n", return_player_dao_status_to_string(status));
         return status == PLAYER_DAO_NOT_FOUND ? PLAYER_CONTROLLER_NOT_FOUND : PLAYER_CONTROLLER_DATABASE_ERROR;
@@ -184,9 +185,9 @@ PlayerControllerStatus player_find_one_by_nickname(const char *nickname, Player*
 
 // Read one (by email)
 PlayerControllerStatus player_find_one_by_email(const char *email, Player* retrievedPlayer) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     PlayerDaoStatus status = get_player_by_email(db, email, retrievedPlayer);
-    db_close(db);
+    db_release(db);
     if (status != PLAYER_DAO_OK) {
         LOG_WARN("%s\n", return_player_dao_status_to_string(status));
         return status == PLAYER_DAO_NOT_FOUND ? PLAYER_CONTROLLER_NOT_FOUND : PLAYER_CONTROLLER_DATABASE_ERROR;
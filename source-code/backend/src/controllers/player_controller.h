@@ -20,9 +20,9 @@ typedef enum {
 } PlayerControllerStatus;
 
 
-PlayerControllerStatus player_get_public_info(char *nickname, PlayerDTO **out_dto, int *out_count);
-PlayerControllerStatus player_signup(char *nickname, char *email, char *password);
-PlayerControllerStatus player_signin(char *nickname, char *password, bool* signedIn, int64_t* out_id_player);
+PlayerControllerStatus player_get_public_info(const char *nickname, PlayerDTO **out_dto, int *out_count);
+PlayerControllerStatus player_signup(const char *nickname, const char *email, const char *password);
+PlayerControllerStatus player_signin(const char *nickname, const char *password, bool* signedIn, int64_t* out_id_player);
 
 // ===================== CRUD Operations =====================
 
@@ -1,3 +1,4 @@
+#include <inttypes.h>
 #include <stdbool.h>
 #include <string.h>
 #include <stdlib.h>
@@ -10,125 +11,26 @@
 #include "play_controller.h"
 #include "player_controller.h"
 #include "notification_controller.h"
+#include "round_registry.h"
+#include "bot_controller.h"
 #include "../json-parser/json-parser.h"
+#include "../server/arena.h"
 #include "../server/server.h"
 #include "../dao/sqlite/db_connection_sqlite.h"
 #include "../dao/sqlite/round_dao_sqlite.h"
 
 // ==================== Private functions ====================
 
-static char find_horizontal_winner(char board[BOARD_MAX]);
-static char find_vertical_winner(char board[BOARD_MAX]);
-static char find_diagonal_winner(char board[BOARD_MAX]);
-static char find_winner(char board[BOARD_MAX]);
-static bool is_draw(char board[BOARD_MAX]);
-static bool is_valid_move(char board[BOARD_MAX], int row, int col);
-static int get_current_turn(char *board);
-static RoundControllerStatus round_start_helper(int64_t id_game, Round* out_newRound);
-static RoundControllerStatus round_end_helper(Round* roundToEnd, int64_t id_playerEndingRound, PlayResult result);
+static RoundControllerStatus round_start_helper(const Game *game, Round* out_newRound);
+static RoundControllerStatus round_end_persist(Round* roundToEnd, PlayResult result, int64_t* out_id_playerWinner, Game* out_game);
+static RoundControllerStatus round_end_commit(Round* roundToEnd, PlayResult result, int64_t* out_id_playerWinner, Game* out_game);
+static void round_end_notify(const Round* endedRound, int64_t id_playerEndingRound, PlayResult result, int64_t id_playerWinner, const Game* game);
+static void round_arm_move_timer(ActiveRound *active);
+static void round_move_timeout(int64_t id_round);
 
 
 // ===========================================================
 
-static char find_horizontal_winner(char board[BOARD_MAX]) {
-    char winner = NO_SYMBOL;
-
-    // First row
-    if (board[BOARD_ROWS*0 + 0] == board[BOARD_ROWS*0 + 1] && board[BOARD_ROWS*0 + 1] == board[BOARD_ROWS*0 + 2]
-        && board[BOARD_ROWS*0 + 1] != EMPTY_SYMBOL)
-        winner = board[BOARD_ROWS*0 + 1];
-    // Second row
-    else if (board[BOARD_ROWS*1 + 0] == board[BOARD_ROWS*1 + 1] && board[BOARD_ROWS*1 + 1] == board[BOARD_ROWS*1 + 2]
-        && board[BOARD_ROWS*1 + 1] != EMPTY_SYMBOL)
-        winner = board[BOARD_ROWS*1 + 1];
-    // Third row
-    else if (board[BOARD_ROWS*2 + 0] == board[BOARD_ROWS*2 + 1] && board[BOARD_ROWS*2 + 1] == board[BOARD_ROWS*2 + 2]
-        && board[BOARD_ROWS*2 + 1] != EMPTY_SYMBOL)
-        winner = board[BOARD_ROWS*2 + 1];
-
-    return winner;        
-}
-
-static char find_vertical_winner(char board[BOARD_MAX]) {
-    char winner = NO_SYMBOL;
-
-    // First column
-    if (board[BOARD_ROWS*0 + 0] == board[BOARD_ROWS*1 + 0] && board[BOARD_ROWS*1 + 0] == board[BOARD_ROWS*2 + 0]
-        && board[BOARD_ROWS*1 + 0] != EMPTY_SYMBOL)
-        winner = board[BOARD_ROWS*1 + 0];
-    // Second column
-    else if (board[BOARD_ROWS*0 + 1] == board[BOARD_ROWS*1 + 1] && board[BOARD_ROWS*1 + 1] == board[BOARD_ROWS*2 + 1]
-        && board[BOARD_ROWS*1 + 1] != EMPTY_SYMBOL)
-        winner = board[BOARD_ROWS*1 + 1];
-    // Third column
-    else if (board[BOARD_ROWS*0 + 2] == board[BOARD_ROWS*1 + 2] && board[BOARD_ROWS*1 + 2] == board[BOARD_ROWS*2 + 2]
-        && board[BOARD_ROWS*1 + 2] != EMPTY_SYMBOL)
-        winner = board[BOARD_ROWS*1 + 2];
-
-    return winner;        
-}
-
-static char find_diagonal_winner(char board[BOARD_MAX]) {
-    char winner = NO_SYMBOL;
-
-    // Principal diagonal
-    if (board[BOARD_ROWS*0 + 0] == board[BOARD_ROWS*1 + 1] && board[BOARD_ROWS*1 + 1] == board[BOARD_ROWS*2 + 2]
-        && board[BOARD_ROWS*1 + 1] != EMPTY_SYMBOL)
-        winner = board[BOARD_ROWS*1 + 1];
-    // Secondary diagonal
-    else if (board[BOARD_ROWS*0 + 2] == board[BOARD_ROWS*1 + 1] && board[BOARD_ROWS*1 + 1] == board[BOARD_ROWS*2 + 0]
-        && board[BOARD_ROWS*1 + 1] != EMPTY_SYMBOL)
-        winner = board[BOARD_ROWS*1 + 1];
-
-    return winner;        
-}
-
-static char find_winner(char board[BOARD_MAX]) {
-    char winner = NO_SYMBOL;
-
-    if (strlen(board)+1 == BOARD_MAX) { // strlen(board) will return the number of char (without trailing '\0')
-        winner = find_horizontal_winner(board);
-    
-        if (winner == NO_SYMBOL) {
-            winner = find_vertical_winner(board);
-    
-            if (winner == NO_SYMBOL) {
-                winner = find_diagonal_winner(board);
-            }
-        }
-    } else {
-        LOG_WARN("This board has not a valid dimension! It should be a %dx%d board.\n", BOARD_ROWS, BOARD_COLS);
-    }
-
-    return winner;
-}
-
-static bool is_draw(char board[BOARD_MAX]) {
-    return strchr(board, EMPTY_SYMBOL) == NULL;
-}
-
-static bool is_valid_move(char board[BOARD_MAX], int row, int col) {
-    bool valid = false;
-
-    char cell = get_round_board_cell(board, row, col);
-
-    if (cell == EMPTY_SYMBOL)
-        valid = true;
-
-    return valid;
-}
-
-static int get_current_turn(char *board) {
-    int p1 = 0, p2 = 0;
-
-    for (int i = 0; i < BOARD_MAX; i++) {
-        if (board[i] == P1_SYMBOL) p1++;
-        else if (board[i] == P2_SYMBOL) p2++;
-    }
-
-    return p1 <= p2 ? 1 : 2;
-}
-
 RoundControllerStatus round_get_public_info(int64_t id_round, RoundDTO **out_dto, int *out_count) {
 
     // Check if there's a round with this id_round
@@ -139,7 +41,7 @@ RoundControllerStatus round_get_public_info(int64_t id_round, RoundDTO **out_dto
         return ROUND_CONTROLLER_NOT_FOUND;
     }
 
-    RoundDTO *dynamicDTO = malloc(sizeof(RoundDTO));
+    RoundDTO *dynamicDTO = arena_alloc(arena_thread(), sizeof(RoundDTO));
 
     if (dynamicDTO == NULL) {
         LOG_WARN("%s\n", "Memory not allocated");
@@ -156,115 +58,152 @@ RoundControllerStatus round_get_public_info(int64_t id_round, RoundDTO **out_dto
 
 RoundControllerStatus round_make_move(int64_t id_round, int64_t id_playerMoving, int row, int col, int64_t* out_id_round) {
 
-    // Retrieve round
-    Round retrievedRound;
-    RoundControllerStatus roundStatus = round_find_one(id_round, &retrievedRound);
-    if (roundStatus != ROUND_CONTROLLER_OK)
-        return roundStatus;
+    // Retrieve round: the entry stays locked until the move has been persisted and notified
+    ActiveRound *active;
+    RoundControllerStatus status = round_acquire_active(id_round, &active);
+    if (status != ROUND_CONTROLLER_OK)
+        return status;
 
-    // Validate round
-    if (retrievedRound.state != ACTIVE_ROUND)
+    // A won round is over even if it could not be closed yet
+    if (active->round.board.winner != 0) {
+        round_registry_release(active);
         return ROUND_CONTROLLER_STATE_VIOLATION;
+    }
 
     // Retrieve current player_number
     int player_number;
-    PlayControllerStatus playStatus = play_retrieve_round_current_player_number(id_round, id_playerMoving, &player_number);
-    if (playStatus != PLAY_CONTROLLER_OK) {
-        LOG_WARN("%s\n", return_play_controller_status_to_string(playStatus));
-        return ROUND_CONTROLLER_INTERNAL_ERROR;
+    if (active->id_players[0] == id_playerMoving) {
+        player_number = 1;
+    } else if (active->id_players[1] == id_playerMoving) {
+        player_number = 2;
+    } else {
+        round_registry_release(active);
+        return ROUND_CONTROLLER_FORBIDDEN;
     }
-        
+
     // Check if it's the right turn
-    if (player_number != get_current_turn(retrievedRound.board))
+    if (player_number != board_current_turn(&active->round.board)) {
+        round_registry_release(active);
         return ROUND_CONTROLLER_FORBIDDEN;
+    }
 
-    // Make move
-    if (is_valid_move(retrievedRound.board, row, col)) {
-        set_round_board_cell(retrievedRound.board, row, col, player_number_to_symbol(player_number));
-    } else {
+    // Make move on a copy, memory is updated only once the database has it
+    Round updatedRound = active->round;
+    if (board_play(&updatedRound.board, row, col, player_number) != 0) {
+        round_registry_release(active);
         return ROUND_CONTROLLER_INVALID_INPUT;
     }
 
-    // Check win/draw conditions
+    // Check win/draw conditions, the board already checked the lines through the new cell
     PlayResult result;
-    char winner = find_winner(retrievedRound.board);
-    if (winner == NO_SYMBOL) {
-        if (is_draw(retrievedRound.board)) {
-            result = DRAW;
-        } else {
-            result = PLAY_RESULT_INVALID;
-        }
-    } else {
+    if (updatedRound.board.winner != 0) {
         result = WIN;
+    } else if (board_is_full(&updatedRound.board)) {
+        result = DRAW;
+    } else {
+        result = PLAY_RESULT_INVALID;
     }
 
-    // Update round
-    RoundControllerStatus status = round_update(&retrievedRound);
-    if (status != ROUND_CONTROLLER_OK)
+    // Update round (write-through): the entry holds the previous state until the database has the new one.
+    // The final move is written with the round end, in the same transaction
+    int64_t id_playerWinner = -1;
+    Game game;
+    if (result == PLAY_RESULT_INVALID)
+        status = round_update_board(&updatedRound);
+    else
+        status = round_end_commit(&updatedRound, result, &id_playerWinner, &game);
+
+    if (status != ROUND_CONTROLLER_OK) {
+        round_registry_release(active);
         return status;
+    }
 
-    // Send updated round move
-    Play* retrievedPlayArray;
-    int retrievedPlayCount;
-    playStatus = play_find_all_by_id_round(&retrievedPlayArray, retrievedRound.id_round, &retrievedPlayCount);
-    if (playStatus != PLAY_CONTROLLER_OK || retrievedPlayCount <= 0)
-        return ROUND_CONTROLLER_INTERNAL_ERROR;
+    active->round = updatedRound;
+
+    // Send updated round move. Delivery is best-effort: the move is already applied, so a player
+    // who can't be reached must not keep the round from ending or from getting its next deadline
     RoundDTO out_round_dto;
-    map_round_to_dto(&retrievedRound, &out_round_dto);
-    char *json_message = serialize_rounds_to_json("server_updated_round_move", &out_round_dto, 1);
-    for (int i=0; i<retrievedPlayCount; i++) { // Send to all player except the player moving
-            if (send_server_unicast_message(json_message, retrievedPlayArray[i].id_player) < 0 )
-                return ROUND_CONTROLLER_INTERNAL_ERROR;
+    map_round_to_dto(&active->round, &out_round_dto);
+    Message *json_message = serialize_rounds_to_json("server_updated_round_move", &out_round_dto, 1);
+    for (int i=0; i<2; i++) {
+        if (bot_is_player(active->id_players[i]))
+            continue;
+        if (send_server_unicast_message(json_message, active->id_players[i]) < 0)
+            LOG_WARN("Move of round %" PRId64 " not delivered to player %" PRId64 "\n", id_round, active->id_players[i]);
     }
-    free(json_message);
+    message_release(json_message);
+
+    *out_id_round = active->round.id_round;
 
     // If match is over
+    int64_t id_playerNext = -1;
     if (result != PLAY_RESULT_INVALID) {
-        RoundControllerStatus endStatus = round_end_helper(&retrievedRound, -1, result);
-        if (endStatus != ROUND_CONTROLLER_OK)
-            return endStatus;
-
-        *out_id_round = retrievedRound.id_round;
-        return ROUND_CONTROLLER_OK;
+        round_end_notify(&active->round, -1, result, id_playerWinner, &game);
+        round_registry_remove(active);
+    } else {
+        id_playerNext = active->id_players[board_current_turn(&active->round.board) - 1];
+        round_arm_move_timer(active);
     }
 
-    *out_id_round = retrievedRound.id_round;
+    round_registry_release(active);
+
+    // The bot answers from its own pool, once the round is free again
+    if (bot_is_player(id_playerNext))
+        bot_request_move(id_round);
 
     return ROUND_CONTROLLER_OK;
 }
 
 RoundControllerStatus round_end(int64_t id_round, int64_t id_playerEndingRound, int64_t* out_id_round) {
     
-    // Retrieve round to end
-    Round retrievedRound;
-    RoundControllerStatus status = round_find_one(id_round, &retrievedRound);
-    if (status != ROUND_CONTROLLER_OK)
-        return status;
+    // Retrieve round to end, waiting for a move in progress
+    ActiveRound *active;
+    RoundControllerStatus status = round_acquire_active(id_round, &active);
 
-    if (retrievedRound.state == FINISHED_ROUND) {
-        *out_id_round = retrievedRound.id_round;
+    if (status == ROUND_CONTROLLER_STATE_VIOLATION) {
+        *out_id_round = id_round;
         return ROUND_CONTROLLER_OK;
     }
 
-    status = round_end_helper(&retrievedRound, id_playerEndingRound, DRAW);
     if (status != ROUND_CONTROLLER_OK)
         return status;
 
-    *out_id_round = retrievedRound.id_round;
+    // The entry stays in the registry, unchanged, unless the round end is committed
+    Round endedRound = active->round;
+    int64_t id_playerWinner = -1;
+    Game game;
+
+    status = round_end_commit(&endedRound, DRAW, &id_playerWinner, &game);
+    if (status != ROUND_CONTROLLER_OK) {
+        round_registry_release(active);
+        return status;
+    }
+
+    round_end_notify(&endedRound, id_playerEndingRound, DRAW, id_playerWinner, &game);
+
+    round_registry_remove(active);
+    round_registry_release(active);
+
+    *out_id_round = id_round;
 
     return ROUND_CONTROLLER_OK;
 }
 
-static RoundControllerStatus round_end_helper(Round* roundToEnd, int64_t id_playerEndingRound, PlayResult result) {
-    
+/**
+ * Database side of round_end_commit(), it must run inside a transaction.
+ * @param out_id_playerWinner Winner of the round, `-1` on a draw
+ * @param out_game Game of the round, filled only when there is a winner
+ */
+static RoundControllerStatus round_end_persist(Round* roundToEnd, PlayResult result, int64_t* out_id_playerWinner, Game* out_game) {
+
     // 1. Set round status and timestamp
     roundToEnd->state = FINISHED_ROUND;
     roundToEnd->end_time = (int64_t)time(NULL);
 
     // 2. Determine the winner symbol (if not a draw)
     char winner_symbol = NO_SYMBOL;
-    if (result != DRAW)
-        winner_symbol = find_winner(roundToEnd->board);
+    if (result != DRAW && roundToEnd->board.winner != 0)
+        winner_symbol = player_number_to_symbol(roundToEnd->board.winner);
 
     LOG_INFO("WINNER SYMBOL: %c", winner_symbol);
 
@@ -284,11 +223,13 @@ static RoundControllerStatus round_end_helper(Round* roundToEnd, int64_t id_play
 
     if (playStatus != PLAY_CONTROLLER_NOT_FOUND) {
         
-        // A. Transfer game ownership to the winner
-        GameControllerStatus gameStatus = game_change_owner(roundToEnd->id_game, id_playerWinner);
-        if (gameStatus != GAME_CONTROLLER_OK) {
-            LOG_WARN("%s\n", return_game_controller_status_to_string(gameStatus));
-            return ROUND_CONTROLLER_INTERNAL_ERROR;
+        // A. Transfer game ownership to the winner, unless it's the bot: the game stays with the player
+        if (!bot_is_player(id_playerWinner)) {
+            GameControllerStatus gameStatus = game_change_owner(roundToEnd->id_game, id_playerWinner);
+            if (gameStatus != GAME_CONTROLLER_OK) {
+                LOG_WARN("%s\n", return_game_controller_status_to_string(gameStatus));
+                return ROUND_CONTROLLER_INTERNAL_ERROR;
+            }
         }
 
         // B. Retrieve all plays to identify the loser
@@ -307,9 +248,6 @@ static RoundControllerStatus round_end_helper(Round* roundToEnd, int64_t id_play
                 id_playerLoser = all_play_by_round[i].id_player;
             }
         }
-        
-        // IMPORTANT: Free the memory allocated by play_find_all_by_id_round
-        if (all_play_by_round) free(all_play_by_round);
 
         // C. Update Loser Streak (Reset to 0)
         if(id_playerLoser > 0) {
@@ -348,102 +286,138 @@ static RoundControllerStatus round_end_helper(Round* roundToEnd, int64_t id_play
 
         // E. Reset Game State to WAITING
         // The winner stays as owner, the game waits for a new challenger.
-        Game game;
-        if (game_find_one(roundToEnd->id_game, &game) != GAME_CONTROLLER_OK)
+        if (game_find_one(roundToEnd->id_game, out_game) != GAME_CONTROLLER_OK)
             return ROUND_CONTROLLER_INTERNAL_ERROR;
 
-        game.state = WAITING_GAME;
+        out_game->state = WAITING_GAME;
 
-        if (game_update(&game) != GAME_CONTROLLER_OK) {
+        if (game_update(out_game) != GAME_CONTROLLER_OK) {
             return ROUND_CONTROLLER_INTERNAL_ERROR;
         }
 
-        // F. Broadcast Updated Game Info (Owner, Streaks, State)
-        GameWithPlayerNickname info;
-        if (game_find_one_with_player_info(game.id_game, &info) != GAME_CONTROLLER_OK)
-            return ROUND_CONTROLLER_INTERNAL_ERROR;
-
-        // Retrieve updated owner streaks for the DTO
-        Player owner;
-        int owner_current_streak = 0;
-        int owner_max_streak = 0;
-
-        if (player_find_one(game.id_owner, &owner) == PLAYER_CONTROLLER_OK) {
-            owner_current_streak = owner.current_streak;
-            owner_max_streak     = owner.max_streak;
-        }
-
-        GameDTO dto;
-        map_game_with_streak_to_dto(
-            &game,
-            info.creator,
-            info.owner,
-            owner_current_streak,
-            owner_max_streak,
-            &dto
-        );
-
-        char *json = serialize_game_updated_to_json(&dto);
-        if (json) {
-            send_server_broadcast_message(json, game.id_owner);
-            free(json);
-        }
     } // End of Winner Logic Block
 
     // 5. Update the Round state in DB (Finalize)
-    RoundControllerStatus status = round_update(roundToEnd);
+    RoundControllerStatus status = round_update_state(roundToEnd);
     if (status != ROUND_CONTROLLER_OK)
         return status;
 
+    *out_id_playerWinner = id_playerWinner;
+
+    return ROUND_CONTROLLER_OK;
+}
+
+/**
+ * Writes the end of a round, its final board included, as a single unit of work: every controller
+ * called by round_end_persist() gets the connection of the transaction, so either all of them are committed or none.
+ * @param roundToEnd Copy of the round, it is marked as finished
+ */
+static RoundControllerStatus round_end_commit(Round* roundToEnd, PlayResult result, int64_t* out_id_playerWinner, Game* out_game) {
+
+    sqlite3 *db = db_transaction_begin();
+    if (db == NULL)
+        return ROUND_CONTROLLER_INTERNAL_ERROR;
+
+    RoundControllerStatus status = round_end_persist(roundToEnd, result, out_id_playerWinner, out_game);
+    if (status != ROUND_CONTROLLER_OK) {
+        db_transaction_rollback(db);
+        return status;
+    }
+
+    if (db_transaction_commit(db) != 0)
+        return ROUND_CONTROLLER_INTERNAL_ERROR;
+
+    return ROUND_CONTROLLER_OK;
+}
+
+/**
+ * Tells clients about a round end once it has been committed.
+ * Delivery is best-effort: the round is over whether or not the notifications reach anybody.
+ */
+static void round_end_notify(const Round* endedRound, int64_t id_playerEndingRound, PlayResult result, int64_t id_playerWinner, const Game* game) {
+
+    // F. Broadcast Updated Game Info (Owner, Streaks, State)
+    if (id_playerWinner != -1) {
+        GameWithPlayerNickname info;
+        if (game_find_one_with_player_info(game->id_game, &info) == GAME_CONTROLLER_OK) {
+
+            // Retrieve updated owner streaks for the DTO
+            Player owner;
+            int owner_current_streak = 0;
+            int owner_max_streak = 0;
+
+            if (player_find_one(game->id_owner, &owner) == PLAYER_CONTROLLER_OK) {
+                owner_current_streak = owner.current_streak;
+                owner_max_streak     = owner.max_streak;
+            }
+
+            GameDTO dto;
+            map_game_with_streak_to_dto(
+                game,
+                info.creator,
+                info.owner,
+                owner_current_streak,
+                owner_max_streak,
+                &dto
+            );
+
+            Message *json = serialize_game_updated_to_json(&dto);
+            if (json) {
+                send_server_broadcast_message(json, game->id_owner);
+                message_release(json);
+            }
+        } else {
+            LOG_WARN("Game of round %" PRId64 " not found, its update is not broadcast\n", endedRound->id_round);
+        }
+    }
+
     // If there is a winner, they are the logical sender of the end notification
     if (id_playerWinner != -1)
         id_playerEndingRound = id_playerWinner;
 
     // 6. Send Notification (Broadcast Round End)
     NotificationDTO *out_notification_dto = NULL;
-    if (notification_finished_round(roundToEnd->id_round, id_playerEndingRound, play_result_to_string(result), &out_notification_dto) != NOTIFICATION_CONTROLLER_OK)
-        return ROUND_CONTROLLER_INTERNAL_ERROR;
-    
-    char *json_message = serialize_notification_to_json("server_round_end_notification", out_notification_dto);
-    if (send_server_broadcast_message(json_message, id_playerEndingRound) < 0 ) {
-        free(json_message);
-        free(out_notification_dto);
-        return ROUND_CONTROLLER_INTERNAL_ERROR;
+    if (notification_finished_round(endedRound->id_round, id_playerEndingRound, play_result_to_string(result), &out_notification_dto) == NOTIFICATION_CONTROLLER_OK) {
+        Message *json_message = serialize_notification_to_json("server_round_end_notification", out_notification_dto);
+        if (send_server_broadcast_message(json_message, id_playerEndingRound) < 0)
+            LOG_WARN("End of round %" PRId64 " not broadcast\n", endedRound->id_round);
+        message_release(json_message);
+    } else {
+        LOG_WARN("End notification of round %" PRId64 " not built\n", endedRound->id_round);
     }
 
-    free(json_message);
-    free(out_notification_dto);
-
     // 7. Send Updated Round Data (Unicast to players involved)
     Play* retrievedPlayArray = NULL;
     int retrievedPlayCount = 0;
-    playStatus = play_find_all_by_id_round(&retrievedPlayArray, roundToEnd->id_round, &retrievedPlayCount);
-    
-    if (playStatus != PLAY_CONTROLLER_OK || retrievedPlayCount <= 0)
-        return ROUND_CONTROLLER_INTERNAL_ERROR;
-    
-    RoundDTO out_round_dto;
-    map_round_to_dto(roundToEnd, &out_round_dto);
-    json_message = serialize_rounds_to_json("server_updated_round_end", &out_round_dto, 1);
-    
-    for (int i=0; i<retrievedPlayCount; i++) { 
-        send_server_unicast_message(json_message, retrievedPlayArray[i].id_player);
+    PlayControllerStatus playStatus = play_find_all_by_id_round(&retrievedPlayArray, endedRound->id_round, &retrievedPlayCount);
+
+    if (playStatus != PLAY_CONTROLLER_OK || retrievedPlayCount <= 0) {
+        LOG_WARN("Plays of round %" PRId64 " not found, its end is not sent to the players\n", endedRound->id_round);
+        return;
     }
 
-    free(json_message);
-    
-    // Crucial: Free the array of plays to prevent memory leaks
-    if (retrievedPlayArray) free(retrievedPlayArray); 
+    RoundDTO out_round_dto;
+    map_round_to_dto(endedRound, &out_round_dto);
+    Message *json_message = serialize_rounds_to_json("server_updated_round_end", &out_round_dto, 1);
 
-    return ROUND_CONTROLLER_OK;
+    for (int i=0; i<retrievedPlayCount; i++) {
+        if (!bot_is_player(retrievedPlayArray[i].id_player))
+            send_server_unicast_message(json_message, retrievedPlayArray[i].id_player);
+    }
+
+    message_release(json_message);
 }
 
 // ===================== Controllers Helper Functions =====================
 
 RoundControllerStatus round_start(int64_t id_game, int64_t id_player1, int64_t id_player2, int64_t *out_new_round) {
     // Create a new round with server-side timestamps (start_time set here)
+    Game game;
+    if (game_find_one(id_game, &game) != GAME_CONTROLLER_OK)
+        return ROUND_CONTROLLER_INTERNAL_ERROR;
+
     Round out_newRound;
-    RoundControllerStatus roundStatus = round_start_helper(id_game, &out_newRound);
+    RoundControllerStatus roundStatus = round_start_helper(&game, &out_newRound);
     if (roundStatus != ROUND_CONTROLLER_OK)
         return roundStatus;
 
@@ -454,15 +428,22 @@ RoundControllerStatus round_start(int64_t id_game, int64_t id_player1, int64_t i
     if (playStatus != PLAY_CONTROLLER_OK)
         return ROUND_CONTROLLER_INTERNAL_ERROR;
 
-     Game game;
-    if (game_find_one(id_game, &game) != GAME_CONTROLLER_OK)
-        return ROUND_CONTROLLER_INTERNAL_ERROR;
-
     game.state = ACTIVE_GAME;
 
     if (game_update(&game) != GAME_CONTROLLER_OK)
         return ROUND_CONTROLLER_INTERNAL_ERROR;
 
+    // Moves of the new round are served from memory, once its game is active: its deadline may forfeit the game.
+    // If it can't be added now, the first move loads it
+    ActiveRound *active = round_registry_insert(&out_newRound, id_player1, id_player2);
+    if (active) {
+        round_arm_move_timer(active);
+        round_registry_release(active);
+    }
+
+    if (bot_is_player(id_player1))
+        bot_request_move(out_newRound.id_round);
+
     // Retrieve game info with nicknames */
     GameWithPlayerNickname info;
     if (game_find_one_with_player_info(game.id_game, &info) != GAME_CONTROLLER_OK)
@@ -490,33 +471,33 @@ RoundControllerStatus round_start(int64_t id_game, int64_t id_player1, int64_t i
     );
 
     // Broadcast game update to all clients */
-    char *json = serialize_game_updated_to_json(&dto);
+    Message *json = serialize_game_updated_to_json(&dto);
     if (json) {
         send_server_broadcast_message(json, game.id_owner);
-        free(json);
+        message_release(json);
     }
 
     return ROUND_CONTROLLER_OK;
 }
 
 
-static RoundControllerStatus round_start_helper(int64_t id_game, Round* out_newRound) {
-
-    // Build empty board
-    char emptyBoard[BOARD_MAX];
-    fill_empty_board(emptyBoard);
+static RoundControllerStatus round_start_helper(const Game *game, Round* out_newRound) {
 
     // Build new round
     // IMPORTANT: time is server-authoritative.
     // start_time is set now, end_time is 0 until the round finishes.
     Round roundToStart = {
-        .id_game = id_game,
+        .id_game = game->id_game,
         .state = ACTIVE_ROUND,
         .start_time = (int64_t)time(NULL),
         .end_time = 0
     };
 
-    strcpy(roundToStart.board, emptyBoard);
+    // The board takes the size and the line length chosen for the game
+    if (board_init(&roundToStart.board, game->board_size, game->win_length) != 0) {
+        LOG_ERROR("Game %ld has invalid board rules %dx%d/%d", game->id_game, game->board_size, game->board_size, game->win_length);
+        return ROUND_CONTROLLER_INTERNAL_ERROR;
+    }
 
     LOG_STRUCT_DEBUG(print_round_inline, &roundToStart);
 
@@ -533,6 +514,54 @@ static RoundControllerStatus round_start_helper(int64_t id_game, Round* out_newR
     return ROUND_CONTROLLER_OK;
 }
 
+/**
+ * Takes the in-memory state of an active round, loading it from the database
+ * if it isn't there yet (e.g. rounds started before a restart).
+ * @param out_active Locked entry, to be given back with round_registry_release()
+ * @return `ROUND_CONTROLLER_STATE_VIOLATION` if the round is over
+ */
+RoundControllerStatus round_acquire_active(int64_t id_round, ActiveRound **out_active) {
+
+    ActiveRound *active = round_registry_acquire(id_round);
+    if (active) {
+        *out_active = active;
+        return ROUND_CONTROLLER_OK;
+    }
+
+    Round retrievedRound;
+    RoundControllerStatus status = round_find_one(id_round, &retrievedRound);
+    if (status != ROUND_CONTROLLER_OK)
+        return status;
+
+    // A won board whose round end was not committed is over all the same
+    if (retrievedRound.state != ACTIVE_ROUND || retrievedRound.board.winner != 0)
+        return ROUND_CONTROLLER_STATE_VIOLATION;
+
+    Play *retrievedPlayArray = NULL;
+    int retrievedPlayCount = 0;
+    PlayControllerStatus playStatus = play_find_all_by_id_round(&retrievedPlayArray, id_round, &retrievedPlayCount);
+    if (playStatus != PLAY_CONTROLLER_OK || retrievedPlayCount <= 0)
+        return ROUND_CONTROLLER_INTERNAL_ERROR;
+
+    int64_t id_players[2] = { -1, -1 };
+    for (int i = 0; i < retrievedPlayCount; i++) {
+        int player_number = retrievedPlayArray[i].player_number;
+        if (player_number == 1 || player_number == 2)
+            id_players[player_number - 1] = retrievedPlayArray[i].id_player;
+    }
+
+    active = round_registry_insert(&retrievedRound, id_players[0], id_players[1]);
+    if (!active)
+        return ROUND_CONTROLLER_INTERNAL_ERROR;
+
+    // Rounds loaded after a restart get a full move time again
+    if (active->move_deadline == 0)
+        round_arm_move_timer(active);
+
+    *out_active = active;
+    return ROUND_CONTROLLER_OK;
+}
+
 // ===================== CRUD Operations =====================
 
 const char *return_round_controller_status_to_string(RoundControllerStatus status) {
@@ -551,11 +580,11 @@ const char *return_round_controller_status_to_string(RoundControllerStatus statu
 
 // Create
 RoundControllerStatus round_create(Round* roundToCreate) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
 
     RoundDaoStatus status = insert_round(db, roundToCreate);
 
-    db_close(db);
+    db_release(db);
 
     if (status != ROUND_DAO_OK) {
         LOG_WARN("%s\n", return_round_dao_status_to_string(status));
@@ -573,9 +602,9 @@ RoundControllerStatus round_create(Round* roundToCreate) {
 
 // Read all
 RoundControllerStatus round_find_all(Round **retrievedRoundArray, int* retrievedObjectCount) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     RoundDaoStatus status = get_all_rounds(db, retrievedRoundArray, retrievedObjectCount);
-    db_close(db);
+    db_release(db);
     if (status != ROUND_DAO_OK) {
         LOG_WARN("%s\n", return_round_dao_status_to_string(status));
         return ROUND_CONTROLLER_DATABASE_ERROR;
@@ -594,9 +623,9 @@ RoundControllerStatus round_find_one(int64_t id_round, Round* retrievedRound) {
         return ROUND_CONTROLLER_INVALID_INPUT;
     }
 
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     RoundDaoStatus status = get_round_by_id(db, id_round, retrievedRound);
-    db_close(db);
+    db_release(db);
 
     LOG_INFO("STATUS: %s\n", return_round_dao_status_to_string(status));
 
@@ -613,11 +642,67 @@ RoundControllerStatus round_find_one(int64_t id_round, Round* retrievedRound) {
     return ROUND_CONTROLLER_OK;
 }
 
+// Read the active round of a game
+RoundControllerStatus round_find_active_by_game(int64_t id_game, Round* retrievedRound) {
+    sqlite3* db = db_acquire();
+    RoundDaoStatus status = get_active_round_by_game(db, id_game, retrievedRound);
+    db_release(db);
+    if (status != ROUND_DAO_OK) {
+        if (status == ROUND_DAO_NOT_FOUND)
+            return ROUND_CONTROLLER_NOT_FOUND;
+        LOG_WARN("%s\n", return_round_dao_status_to_string(status));
+        return ROUND_CONTROLLER_DATABASE_ERROR;
+    }
+
+    return ROUND_CONTROLLER_OK;
+}
+
+// Read the most recent round of a game
+RoundControllerStatus round_find_last_by_game(int64_t id_game, Round* retrievedRound) {
+    sqlite3* db = db_acquire();
+    RoundDaoStatus status = get_last_round_by_game(db, id_game, retrievedRound);
+    db_release(db);
+    if (status != ROUND_DAO_OK) {
+        if (status == ROUND_DAO_NOT_FOUND)
+            return ROUND_CONTROLLER_NOT_FOUND;
+        LOG_WARN("%s\n", return_round_dao_status_to_string(status));
+        return ROUND_CONTROLLER_DATABASE_ERROR;
+    }
+
+    return ROUND_CONTROLLER_OK;
+}
+
 // Update
 RoundControllerStatus round_update(Round* updatedRound) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     RoundDaoStatus status = update_round_by_id(db, updatedRound);
-    db_close(db);
+    db_release(db);
+    if (status != ROUND_DAO_OK) {
+        LOG_WARN("%s\n", return_round_dao_status_to_string(status));
+        return ROUND_CONTROLLER_DATABASE_ERROR;
+    }
+
+    return ROUND_CONTROLLER_OK;
+}
+
+// Update the board only, a move of an active round
+RoundControllerStatus round_update_board(const Round* updatedRound) {
+    sqlite3* db = db_acquire();
+    RoundDaoStatus status = update_round_board(db, updatedRound);
+    db_release(db);
+    if (status != ROUND_DAO_OK) {
+        LOG_WARN("%s\n", return_round_dao_status_to_string(status));
+        return ROUND_CONTROLLER_DATABASE_ERROR;
+    }
+
+    return ROUND_CONTROLLER_OK;
+}
+
+// Update state, end time and board, the end of a round
+RoundControllerStatus round_update_state(const Round* updatedRound) {
+    sqlite3* db = db_acquire();
+    RoundDaoStatus status = update_round_state(db, updatedRound);
+    db_release(db);
     if (status != ROUND_DAO_OK) {
         LOG_WARN("%s\n", return_round_dao_status_to_string(status));
         return ROUND_CONTROLLER_DATABASE_ERROR;
@@ -628,9 +713,9 @@ RoundControllerStatus round_update(Round* updatedRound) {
 
 // Delete
 RoundControllerStatus round_delete(int64_t id_round) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     RoundDaoStatus status = delete_round_by_id(db, id_round);
-    db_close(db);
+    db_release(db);
     if (status != ROUND_DAO_OK) {
         LOG_WARN("%s\n", return_round_dao_status_to_string(status));
         return status == ROUND_DAO_NOT_FOUND ? ROUND_CONTROLLER_NOT_FOUND : ROUND_CONTROLLER_DATABASE_ERROR;
@@ -640,9 +725,9 @@ RoundControllerStatus round_delete(int64_t id_round) {
 }
 
 RoundControllerStatus round_find_full_info_by_id_round(int64_t id_round, RoundFullDTO* retrievedFullRound) {
-    sqlite3* db = db_open();
+    sqlite3* db = db_acquire();
     RoundDaoStatus status = round_find_full_info(db, id_round, retrievedFullRound);
-    db_close(db);
+    db_release(db);
     if (status != ROUND_DAO_OK) {
         LOG_WARN("%s\n", return_round_dao_status_to_string(status));
         return status == ROUND_DAO_NOT_FOUND ? ROUND_CONTROLLER_NOT_FOUND : ROUND_CONTROLLER_DATABASE_ERROR;
@@ -651,4 +736,45 @@ RoundControllerStatus round_find_full_info_by_id_round(int64_t id_round, RoundFu
     return ROUND_CONTROLLER_OK;
 }
 
+/**
+ * Restarts the move deadline of a round, the entry must be held by the caller.
+ */
+static void round_arm_move_timer(ActiveRound *active) {
+
+    if (MOVE_TIMEOUT_SECONDS <= 0)
+        return;
+
+    active->move_deadline = time(NULL) + MOVE_TIMEOUT_SECONDS;
+    server_timer_schedule(&active->move_timer, MOVE_TIMEOUT_SECONDS, round_move_timeout, active->round.id_round);
+}
+
+/**
+ * Move deadline of a round: the player who didn't move in time forfeits the game, as if they had left it.
+ */
+static void round_move_timeout(int64_t id_round) {
+
+    ActiveRound *active = round_registry_acquire(id_round);
+    if (!active)
+        return;
 
+    // A move was made after the timer went off
+    if (active->move_deadline == 0 || active->move_deadline > time(NULL)) {
+        round_registry_release(active);
+        return;
+    }
+
+    int64_t id_game = active->round.id_game;
+    int64_t id_playerLate = active->id_players[board_current_turn(&active->round.board) - 1];
+    time_t move_deadline = active->move_deadline;
+
+    round_registry_release(active);
+
+    LOG_INFO("Player %" PRId64 " ran out of time on round %" PRId64 "\n", id_playerLate, id_round);
+
+    // The forfeit checks the deadline again once it holds the round: a move may land in between
+    GameControllerStatus status = game_forfeit_timeout(id_game, id_playerLate, move_deadline);
+    if (status == GAME_CONTROLLER_STATE_VIOLATION)
+        LOG_INFO("Round %" PRId64 " got a move before its timeout was applied\n", id_round);
+    else if (status != GAME_CONTROLLER_OK)
+        LOG_WARN("Timeout of round %" PRId64 " not applied: %s\n", id_round, return_game_controller_status_to_string(status));
+}
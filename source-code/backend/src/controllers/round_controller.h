@@ -5,6 +5,12 @@
 
 #include "../entities/round_entity.h"
 #include "../dto/round_dto.h"
+#include "round_registry.h"
+
+// Time a player has for each move before forfeiting the game, `0` disables it (e.g. `make CPPFLAGS=-DMOVE_TIMEOUT_SECONDS=30`)
+#ifndef MOVE_TIMEOUT_SECONDS
+#define MOVE_TIMEOUT_SECONDS 120
+#endif
 
 typedef enum {
     ROUND_CONTROLLER_OK = 0,
@@ -25,13 +31,18 @@ RoundControllerStatus round_end(int64_t id_round, int64_t id_playerEndingRound,
 // ===================== Controllers Helper Functions =====================
 
 RoundControllerStatus round_start(int64_t id_game, int64_t id_player1, int64_t id_player2, int64_t *out_new_round);
+RoundControllerStatus round_acquire_active(int64_t id_round, ActiveRound **out_active);
 
 // ===================== CRUD Operations =====================
 
 RoundControllerStatus round_create(Round* roundToCreate);
 RoundControllerStatus round_find_all(Round **retrievedRoundArray, int* retrievedObjectCount);
 RoundControllerStatus round_find_one(int64_t id_round, Round* retrievedRound);
+RoundControllerStatus round_find_active_by_game(int64_t id_game, Round* retrievedRound);
+RoundControllerStatus round_find_last_by_game(int64_t id_game, Round* retrievedRound);
 RoundControllerStatus round_update(Round* updatedRound);
+RoundControllerStatus round_update_board(const Round* updatedRound);
+RoundControllerStatus round_update_state(const Round* updatedRound);
 RoundControllerStatus round_delete(int64_t id_round);
 RoundControllerStatus round_find_full_info_by_id_round(int64_t id_round, RoundFullDTO *retrievedFullRound);
 
@@ -0,0 +1,149 @@
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include "../../include/debug_log.h"
+
+#include "round_registry.h"
+#include "../server/server.h"
+
+static ActiveRound *buckets[ROUND_REGISTRY_BUCKETS];
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// ==================== Private functions ====================
+
+static size_t hash_id_round(int64_t id_round);
+static ActiveRound *find_entry(int64_t id_round);
+static ActiveRound *lock_entry(ActiveRound *entry);
+static void unref_entry(ActiveRound *entry);
+
+// ===========================================================
+
+static size_t hash_id_round(int64_t id_round) {
+    uint64_t h = (uint64_t)id_round;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (size_t)h & (ROUND_REGISTRY_BUCKETS - 1);
+}
+
+// Must be called with `registry_lock` held
+static ActiveRound *find_entry(int64_t id_round) {
+
+    ActiveRound *entry = buckets[hash_id_round(id_round)];
+
+    while (entry && entry->round.id_round != id_round)
+        entry = entry->next;
+
+    return entry;
+}
+
+// Waits for the entry, which must already be referenced by the caller. `NULL` if it was removed meanwhile
+static ActiveRound *lock_entry(ActiveRound *entry) {
+
+    pthread_mutex_lock(&entry->lock);
+
+    if (entry->removed) {
+        round_registry_release(entry);
+        return NULL;
+    }
+
+    return entry;
+}
+
+static void unref_entry(ActiveRound *entry) {
+
+    pthread_mutex_lock(&registry_lock);
+    int last = --entry->refcount == 0 && entry->removed;
+    pthread_mutex_unlock(&registry_lock);
+
+    if (last) {
+        pthread_mutex_destroy(&entry->lock);
+        free(entry);
+    }
+}
+
+/**
+ * Takes the in-memory state of an active round.
+ * @return The locked entry, to be given back with round_registry_release(). `NULL` if the round is not in memory
+ */
+ActiveRound *round_registry_acquire(int64_t id_round) {
+
+    pthread_mutex_lock(&registry_lock);
+
+    ActiveRound *entry = find_entry(id_round);
+    if (entry)
+        entry->refcount++;
+
+    pthread_mutex_unlock(&registry_lock);
+
+    return entry ? lock_entry(entry) : NULL;
+}
+
+/**
+ * Adds an active round to the registry. If another thread added it first, its entry is returned instead.
+ * @return The locked entry, to be given back with round_registry_release(). `NULL` if memory is exhausted
+ */
+ActiveRound *round_registry_insert(const Round *round, int64_t id_player1, int64_t id_player2) {
+
+    ActiveRound *created = calloc(1, sizeof(ActiveRound));
+    if (!created) {
+        LOG_ERROR("malloc() failed for active round %" PRId64 "\n", round->id_round);
+        return NULL;
+    }
+
+    created->round = *round;
+    created->id_players[0] = id_player1;
+    created->id_players[1] = id_player2;
+    created->refcount = 1;
+    pthread_mutex_init(&created->lock, NULL);
+
+    pthread_mutex_lock(&registry_lock);
+
+    ActiveRound *entry = find_entry(round->id_round);
+    if (entry) {
+        entry->refcount++;
+    } else {
+        size_t b = hash_id_round(round->id_round);
+        created->next = buckets[b];
+        buckets[b] = created;
+        entry = created;
+    }
+
+    pthread_mutex_unlock(&registry_lock);
+
+    if (entry != created) {
+        pthread_mutex_destroy(&created->lock);
+        free(created);
+    }
+
+    return lock_entry(entry);
+}
+
+/**
+ * Removes a finished round from the registry, the caller must hold the entry.
+ * Threads waiting for it will get `NULL` and fall back to the database.
+ */
+void round_registry_remove(ActiveRound *entry) {
+
+    pthread_mutex_lock(&registry_lock);
+
+    ActiveRound **link = &buckets[hash_id_round(entry->round.id_round)];
+    while (*link && *link != entry)
+        link = &(*link)->next;
+
+    if (*link)
+        *link = entry->next;
+
+    entry->removed = 1;
+
+    pthread_mutex_unlock(&registry_lock);
+
+    server_timer_cancel(&entry->move_timer);
+}
+
+// Unlocks the entry and drops the reference of the caller
+void round_registry_release(ActiveRound *entry) {
+
+    pthread_mutex_unlock(&entry->lock);
+    unref_entry(entry);
+}
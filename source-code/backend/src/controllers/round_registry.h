@@ -0,0 +1,39 @@
+#ifndef ROUND_REGISTRY_H
+#define ROUND_REGISTRY_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "../entities/round_entity.h"
+#include "../server/timer_wheel.h"
+
+// Buckets of the registry, a power of two (e.g. `make CPPFLAGS=-DROUND_REGISTRY_BUCKETS=4096`)
+#ifndef ROUND_REGISTRY_BUCKETS
+#define ROUND_REGISTRY_BUCKETS 1024
+#endif
+
+/**
+ * Authoritative in-memory state of an active round: moves are validated and applied here,
+ * the database only receives the resulting board (write-through).
+ * An entry is handed out locked by round_registry_acquire()/round_registry_insert(),
+ * so the moves of a round are applied and persisted one at a time, in order.
+ */
+typedef struct ActiveRound {
+    Round round;
+    int64_t id_players[2];          // id_player of player number 1 and 2
+    time_t move_deadline;           // The player to move forfeits after this time, `0` if there is no deadline
+    Timer move_timer;               // Expires at `move_deadline`, cancelled when the round leaves the registry
+
+    pthread_mutex_t lock;           // Held by whoever is working on the round
+    int refcount;                   // Threads holding or waiting for the entry, protected by the registry lock
+    int removed;                    // No longer in the registry: the round is over
+    struct ActiveRound *next;       // Bucket chain
+} ActiveRound;
+
+ActiveRound *round_registry_acquire(int64_t id_round);
+ActiveRound *round_registry_insert(const Round *round, int64_t id_player1, int64_t id_player2);
+void round_registry_remove(ActiveRound *entry);
+void round_registry_release(ActiveRound *entry);
+
+#endif
@@ -17,6 +17,9 @@ typedef struct {
 
     int owner_current_streak;
     int owner_max_streak;
+
+    int board_size;
+    int win_length;
 } GameWithPlayerNickname;
 
 #endif
\ No newline at end of file
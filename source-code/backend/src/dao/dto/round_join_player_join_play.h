@@ -13,7 +13,9 @@ typedef struct RoundFullDTO {
     int64_t start_time;
     int64_t end_time;
     char state[16];
-    char board[BOARD_MAX];
+    char board[BOARD_TEXT_MAX];
+    int board_size;
+    int win_length;
 
     int64_t id_player1;
     int64_t id_player2;
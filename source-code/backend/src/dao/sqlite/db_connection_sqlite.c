@@ -1,10 +1,101 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
 
 #include "../../../include/debug_log.h"
 
 #include "db_connection_sqlite.h"
 
+/**
+ * Connections are opened and configured once at startup and then lent to the controllers,
+ * so a query no longer pays for sqlite3_open() and the PRAGMA setup.
+ * Every connection also keeps its own copy of the DAO statements, prepared once at startup.
+ */
+typedef struct {
+    sqlite3 **connections;      // Every connection of the pool
+    sqlite3_stmt **statements;  // DB_STATEMENT_COUNT statements for each connection, indexed by slot * DB_STATEMENT_COUNT + id
+    int size;
+    int *free_slots;            // Stack of indexes of the connections not in use
+    int free_count;
+    pthread_mutex_t lock;
+    pthread_cond_t available;   // Signaled when a connection is released
+} DbPool;
+
+static DbPool pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .available = PTHREAD_COND_INITIALIZER
+};
+
+/**
+ * Transaction opened by the current thread with db_transaction_begin().
+ * While it is open db_acquire() returns its connection, so the controllers called inside the unit of work
+ * write through the same transaction without knowing about it.
+ */
+typedef struct {
+    sqlite3 *db;
+    int depth;          // Nested db_transaction_begin() calls
+    int failed;         // Set by a nested rollback, the outermost commit becomes a rollback
+} DbTransaction;
+
+static _Thread_local DbTransaction transaction;
+
+/**
+ * Background thread that checkpoints the WAL every DB_CHECKPOINT_INTERVAL_S seconds on its own connection,
+ * so the WAL file doesn't grow while the connections of the pool are busy serving requests.
+ */
+typedef struct {
+    pthread_t thread;
+    sqlite3 *db;
+    int running;
+    int stopping;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        // Signaled to stop the thread before the interval expires
+} DbCheckpointer;
+
+static DbCheckpointer checkpointer = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER
+};
+
+/**
+ * Applies the storage profile declared in db_connection_sqlite.h to a connection just opened.
+ * @return `0` on success, `-1` if a PRAGMA failed.
+ */
+static int apply_storage_profile(sqlite3* db) {
+
+    char pragmas[256];
+    snprintf(pragmas, sizeof(pragmas),
+        "PRAGMA synchronous = %s; PRAGMA mmap_size = %lld; PRAGMA cache_size = -%d;",
+        DB_SYNCHRONOUS, (long long) DB_MMAP_SIZE, DB_CACHE_SIZE_KIB);
+
+    if (sqlite3_exec(db, pragmas, 0, 0, 0) != SQLITE_OK) {
+        LOG_ERROR("Error occurred applying the storage profile: \"%s\"\n", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    // journal_mode answers with the mode actually in use, which differs from the requested one if it can't be changed
+    sqlite3_stmt *st = NULL;
+    if (sqlite3_prepare_v2(db, "PRAGMA journal_mode = " DB_JOURNAL_MODE, -1, &st, NULL) != SQLITE_OK ||
+        sqlite3_step(st) != SQLITE_ROW) {
+        LOG_ERROR("Error occurred setting journal_mode: \"%s\"\n", sqlite3_errmsg(db));
+        sqlite3_finalize(st);
+        return -1;
+    }
+
+    const char *mode = (const char*) sqlite3_column_text(st, 0);
+    if (!mode || sqlite3_stricmp(mode, DB_JOURNAL_MODE) != 0)
+        LOG_WARN("Requested journal_mode %s, the database is using %s\n", DB_JOURNAL_MODE, mode ? mode : "(null)");
+
+    sqlite3_finalize(st);
+
+    sqlite3_busy_timeout(db, DB_BUSY_TIMEOUT_MS);
+
+    return 0;
+}
+
 /**
  * Function that opens database 
  * @return A `sqlite3*` pointer that is ready to use. `NULL` if something goes wrong.
@@ -29,6 +120,9 @@ sqlite3* db_open() {
             LOG_ERROR("Error occured during foreign_keys contraints activation: \"%s\"\n", sqlite3_errmsg(db));
             sqlite3_close(db);
             db = NULL;
+        } else if (apply_storage_profile(db) < 0) {
+            sqlite3_close(db);
+            db = NULL;
         } else {
             LOG_DEBUG("The database has been opened successfully: \"%s\"\n", DB_PATH);
         }
@@ -43,4 +137,404 @@ void db_close(sqlite3* db) {
         sqlite3_close(db);
         LOG_DEBUG("%s\n","Database closed.");
     }
-}
\ No newline at end of file
+}
+
+// ===================== WAL checkpoints =====================
+
+static void* checkpoint_loop(void *arg) {
+
+    (void) arg;
+
+    pthread_mutex_lock(&checkpointer.lock);
+
+    while (!checkpointer.stopping) {
+
+        struct timespec deadline = { .tv_sec = time(NULL) + DB_CHECKPOINT_INTERVAL_S, .tv_nsec = 0 };
+
+        int rc = 0;
+        while (!checkpointer.stopping && rc != ETIMEDOUT)
+            rc = pthread_cond_timedwait(&checkpointer.wake, &checkpointer.lock, &deadline);
+
+        if (checkpointer.stopping)
+            break;
+
+        pthread_mutex_unlock(&checkpointer.lock);
+
+        // PASSIVE copies the frames no reader still needs without waiting for readers or writers
+        int wal_frames = 0, checkpointed = 0;
+        if (sqlite3_wal_checkpoint_v2(checkpointer.db, NULL, SQLITE_CHECKPOINT_PASSIVE, &wal_frames, &checkpointed) != SQLITE_OK)
+            LOG_WARN("WAL checkpoint failed: \"%s\"\n", sqlite3_errmsg(checkpointer.db));
+        else
+            LOG_DEBUG("WAL checkpoint: %d/%d frames copied into the database\n", checkpointed, wal_frames);
+
+        pthread_mutex_lock(&checkpointer.lock);
+    }
+
+    pthread_mutex_unlock(&checkpointer.lock);
+    return NULL;
+}
+
+/**
+ * Starts the checkpoint thread on a dedicated connection, it does nothing if the journal is not in WAL mode.
+ * @return `0` on success, `-1` on error.
+ */
+static int checkpointer_start(void) {
+
+    if (DB_CHECKPOINT_INTERVAL_S <= 0 || sqlite3_stricmp(DB_JOURNAL_MODE, "WAL") != 0)
+        return 0;
+
+    checkpointer.db = db_open();
+    if (!checkpointer.db)
+        return -1;
+
+    checkpointer.stopping = 0;
+
+    if (pthread_create(&checkpointer.thread, NULL, checkpoint_loop, NULL) != 0) {
+        LOG_ERROR("%s\n", "pthread_create() failed for the WAL checkpoint thread");
+        db_close(checkpointer.db);
+        checkpointer.db = NULL;
+        return -1;
+    }
+
+    checkpointer.running = 1;
+    return 0;
+}
+
+static void checkpointer_stop(void) {
+
+    if (!checkpointer.running)
+        return;
+
+    pthread_mutex_lock(&checkpointer.lock);
+    checkpointer.stopping = 1;
+    pthread_cond_signal(&checkpointer.wake);
+    pthread_mutex_unlock(&checkpointer.lock);
+
+    pthread_join(checkpointer.thread, NULL);
+    checkpointer.running = 0;
+
+    db_close(checkpointer.db);
+    checkpointer.db = NULL;
+}
+
+// ===================== Connection pool =====================
+
+// Indexes added after the first release of db/scheme.sql, created on databases initialized before them
+static const char *schema_upgrades =
+    "CREATE INDEX IF NOT EXISTS idx_round_game_state ON Round (id_game, state);";
+
+// Columns added after the first release of db/scheme.sql: { table, column, definition }
+static const char *const column_upgrades[][3] = {
+    { "Game", "board_size", "INTEGER NOT NULL DEFAULT 3" },
+    { "Game", "win_length", "INTEGER NOT NULL DEFAULT 3" },
+};
+
+/**
+ * Brings a database initialized with an older db/scheme.sql up to date.
+ * @return `0` on success, `-1` on failure.
+ */
+static int upgrade_schema(sqlite3 *db) {
+
+    if (sqlite3_exec(db, schema_upgrades, 0, 0, 0) != SQLITE_OK)
+        return -1;
+
+    for (size_t i = 0; i < sizeof(column_upgrades) / sizeof(column_upgrades[0]); i++) {
+        const char *table = column_upgrades[i][0];
+        const char *column = column_upgrades[i][1];
+        char sql[256];
+
+        // A column that can be selected already exists
+        snprintf(sql, sizeof(sql), "SELECT %s FROM %s LIMIT 0", column, table);
+        sqlite3_stmt *probe = NULL;
+        int exists = sqlite3_prepare_v2(db, sql, -1, &probe, NULL) == SQLITE_OK;
+        sqlite3_finalize(probe);
+
+        if (exists)
+            continue;
+
+        snprintf(sql, sizeof(sql), "ALTER TABLE %s ADD COLUMN %s %s", table, column, column_upgrades[i][2]);
+        if (sqlite3_exec(db, sql, 0, 0, 0) != SQLITE_OK)
+            return -1;
+
+        LOG_INFO("Added column %s.%s to the database schema\n", table, column);
+    }
+
+    return 0;
+}
+
+/**
+ * Prepares every statement of the cache on the connection in `slot`,
+ * so a typo in the SQL stops the server at boot instead of failing on the first request.
+ * @return `0` on success, `-1` if a statement could not be prepared.
+ */
+static int warm_up_statements(int slot) {
+
+    sqlite3 *db = pool.connections[slot];
+
+    for (int id = 0; id < DB_STATEMENT_COUNT; id++) {
+        const char *sql = db_statement_sql((DbStatementId) id);
+
+        if (sqlite3_prepare_v3(db, sql, -1, SQLITE_PREPARE_PERSISTENT, &pool.statements[slot * DB_STATEMENT_COUNT + id], NULL) != SQLITE_OK) {
+            LOG_ERROR("Error occurred preparing statement %d \"%s\": \"%s\"\n", id, sql, sqlite3_errmsg(db));
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Opens `size` connections with db_open(). It must be called once, before serving any request.
+ * @return `0` on success, `-1` if a connection could not be opened.
+ */
+int db_pool_init(int size) {
+
+    if (size <= 0) {
+        LOG_WARN("Invalid database pool size: %d\n", size);
+        return -1;
+    }
+
+    pool.connections = calloc((size_t)size, sizeof(sqlite3*));
+    pool.statements = calloc((size_t)size * DB_STATEMENT_COUNT, sizeof(sqlite3_stmt*));
+    pool.free_slots = calloc((size_t)size, sizeof(int));
+    if (!pool.connections || !pool.statements || !pool.free_slots) {
+        LOG_ERROR("%s\n", "malloc() failed for database pool");
+        free(pool.connections);
+        free(pool.statements);
+        free(pool.free_slots);
+        return -1;
+    }
+
+    pool.size = size;
+    pool.free_count = 0;
+
+    for (int i = 0; i < size; i++) {
+        pool.connections[i] = db_open();
+
+        if (i == 0 && pool.connections[i] && upgrade_schema(pool.connections[i]) < 0) {
+            LOG_ERROR("Error occurred upgrading the database schema: \"%s\"\n", sqlite3_errmsg(pool.connections[i]));
+            db_pool_shutdown();
+            return -1;
+        }
+
+        if (!pool.connections[i] || warm_up_statements(i) < 0) {
+            db_pool_shutdown();
+            return -1;
+        }
+        pool.free_slots[pool.free_count++] = i;
+    }
+
+    if (checkpointer_start() < 0) {
+        db_pool_shutdown();
+        return -1;
+    }
+
+    LOG_INFO("Database pool initialized with %d connections and %d cached statements each (journal_mode=%s, synchronous=%s)\n",
+             size, DB_STATEMENT_COUNT, DB_JOURNAL_MODE, DB_SYNCHRONOUS);
+    return 0;
+}
+
+// Closes every connection of the pool
+void db_pool_shutdown(void) {
+
+    checkpointer_stop();
+
+    pthread_mutex_lock(&pool.lock);
+
+    for (int i = 0; i < pool.size; i++) {
+        // sqlite3_close() refuses to close a connection with unfinalized statements
+        for (int id = 0; id < DB_STATEMENT_COUNT; id++)
+            sqlite3_finalize(pool.statements[i * DB_STATEMENT_COUNT + id]);
+
+        db_close(pool.connections[i]);
+    }
+
+    free(pool.connections);
+    free(pool.statements);
+    free(pool.free_slots);
+    pool.connections = NULL;
+    pool.statements = NULL;
+    pool.free_slots = NULL;
+    pool.size = 0;
+    pool.free_count = 0;
+
+    pthread_mutex_unlock(&pool.lock);
+}
+
+/**
+ * Borrows a connection from the pool, waiting if every connection is in use.
+ * @return A `sqlite3*` pointer ready to use, it must be given back with db_release(). `NULL` if the pool is not initialized.
+ */
+sqlite3* db_acquire(void) {
+
+    if (transaction.db)
+        return transaction.db;
+
+    pthread_mutex_lock(&pool.lock);
+
+    if (pool.size == 0) {
+        pthread_mutex_unlock(&pool.lock);
+        LOG_ERROR("%s\n", "Database pool not initialized");
+        return NULL;
+    }
+
+    while (pool.free_count == 0)
+        pthread_cond_wait(&pool.available, &pool.lock);
+
+    sqlite3 *db = pool.connections[pool.free_slots[--pool.free_count]];
+
+    pthread_mutex_unlock(&pool.lock);
+    return db;
+}
+
+// Gives back a connection obtained with db_acquire()
+void db_release(sqlite3* db) {
+
+    // The connection of an open transaction is given back by the commit or the rollback
+    if (!db || db == transaction.db)
+        return;
+
+    pthread_mutex_lock(&pool.lock);
+
+    for (int i = 0; i < pool.size; i++) {
+        if (pool.connections[i] == db) {
+            pool.free_slots[pool.free_count++] = i;
+            pthread_cond_signal(&pool.available);
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&pool.lock);
+}
+
+// ===================== Unit of work =====================
+
+// Gives back the connection of the transaction once it has been closed
+static void transaction_end(void) {
+
+    sqlite3 *db = transaction.db;
+
+    transaction.db = NULL;
+    transaction.depth = 0;
+    transaction.failed = 0;
+
+    db_release(db);
+}
+
+/**
+ * Starts a unit of work: borrows a connection and opens a `BEGIN IMMEDIATE` transaction on it,
+ * so the write lock is taken upfront and the commit pays a single sync for every statement.
+ * Until it is closed, every db_acquire() of the same thread returns this connection.
+ * A nested call joins the transaction already open.
+ * @return The connection of the transaction, it must be closed with db_transaction_commit() or db_transaction_rollback(). `NULL` on error.
+ */
+sqlite3* db_transaction_begin(void) {
+
+    if (transaction.db) {
+        transaction.depth++;
+        return transaction.db;
+    }
+
+    sqlite3 *db = db_acquire();
+    if (!db)
+        return NULL;
+
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, 0) != SQLITE_OK) {
+        LOG_ERROR("Error occurred beginning the transaction: \"%s\"\n", sqlite3_errmsg(db));
+        db_release(db);
+        return NULL;
+    }
+
+    transaction.db = db;
+    transaction.depth = 1;
+    transaction.failed = 0;
+
+    return db;
+}
+
+/**
+ * Commits the unit of work opened by db_transaction_begin(). A nested call only closes its level.
+ * @return `0` on success, `-1` if the transaction was rolled back instead (a nested level failed or the commit failed).
+ */
+int db_transaction_commit(sqlite3* db) {
+
+    if (!db || db != transaction.db) {
+        LOG_ERROR("%s\n", "Commit of a transaction not opened by this thread");
+        return -1;
+    }
+
+    if (--transaction.depth > 0)
+        return transaction.failed ? -1 : 0;
+
+    if (transaction.failed) {
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+        transaction_end();
+        return -1;
+    }
+
+    if (sqlite3_exec(db, "COMMIT;", 0, 0, 0) != SQLITE_OK) {
+        LOG_ERROR("Error occurred committing the transaction: \"%s\"\n", sqlite3_errmsg(db));
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+        transaction_end();
+        return -1;
+    }
+
+    transaction_end();
+    return 0;
+}
+
+// Rolls back the unit of work opened by db_transaction_begin(). A nested call marks the whole transaction as failed.
+void db_transaction_rollback(sqlite3* db) {
+
+    if (!db || db != transaction.db) {
+        LOG_ERROR("%s\n", "Rollback of a transaction not opened by this thread");
+        return;
+    }
+
+    transaction.failed = 1;
+
+    if (--transaction.depth > 0)
+        return;
+
+    if (sqlite3_exec(db, "ROLLBACK;", 0, 0, 0) != SQLITE_OK)
+        LOG_ERROR("Error occurred rolling back the transaction: \"%s\"\n", sqlite3_errmsg(db));
+
+    transaction_end();
+}
+
+// ===================== Statement cache =====================
+
+/**
+ * Looks up a statement of the cache on a connection obtained with db_acquire().
+ * It replaces sqlite3_prepare_v2() for constant SQL: the statement is already compiled
+ * and must be given back with db_statement_release() instead of sqlite3_finalize().
+ * @return `SQLITE_OK` on success, `SQLITE_MISUSE` if `db` does not belong to the pool or `id` is not valid.
+ */
+int db_statement_prepare(sqlite3* db, DbStatementId id, sqlite3_stmt** out) {
+
+    *out = NULL;
+
+    if ((unsigned) id >= DB_STATEMENT_COUNT)
+        return SQLITE_MISUSE;
+
+    // The pool is never resized while serving requests, so the slots can be scanned without the lock
+    for (int i = 0; i < pool.size; i++) {
+        if (pool.connections[i] == db) {
+            *out = pool.statements[i * DB_STATEMENT_COUNT + id];
+            return SQLITE_OK;
+        }
+    }
+
+    LOG_ERROR("%s\n", "Statement requested on a connection not owned by the database pool");
+    return SQLITE_MISUSE;
+}
+
+// Resets a cached statement and clears its bindings, so it is ready for the next db_statement_prepare()
+void db_statement_release(sqlite3_stmt* st) {
+
+    if (!st)
+        return;
+
+    sqlite3_reset(st);
+    sqlite3_clear_bindings(st);
+}
@@ -3,10 +3,72 @@
 
 #include <sqlite3.h>
 
+#include "db_statements_sqlite.h"
+
 // Declare .sqlite file path
 #define DB_PATH "./db/data/database.sqlite"
 
+// Connections opened at startup, can be overridden at compile time (e.g. `make CPPFLAGS=-DDB_POOL_SIZE=16`)
+#ifndef DB_POOL_SIZE
+#define DB_POOL_SIZE 8
+#endif
+
+// ===================== Storage profile =====================
+//
+// Applied to every connection by db_open(), each value can be overridden at compile time like DB_POOL_SIZE.
+// In WAL mode readers don't wait for the writer, so lobby queries are not queued behind move updates.
+// With synchronous=NORMAL a commit is not fsynced, the WAL is synced only at checkpoints:
+// the database can't be corrupted, but a power loss or OS crash can roll back the last transactions
+// committed since the previous checkpoint. A crash of the server process alone loses nothing.
+// Build with -DDB_SYNCHRONOUS=\"FULL\" to fsync every commit instead.
+
+#ifndef DB_JOURNAL_MODE
+#define DB_JOURNAL_MODE "WAL"
+#endif
+
+#ifndef DB_SYNCHRONOUS
+#define DB_SYNCHRONOUS "NORMAL"
+#endif
+
+// Bytes of the database file mapped in memory by each connection (0 disables mmap)
+#ifndef DB_MMAP_SIZE
+#define DB_MMAP_SIZE 268435456LL
+#endif
+
+// Page cache of each connection in KiB
+#ifndef DB_CACHE_SIZE_KIB
+#define DB_CACHE_SIZE_KIB 8192
+#endif
+
+// How long a connection retries before a locked database returns SQLITE_BUSY
+#ifndef DB_BUSY_TIMEOUT_MS
+#define DB_BUSY_TIMEOUT_MS 5000
+#endif
+
+// Seconds between two checkpoints of the WAL made by the background thread (0 disables it)
+#ifndef DB_CHECKPOINT_INTERVAL_S
+#define DB_CHECKPOINT_INTERVAL_S 30
+#endif
+
 sqlite3* db_open();
 void db_close(sqlite3* db);
 
-#endif
\ No newline at end of file
+// ===================== Connection pool =====================
+
+int db_pool_init(int size);
+void db_pool_shutdown(void);
+sqlite3* db_acquire(void);
+void db_release(sqlite3* db);
+
+// ===================== Unit of work =====================
+
+sqlite3* db_transaction_begin(void);
+int db_transaction_commit(sqlite3* db);
+void db_transaction_rollback(sqlite3* db);
+
+// ===================== Statement cache =====================
+
+int db_statement_prepare(sqlite3* db, DbStatementId id, sqlite3_stmt** out);
+void db_statement_release(sqlite3_stmt* st);
+
+#endif
@@ -0,0 +1,177 @@
+#include <stddef.h>
+
+#include "db_statements_sqlite.h"
+
+// SQL text of every cached statement, indexed by DbStatementId
+static const char *const statements_sql[DB_STATEMENT_COUNT] = {
+    // Player
+    [STMT_PLAYER_GET_BY_ID] =
+        "SELECT id_player, nickname, email, password, current_streak, max_streak, unixepoch(registration_date) "
+        "FROM Player WHERE id_player = ?1",
+    [STMT_PLAYER_GET_ALL] = "SELECT id_player, nickname, email, password, current_streak, max_streak, unixepoch(registration_date) FROM Player",
+    [STMT_PLAYER_DELETE_BY_ID] = "DELETE FROM Player WHERE id_player = ?1",
+    [STMT_PLAYER_INSERT] =
+        "INSERT INTO Player (nickname, email, password, current_streak, max_streak, registration_date)"
+        " VALUES ( ?, ?, ?, ?, ?, datetime(?,'unixepoch')) RETURNING id_player, nickname, email, password, current_streak, max_streak, unixepoch(registration_date)",
+    [STMT_PLAYER_GET_BY_NICKNAME] =
+        "SELECT id_player, nickname, email, password, current_streak, max_streak, unixepoch(registration_date) "
+        "FROM Player WHERE nickname = ?1",
+    [STMT_PLAYER_GET_BY_EMAIL] =
+        "SELECT id_player, nickname, email, password, current_streak, max_streak, unixepoch(registration_date) "
+        "FROM Player WHERE email = ?1",
+
+    // Game
+    [STMT_GAME_GET_BY_ID] =
+        "SELECT id_game, id_creator, id_owner, state, unixepoch(created_at), board_size, win_length "
+        "FROM Game WHERE id_game = ?1",
+    [STMT_GAME_GET_ALL] = "SELECT id_game, id_creator, id_owner, state, unixepoch(created_at), board_size, win_length FROM Game",
+    [STMT_GAME_DELETE_BY_ID] = "DELETE FROM Game WHERE id_game = ?1",
+    [STMT_GAME_INSERT] =
+        "INSERT INTO Game (id_creator, id_owner, state, created_at, board_size, win_length)"
+        " VALUES ( ?, ?, ?, datetime(?,'unixepoch'), ?, ?) RETURNING id_game, id_creator, id_owner, state, unixepoch(created_at), board_size, win_length",
+    [STMT_GAME_GET_BY_ID_WITH_PLAYER_INFO] =
+        "SELECT "
+        " o.nickname              AS owner, "
+        " c.nickname              AS creator, "
+        " g.id_game               AS id_game, "
+        " g.id_creator            AS id_creator, "
+        " g.id_owner              AS id_owner, "
+        " g.state                 AS state, "
+        " unixepoch(g.created_at) AS created_at, "
+        " o.current_streak        AS owner_current_streak, "
+        " o.max_streak            AS owner_max_streak, "
+        " g.board_size            AS board_size, "
+        " g.win_length            AS win_length "
+        "FROM Game g "
+        "JOIN Player c ON c.id_player = g.id_creator "
+        "JOIN Player o ON o.id_player = g.id_owner "
+        "WHERE g.id_game = ?;",
+    [STMT_GAME_GET_ALL_WITH_PLAYER_INFO] =
+        "SELECT "
+        " g.id_game                  AS id_game, "
+        " g.id_creator               AS id_creator, "
+        " g.id_owner                 AS id_owner, "
+        " g.state                    AS state, "
+        " unixepoch(g.created_at)    AS created_at, "
+        " c.nickname                 AS creator, "
+        " o.nickname                 AS owner, "
+        " o.current_streak           AS owner_current_streak, "
+        " o.max_streak               AS owner_max_streak, "
+        " g.board_size               AS board_size, "
+        " g.win_length               AS win_length "
+        "FROM Game g "
+        "JOIN Player c ON c.id_player = g.id_creator "
+        "JOIN Player o ON o.id_player = g.id_owner "
+        "WHERE ?1 IS NULL OR g.state = ?1 "
+        "ORDER BY g.created_at DESC, g.id_game DESC;",
+
+    // Round, joined with its game for the win length (the board size is given by the board itself)
+    [STMT_ROUND_GET_BY_ID] =
+        "SELECT r.id_round, r.id_game, r.state, r.start_time, r.end_time, r.board, g.win_length "
+        "FROM Round r JOIN Game g ON g.id_game = r.id_game WHERE r.id_round = ?1",
+    [STMT_ROUND_GET_ALL] =
+        "SELECT r.id_round, r.id_game, r.state, r.start_time, r.end_time, r.board, g.win_length "
+        "FROM Round r JOIN Game g ON g.id_game = r.id_game",
+    [STMT_ROUND_INSERT] =
+        "INSERT INTO Round (id_game, state, start_time, end_time, board) "
+        "VALUES (?1, ?2, ?3, NULL, ?4) RETURNING id_round",
+    [STMT_ROUND_DELETE_BY_ID] = "DELETE FROM Round WHERE id_round = ?1",
+    [STMT_ROUND_GET_FULL_INFO] =
+        "SELECT "
+        "r.id_round, r.id_game, r.state, r.start_time, r.end_time, r.board, "
+        "p1.id_player, pl1.player_number, p1.nickname, "
+        "p2.id_player, pl2.player_number, p2.nickname, "
+        "g.board_size, g.win_length "
+        "FROM Round r "
+        "JOIN Game g ON g.id_game = r.id_game "
+        "JOIN Play pl1 ON pl1.id_round = r.id_round AND pl1.player_number = 1 "
+        "JOIN Player p1 ON p1.id_player = pl1.id_player "
+        "JOIN Play pl2 ON pl2.id_round = r.id_round AND pl2.player_number = 2 "
+        "JOIN Player p2 ON p2.id_player = pl2.id_player "
+        "WHERE r.id_round = ?1",
+    // Both seek the index idx_round_game_state instead of scanning the whole history
+    [STMT_ROUND_GET_ACTIVE_BY_GAME] =
+        "SELECT r.id_round, r.id_game, r.state, r.start_time, r.end_time, r.board, g.win_length "
+        "FROM Round r JOIN Game g ON g.id_game = r.id_game "
+        "WHERE r.id_game = ?1 AND r.state = 'active' "
+        "ORDER BY r.id_round DESC LIMIT 1",
+    // Newest round of each state, then the newest of the two
+    [STMT_ROUND_GET_LAST_BY_GAME] =
+        "SELECT r.id_round, r.id_game, r.state, r.start_time, r.end_time, r.board, g.win_length FROM ("
+        " SELECT * FROM (SELECT id_round, id_game, state, start_time, end_time, board FROM Round"
+        "  WHERE id_game = ?1 AND state = 'active' ORDER BY id_round DESC LIMIT 1)"
+        " UNION ALL"
+        " SELECT * FROM (SELECT id_round, id_game, state, start_time, end_time, board FROM Round"
+        "  WHERE id_game = ?1 AND state = 'finished' ORDER BY id_round DESC LIMIT 1)"
+        ") r JOIN Game g ON g.id_game = r.id_game ORDER BY r.id_round DESC LIMIT 1",
+    // Write-through of the in-memory rounds, which already know what changed
+    [STMT_ROUND_UPDATE_BOARD] = "UPDATE Round SET board = ?2 WHERE id_round = ?1",
+    [STMT_ROUND_UPDATE_STATE] = "UPDATE Round SET state = ?2, end_time = ?3, board = ?4 WHERE id_round = ?1",
+
+    // Play
+    [STMT_PLAY_GET_BY_PK] =
+        "SELECT result, player_number"
+        " FROM Play WHERE id_player = ?1 AND id_round = ?2",
+    [STMT_PLAY_GET_ALL] = "SELECT id_player, id_round, result, player_number FROM Play",
+    [STMT_PLAY_DELETE_BY_PK] = "DELETE FROM Play WHERE id_player = ?1 AND id_round = ?2",
+    [STMT_PLAY_INSERT] =
+        "INSERT INTO Play (id_player, id_round, result, player_number)"
+        " VALUES ( ?1, ?2, ?3, ?4) RETURNING id_player, id_round, result, player_number",
+    [STMT_PLAY_GET_BY_PK_WITH_PLAYER_INFO] =
+        "SELECT "
+        " y.id_player, "
+        " y.id_round, "
+        " y.result, "
+        " y.player_number, "
+        " p.nickname AS player_nickname "
+        "FROM Play y "
+        "JOIN Player p ON y.id_player = p.id_player "
+        "WHERE y.id_player = ?1 AND y.id_round = ?2;",
+    [STMT_PLAY_GET_ALL_WITH_PLAYER_INFO] =
+        "SELECT y.id_player, y.id_round, y.result, y.player_number, p.nickname AS player_nickname "
+        "FROM Play y JOIN Player p ON y.id_player = p.id_player "
+        "ORDER BY y.id_round ASC;",
+    [STMT_PLAY_GET_ALL_BY_ROUND] =
+        "SELECT id_player, id_round, result, player_number "
+        "FROM Play "
+        "WHERE id_round = ?1 "
+        "ORDER BY id_round ASC;",
+
+    // Participation_request
+    [STMT_PARTICIPATION_REQUEST_GET_BY_ID] =
+        "SELECT id_request, id_player, id_game, unixepoch(created_at), state"
+        " FROM participation_request WHERE id_request = ?1",
+    [STMT_PARTICIPATION_REQUEST_GET_ALL] = "SELECT id_request, id_player, id_game, unixepoch(created_at), state FROM Participation_request",
+    [STMT_PARTICIPATION_REQUEST_DELETE_BY_ID] = "DELETE FROM Participation_request WHERE id_request = ?1",
+    [STMT_PARTICIPATION_REQUEST_INSERT] =
+        "INSERT INTO Participation_request (id_player, id_game, created_at, state) "
+        "VALUES (?, ?, datetime(?,'unixepoch'), ?) RETURNING id_request, id_player, id_game, unixepoch(created_at), state",
+    [STMT_PARTICIPATION_REQUEST_GET_BY_ID_WITH_PLAYER_INFO] =
+        "SELECT "
+        " pr.id_request, "
+        " pr.id_player, "
+        " pr.id_game, "
+        " unixepoch(pr.created_at) AS created_at, "
+        " pr.state, "
+        " p.nickname "
+        "FROM Participation_request pr "
+        "JOIN Player p ON p.id_player = pr.id_player "
+        "WHERE pr.id_request = ?1;",
+    [STMT_PARTICIPATION_REQUEST_GET_ALL_WITH_PLAYER_INFO] =
+        "SELECT pr.id_request, pr.id_player, pr.id_game, unixepoch(pr.created_at), pr.state, p.nickname AS player_nickname "
+        "FROM Participation_request pr JOIN Player p ON pr.id_player = p.id_player "
+        "ORDER BY pr.created_at DESC",
+    [STMT_PARTICIPATION_REQUEST_GET_PENDING_BY_GAME] =
+        "SELECT id_request, id_player, id_game, unixepoch(created_at), state "
+        "FROM Participation_request "
+        "WHERE id_game = ?1 AND state = 'pending' "
+        "ORDER BY created_at DESC",
+};
+
+const char *db_statement_sql(DbStatementId id) {
+
+    if ((unsigned) id >= DB_STATEMENT_COUNT)
+        return NULL;
+
+    return statements_sql[id];
+}
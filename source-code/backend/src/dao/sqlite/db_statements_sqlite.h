@@ -0,0 +1,56 @@
+#ifndef DB_STATEMENTS_SQLITE_H
+#define DB_STATEMENTS_SQLITE_H
+
+// IDs of the constant statements used by the DAOs, every connection of the pool keeps them prepared
+typedef enum {
+    // Player
+    STMT_PLAYER_GET_BY_ID,
+    STMT_PLAYER_GET_ALL,
+    STMT_PLAYER_DELETE_BY_ID,
+    STMT_PLAYER_INSERT,
+    STMT_PLAYER_GET_BY_NICKNAME,
+    STMT_PLAYER_GET_BY_EMAIL,
+
+    // Game
+    STMT_GAME_GET_BY_ID,
+    STMT_GAME_GET_ALL,
+    STMT_GAME_DELETE_BY_ID,
+    STMT_GAME_INSERT,
+    STMT_GAME_GET_BY_ID_WITH_PLAYER_INFO,
+    STMT_GAME_GET_ALL_WITH_PLAYER_INFO,
+
+    // Round
+    STMT_ROUND_GET_BY_ID,
+    STMT_ROUND_GET_ALL,
+    STMT_ROUND_INSERT,
+    STMT_ROUND_DELETE_BY_ID,
+    STMT_ROUND_GET_FULL_INFO,
+    STMT_ROUND_GET_ACTIVE_BY_GAME,
+    STMT_ROUND_GET_LAST_BY_GAME,
+    STMT_ROUND_UPDATE_BOARD,
+    STMT_ROUND_UPDATE_STATE,
+
+    // Play
+    STMT_PLAY_GET_BY_PK,
+    STMT_PLAY_GET_ALL,
+    STMT_PLAY_DELETE_BY_PK,
+    STMT_PLAY_INSERT,
+    STMT_PLAY_GET_BY_PK_WITH_PLAYER_INFO,
+    STMT_PLAY_GET_ALL_WITH_PLAYER_INFO,
+    STMT_PLAY_GET_ALL_BY_ROUND,
+
+    // Participation_request
+    STMT_PARTICIPATION_REQUEST_GET_BY_ID,
+    STMT_PARTICIPATION_REQUEST_GET_ALL,
+    STMT_PARTICIPATION_REQUEST_DELETE_BY_ID,
+    STMT_PARTICIPATION_REQUEST_INSERT,
+    STMT_PARTICIPATION_REQUEST_GET_BY_ID_WITH_PLAYER_INFO,
+    STMT_PARTICIPATION_REQUEST_GET_ALL_WITH_PLAYER_INFO,
+    STMT_PARTICIPATION_REQUEST_GET_PENDING_BY_GAME,
+
+    DB_STATEMENT_COUNT
+} DbStatementId;
+
+const char *db_statement_sql(DbStatementId id);
+
+#endif
@@ -6,6 +6,8 @@
 #include "../../../include/debug_log.h"
 
 #include "game_dao_sqlite.h"
+#include "db_connection_sqlite.h"
+#include "../../server/arena.h"
 
 const char *return_game_dao_status_to_string(GameDaoStatus status) {
     switch (status) {
@@ -23,13 +25,9 @@ GameDaoStatus get_game_by_id(sqlite3 *db, int64_t id_game, Game *out) {
         return GAME_DAO_INVALID_INPUT;
     }
 
-    const char *sql = 
-        "SELECT id_game, id_creator, id_owner, state, unixepoch(created_at) "
-        "FROM Game WHERE id_game = ?1";
-
     sqlite3_stmt *st = NULL;    
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_GAME_GET_BY_ID, &st);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     rc = sqlite3_bind_int64(st , 1, id_game);
@@ -44,6 +42,8 @@ GameDaoStatus get_game_by_id(sqlite3 *db, int64_t id_game, Game *out) {
         out->id_owner = sqlite3_column_int64(st, 2); 
         const unsigned char *state = sqlite3_column_text(st, 3); 
         out->created_at = (time_t) sqlite3_column_int64(st, 4);
+        out->board_size = sqlite3_column_int(st, 5);
+        out->win_length = sqlite3_column_int(st, 6);
 
         if (state) {
             out->state = string_to_game_status((const char*) state);
@@ -51,12 +51,12 @@ GameDaoStatus get_game_by_id(sqlite3 *db, int64_t id_game, Game *out) {
             out->state = GAME_STATUS_INVALID;
         }
 
-        sqlite3_finalize(st); 
+        db_statement_release(st); 
         return GAME_DAO_OK;
 
     } else if (rc == SQLITE_DONE) { 
 
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return GAME_DAO_NOT_FOUND;
 
     } else goto step_fail;
@@ -67,12 +67,12 @@ GameDaoStatus get_game_by_id(sqlite3 *db, int64_t id_game, Game *out) {
 
     bind_fail:
         LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return GAME_DAO_SQL_ERROR;
 
     step_fail:
         LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return GAME_DAO_SQL_ERROR;
 }
 
@@ -85,19 +85,17 @@ GameDaoStatus get_all_games(sqlite3 *db, Game **out_array, int *out_count) {
     *out_array = NULL;
     *out_count = 0; 
 
-    const char *sql = "SELECT id_game, id_creator, id_owner, state, unixepoch(created_at) FROM Game"; 
-
     sqlite3_stmt *st = NULL;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_GAME_GET_ALL, &st);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     int cap = 16; 
 
-    Game *games_array = malloc(sizeof(Game) * cap);
+    Game *games_array = arena_alloc(arena_thread(), sizeof(Game) * cap);
 
     if (!games_array) {
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return GAME_DAO_MALLOC_ERROR;
     }
 
@@ -107,11 +105,10 @@ GameDaoStatus get_all_games(sqlite3 *db, Game **out_array, int *out_count) {
 
         if (count == cap) {
             int new_cap = cap * 2;
-            Game *tmp = realloc(games_array, sizeof(Game)* new_cap); 
+            Game *tmp = arena_grow(arena_thread(), games_array, sizeof(Game) * cap, sizeof(Game) * new_cap); 
 
             if(!tmp) {
-                free(games_array);
-                sqlite3_finalize(st);
+                db_statement_release(st);
                 return GAME_DAO_MALLOC_ERROR;
             }
 
@@ -126,6 +123,8 @@ GameDaoStatus get_all_games(sqlite3 *db, Game **out_array, int *out_count) {
         g.id_owner = sqlite3_column_int64(st,2);
         const unsigned char *state = sqlite3_column_text(st, 3);
         g.created_at = (time_t) sqlite3_column_int64(st,4);
+        g.board_size = sqlite3_column_int(st, 5);
+        g.win_length = sqlite3_column_int(st, 6);
 
         if (state) {
             g.state = string_to_game_status((const char*) state);
@@ -138,15 +137,14 @@ GameDaoStatus get_all_games(sqlite3 *db, Game **out_array, int *out_count) {
 
     if (rc != SQLITE_DONE) {
         LOG_ERROR("DATABASE ERROR: %s\n", sqlite3_errmsg(db));
-        free(games_array);
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return GAME_DAO_SQL_ERROR;
     }
 
     *out_array = games_array; 
     *out_count = count;
 
-    sqlite3_finalize(st);
+    db_statement_release(st);
 
     return GAME_DAO_OK;
 
@@ -290,11 +288,9 @@ GameDaoStatus delete_game_by_id(sqlite3 *db, int64_t id_game) {
         return GAME_DAO_INVALID_INPUT;
     }
 
-    const char *query = "DELETE FROM Game WHERE id_game = ?1";
-
     sqlite3_stmt *stmt = NULL;
 
-    int rc = sqlite3_prepare_v2(db, query, -1, &stmt, NULL);
+    int rc = db_statement_prepare(db, STMT_GAME_DELETE_BY_ID, &stmt);
     if (rc != SQLITE_OK) goto prepare_fail; 
 
     rc = sqlite3_bind_int64(stmt, 1, id_game);
@@ -303,7 +299,7 @@ GameDaoStatus delete_game_by_id(sqlite3 *db, int64_t id_game) {
     rc = sqlite3_step(stmt);
     if(rc != SQLITE_DONE) goto step_fail;
 
-    sqlite3_finalize(stmt);
+    db_statement_release(stmt);
 
     if (sqlite3_changes(db) == 0) return GAME_DAO_NOT_FOUND;
 
@@ -315,12 +311,12 @@ GameDaoStatus delete_game_by_id(sqlite3 *db, int64_t id_game) {
     
     bind_fail:
         LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return GAME_DAO_SQL_ERROR;
 
     step_fail:
         LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return GAME_DAO_SQL_ERROR;
 }
 
@@ -340,11 +336,7 @@ GameDaoStatus insert_game(sqlite3 *db, Game *in_out_game) {
 
     sqlite3_stmt *stmt = NULL;
 
-    const char *query = 
-        "INSERT INTO Game (id_creator, id_owner, state, created_at)"
-        " VALUES ( ?, ?, ?, datetime(?,'unixepoch')) RETURNING id_game, id_creator, id_owner, state, unixepoch(created_at)";
-
-    int rc = sqlite3_prepare_v2(db, query, -1, &stmt, NULL);
+    int rc = db_statement_prepare(db, STMT_GAME_INSERT, &stmt);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     int param_index = 1;
@@ -357,7 +349,7 @@ GameDaoStatus insert_game(sqlite3 *db, Game *in_out_game) {
 
     const char *g_st = game_status_to_string(in_out_game->state);
     if(!g_st) {
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return GAME_DAO_INVALID_INPUT;
     }
 
@@ -367,6 +359,12 @@ GameDaoStatus insert_game(sqlite3 *db, Game *in_out_game) {
     rc = sqlite3_bind_int64(stmt, param_index++, (sqlite3_int64) in_out_game->created_at);
     if (rc != SQLITE_OK) goto bind_fail;
 
+    rc = sqlite3_bind_int(stmt, param_index++, in_out_game->board_size);
+    if (rc != SQLITE_OK) goto bind_fail;
+
+    rc = sqlite3_bind_int(stmt, param_index++, in_out_game->win_length);
+    if (rc != SQLITE_OK) goto bind_fail;
+
     if (sqlite3_step(stmt) != SQLITE_ROW) goto step_fail;
 
     in_out_game->id_game = sqlite3_column_int64(stmt, 0);
@@ -375,8 +373,10 @@ GameDaoStatus insert_game(sqlite3 *db, Game *in_out_game) {
     const unsigned char *state = sqlite3_column_text(stmt, 3);
     in_out_game->state = string_to_game_status((const char*) state);
     in_out_game->created_at = (time_t) sqlite3_column_int64(stmt,4);
+    in_out_game->board_size = sqlite3_column_int(stmt, 5);
+    in_out_game->win_length = sqlite3_column_int(stmt, 6);
 
-    sqlite3_finalize(stmt);
+    db_statement_release(stmt);
     return GAME_DAO_OK;
 
     prepare_fail:
@@ -385,12 +385,12 @@ GameDaoStatus insert_game(sqlite3 *db, Game *in_out_game) {
 
     bind_fail:
         LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return GAME_DAO_SQL_ERROR;
 
     step_fail:
         LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return GAME_DAO_SQL_ERROR;
 }
 
@@ -400,24 +400,8 @@ GameDaoStatus get_game_by_id_with_player_info(sqlite3 *db, int64_t id_game, Game
         return GAME_DAO_INVALID_INPUT;
     }
 
-    const char *query =
-        "SELECT "
-        " o.nickname              AS owner, "
-        " c.nickname              AS creator, "
-        " g.id_game               AS id_game, "
-        " g.id_creator            AS id_creator, "
-        " g.id_owner              AS id_owner, "
-        " g.state                 AS state, "
-        " unixepoch(g.created_at) AS created_at, "
-        " o.current_streak        AS owner_current_streak, "
-        " o.max_streak            AS owner_max_streak "
-        "FROM Game g "
-        "JOIN Player c ON c.id_player = g.id_creator "
-        "JOIN Player o ON o.id_player = g.id_owner "
-        "WHERE g.id_game = ?;";
-
     sqlite3_stmt *stmt = NULL;
-    int rc = sqlite3_prepare_v2(db, query, -1, &stmt, NULL);
+    int rc = db_statement_prepare(db, STMT_GAME_GET_BY_ID_WITH_PLAYER_INFO, &stmt);
     if (rc != SQLITE_OK) {
         LOG_ERROR("DATABASE ERROR (prepare): %s\n", sqlite3_errmsg(db));
         return GAME_DAO_SQL_ERROR;
@@ -426,7 +410,7 @@ GameDaoStatus get_game_by_id_with_player_info(sqlite3 *db, int64_t id_game, Game
     rc = sqlite3_bind_int64(stmt, 1, id_game);
     if (rc != SQLITE_OK) {
         LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return GAME_DAO_SQL_ERROR;
     }
 
@@ -449,24 +433,31 @@ GameDaoStatus get_game_by_id_with_player_info(sqlite3 *db, int64_t id_game, Game
         out->owner_current_streak = sqlite3_column_int(stmt, 7);
         out->owner_max_streak     = sqlite3_column_int(stmt, 8);
 
+        out->board_size = sqlite3_column_int(stmt, 9);
+        out->win_length = sqlite3_column_int(stmt, 10);
+
         snprintf(out->owner,   sizeof(out->owner),   "%s", owner   ? (const char*)owner   : "");
         snprintf(out->creator, sizeof(out->creator), "%s", creator ? (const char*)creator : "");
 
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return GAME_DAO_OK;
 
     } else if (rc == SQLITE_DONE) {
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return GAME_DAO_NOT_FOUND;
     } else {
         LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return GAME_DAO_SQL_ERROR;
     }
 }
 
 
-GameDaoStatus get_all_games_with_player_info(sqlite3 *db, GameWithPlayerNickname **out_array, int *out_count) {
+/**
+ * Games joined with the nicknames of creator and owner and the owner streaks.
+ * @param state Only the games in this state, `NULL` for every game
+ */
+GameDaoStatus get_all_games_with_player_info(sqlite3 *db, const char *state, GameWithPlayerNickname **out_array, int *out_count) {
 
     if (db == NULL || out_array == NULL || out_count == NULL) {
         return GAME_DAO_INVALID_INPUT;
@@ -477,28 +468,21 @@ GameDaoStatus get_all_games_with_player_info(sqlite3 *db, GameWithPlayerNickname
 
     int cap = 12;
 
-    const char *query =
-        "SELECT "
-        " g.id_game                  AS id_game, "
-        " g.id_creator               AS id_creator, "
-        " g.id_owner                 AS id_owner, "
-        " g.state                    AS state, "
-        " unixepoch(g.created_at)    AS created_at, "
-        " c.nickname                 AS creator, "
-        " o.nickname                 AS owner "
-        "FROM Game g "
-        "JOIN Player c ON c.id_player = g.id_creator "
-        "JOIN Player o ON o.id_player = g.id_owner "
-        "ORDER BY g.created_at DESC, g.id_game DESC;";
-
     sqlite3_stmt *stmt = NULL;
-    int rc = sqlite3_prepare_v2(db, query, -1, &stmt, NULL);
+    int rc = db_statement_prepare(db, STMT_GAME_GET_ALL_WITH_PLAYER_INFO, &stmt);
     if (rc != SQLITE_OK)
         goto prepare_fail;
 
-    GameWithPlayerNickname *array = malloc(sizeof(GameWithPlayerNickname) * cap);
+    rc = state ? sqlite3_bind_text(stmt, 1, state, -1, SQLITE_STATIC) : sqlite3_bind_null(stmt, 1);
+    if (rc != SQLITE_OK) {
+        LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
+        db_statement_release(stmt);
+        return GAME_DAO_SQL_ERROR;
+    }
+
+    GameWithPlayerNickname *array = arena_alloc(arena_thread(), sizeof(GameWithPlayerNickname) * cap);
     if (!array) {
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return GAME_DAO_MALLOC_ERROR;
     }
 
@@ -509,11 +493,10 @@ GameDaoStatus get_all_games_with_player_info(sqlite3 *db, GameWithPlayerNickname
         if (count == cap) {
             int new_cap = cap * 2;
             GameWithPlayerNickname *tmp =
-                realloc(array, sizeof(GameWithPlayerNickname) * new_cap);
+                arena_grow(arena_thread(), array, sizeof(GameWithPlayerNickname) * cap, sizeof(GameWithPlayerNickname) * new_cap);
 
             if (!tmp) {
-                free(array);
-                sqlite3_finalize(stmt);
+                db_statement_release(stmt);
                 return GAME_DAO_MALLOC_ERROR;
             }
 
@@ -548,17 +531,22 @@ GameDaoStatus get_all_games_with_player_info(sqlite3 *db, GameWithPlayerNickname
                  "%s",
                  owner ? owner : "");
 
+        array[count].owner_current_streak = sqlite3_column_int(stmt, col++);
+        array[count].owner_max_streak     = sqlite3_column_int(stmt, col++);
+
+        array[count].board_size = sqlite3_column_int(stmt, col++);
+        array[count].win_length = sqlite3_column_int(stmt, col++);
+
         count++;
     }
 
     if (rc != SQLITE_DONE) {
         LOG_ERROR("DATABASE ERROR: %s\n", sqlite3_errmsg(db));
-        free(array);
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return GAME_DAO_SQL_ERROR;
     }
 
-    sqlite3_finalize(stmt);
+    db_statement_release(stmt);
     *out_array = array;
     *out_count = count;
     return GAME_DAO_OK;
@@ -6,6 +6,8 @@
 #include "../../../include/debug_log.h"
 
 #include "participation_request_dao_sqlite.h"
+#include "db_connection_sqlite.h"
+#include "../../server/arena.h"
 
 const char *return_participation_request_dao_status_to_string(ParticipationRequestDaoStatus status) {
     switch (status) {
@@ -24,13 +26,9 @@ ParticipationRequestDaoStatus get_participation_request_by_id(sqlite3 *db, int64
         return PARTICIPATION_DAO_REQUEST_INVALID_INPUT;
     }
 
-    const char *sql = 
-        "SELECT id_request, id_player, id_game, unixepoch(created_at), state"
-        " FROM participation_request WHERE id_request = ?1";
-
     sqlite3_stmt *st = NULL;    
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_PARTICIPATION_REQUEST_GET_BY_ID, &st);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     rc = sqlite3_bind_int64(st , 1, id_request);
@@ -52,12 +50,12 @@ ParticipationRequestDaoStatus get_participation_request_by_id(sqlite3 *db, int64
             out->state = REQUEST_STATUS_INVALID;
         }
 
-        sqlite3_finalize(st); 
+        db_statement_release(st); 
         return PARTICIPATION_DAO_REQUEST_OK;
 
     } else if (rc == SQLITE_DONE) { 
 
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PARTICIPATION_DAO_REQUEST_NOT_FOUND;
 
     } else goto step_fail; 
@@ -68,12 +66,12 @@ ParticipationRequestDaoStatus get_participation_request_by_id(sqlite3 *db, int64
 
     bind_fail:
         LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PARTICIPATION_DAO_REQUEST_SQL_ERROR;
 
     step_fail:
         LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PARTICIPATION_DAO_REQUEST_SQL_ERROR;
 }
 
@@ -86,19 +84,17 @@ ParticipationRequestDaoStatus get_all_participation_requests(sqlite3 *db, Partic
     *out_array = NULL;
     *out_count = 0; 
 
-    const char *sql = "SELECT id_request, id_player, id_game, unixepoch(created_at), state FROM Participation_request"; 
-
     sqlite3_stmt *st = NULL;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_PARTICIPATION_REQUEST_GET_ALL, &st);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     int cap = 16; 
 
-    ParticipationRequest *p_request_array = malloc(sizeof(ParticipationRequest) * cap);
+    ParticipationRequest *p_request_array = arena_alloc(arena_thread(), sizeof(ParticipationRequest) * cap);
 
     if (!p_request_array) {
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PARTICIPATION_DAO_REQUEST_MALLOC_ERROR;
     }
 
@@ -108,11 +104,10 @@ ParticipationRequestDaoStatus get_all_participation_requests(sqlite3 *db, Partic
 
         if (count == cap) {
             int new_cap = cap * 2;
-            ParticipationRequest *tmp = realloc(p_request_array, sizeof(ParticipationRequest) * new_cap); 
+            ParticipationRequest *tmp = arena_grow(arena_thread(), p_request_array, sizeof(ParticipationRequest) * cap, sizeof(ParticipationRequest) * new_cap); 
 
             if(!tmp) {
-                free(p_request_array);
-                sqlite3_finalize(st);
+                db_statement_release(st);
                 return PARTICIPATION_DAO_REQUEST_MALLOC_ERROR;
             }
 
@@ -139,15 +134,14 @@ ParticipationRequestDaoStatus get_all_participation_requests(sqlite3 *db, Partic
 
     if (rc != SQLITE_DONE) {
         LOG_ERROR("DATABASE ERROR: %s\n", sqlite3_errmsg(db));
-        free(p_request_array);
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PARTICIPATION_DAO_REQUEST_SQL_ERROR;
     }
 
     *out_array = p_request_array;  
     *out_count = count;
 
-    sqlite3_finalize(st);
+    db_statement_release(st);
 
     return PARTICIPATION_DAO_REQUEST_OK;
 
@@ -284,11 +278,9 @@ ParticipationRequestDaoStatus delete_participation_request_by_id(sqlite3 *db, in
         return PARTICIPATION_DAO_REQUEST_INVALID_INPUT;
     }
 
-    const char *query = "DELETE FROM Participation_request WHERE id_request = ?1";
-
     sqlite3_stmt *stmt = NULL;
 
-    int rc = sqlite3_prepare_v2(db, query, -1, &stmt, NULL);
+    int rc = db_statement_prepare(db, STMT_PARTICIPATION_REQUEST_DELETE_BY_ID, &stmt);
     if (rc != SQLITE_OK) goto prepare_fail; 
 
     rc = sqlite3_bind_int64(stmt, 1, id_request);
@@ -297,7 +289,7 @@ ParticipationRequestDaoStatus delete_participation_request_by_id(sqlite3 *db, in
     rc = sqlite3_step(stmt);
     if(rc != SQLITE_DONE) goto step_fail;
 
-    sqlite3_finalize(stmt);
+    db_statement_release(stmt);
 
     if (sqlite3_changes(db) == 0) return PARTICIPATION_DAO_REQUEST_NOT_FOUND;
 
@@ -309,12 +301,12 @@ ParticipationRequestDaoStatus delete_participation_request_by_id(sqlite3 *db, in
     
     bind_fail:
         LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return PARTICIPATION_DAO_REQUEST_SQL_ERROR;
 
     step_fail:
         LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return PARTICIPATION_DAO_REQUEST_SQL_ERROR;
 }
 
@@ -333,11 +325,8 @@ ParticipationRequestDaoStatus insert_participation_request(sqlite3 *db, Particip
     }
 
     sqlite3_stmt *stmt = NULL;
-    const char *query =
-        "INSERT INTO Participation_request (id_player, id_game, created_at, state) "
-        "VALUES (?, ?, datetime(?,'unixepoch'), ?) RETURNING id_request, id_player, id_game, unixepoch(created_at), state";
 
-    int rc = sqlite3_prepare_v2(db, query, -1, &stmt, NULL);
+    int rc = db_statement_prepare(db, STMT_PARTICIPATION_REQUEST_INSERT, &stmt);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     int p = 1;
@@ -353,7 +342,7 @@ ParticipationRequestDaoStatus insert_participation_request(sqlite3 *db, Particip
 
     const char *state_str = request_participation_status_to_string(in_out_request->state);
     if (!state_str) { 
-        sqlite3_finalize(stmt); 
+        db_statement_release(stmt); 
         return PARTICIPATION_DAO_REQUEST_INVALID_INPUT; 
     }
 
@@ -370,7 +359,7 @@ ParticipationRequestDaoStatus insert_participation_request(sqlite3 *db, Particip
     const unsigned char *state = sqlite3_column_text(stmt, 4);
     in_out_request->state = string_to_request_participation_status((const char*) state);
 
-    sqlite3_finalize(stmt);
+    db_statement_release(stmt);
     return PARTICIPATION_DAO_REQUEST_OK;
 
     prepare_fail:
@@ -379,12 +368,12 @@ ParticipationRequestDaoStatus insert_participation_request(sqlite3 *db, Particip
 
     bind_fail:
         LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return PARTICIPATION_DAO_REQUEST_SQL_ERROR;
 
     step_fail:
         LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return PARTICIPATION_DAO_REQUEST_SQL_ERROR;
 }
 
@@ -393,20 +382,8 @@ ParticipationRequestDaoStatus get_participation_request_by_id_with_player_info(s
         return PARTICIPATION_DAO_REQUEST_INVALID_INPUT;
     }
 
-    const char *sql =
-        "SELECT "
-        " pr.id_request, "
-        " pr.id_player, "
-        " pr.id_game, "
-        " unixepoch(pr.created_at) AS created_at, "
-        " pr.state, "
-        " p.nickname "
-        "FROM Participation_request pr "
-        "JOIN Player p ON p.id_player = pr.id_player "
-        "WHERE pr.id_request = ?1;";
-
     sqlite3_stmt *st = NULL;
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_PARTICIPATION_REQUEST_GET_BY_ID_WITH_PLAYER_INFO, &st);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     rc = sqlite3_bind_int64(st, 1, id_request);
@@ -431,11 +408,11 @@ ParticipationRequestDaoStatus get_participation_request_by_id_with_player_info(s
 
         snprintf(out->player_nickname, sizeof out->player_nickname, "%s", nickname ? (const char *)nickname : "");
 
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PARTICIPATION_DAO_REQUEST_OK;
 
     } else if (rc == SQLITE_DONE) {
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PARTICIPATION_DAO_REQUEST_NOT_FOUND;
         
     } else {
@@ -444,17 +421,17 @@ ParticipationRequestDaoStatus get_participation_request_by_id_with_player_info(s
 
 prepare_fail:
     LOG_ERROR("DATABASE ERROR (prepare): %s\n", sqlite3_errmsg(db));
-    if (st) sqlite3_finalize(st);
+    if (st) db_statement_release(st);
     return PARTICIPATION_DAO_REQUEST_SQL_ERROR;
 
 bind_fail:
     LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-    if (st) sqlite3_finalize(st);
+    if (st) db_statement_release(st);
     return PARTICIPATION_DAO_REQUEST_SQL_ERROR;
 
 step_fail:
     LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-    if (st) sqlite3_finalize(st);
+    if (st) db_statement_release(st);
     return PARTICIPATION_DAO_REQUEST_SQL_ERROR;
 }
 
@@ -467,21 +444,17 @@ ParticipationRequestDaoStatus get_all_participation_requests_with_player_info(sq
     *out_array = NULL;
     *out_count = 0; 
 
-    const char *sql = "SELECT pr.id_request, pr.id_player, pr.id_game, unixepoch(pr.created_at), pr.state, p.nickname AS player_nickname "
-                      "FROM Participation_request pr JOIN Player p ON pr.id_player = p.id_player "
-                      "ORDER BY pr.created_at DESC"; 
-
     sqlite3_stmt *st = NULL;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_PARTICIPATION_REQUEST_GET_ALL_WITH_PLAYER_INFO, &st);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     int cap = 16; 
 
-    ParticipationRequestWithPlayerNickname *p_request_array = malloc(sizeof(ParticipationRequestWithPlayerNickname) * cap);
+    ParticipationRequestWithPlayerNickname *p_request_array = arena_alloc(arena_thread(), sizeof(ParticipationRequestWithPlayerNickname) * cap);
 
     if (!p_request_array) {
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PARTICIPATION_DAO_REQUEST_MALLOC_ERROR;
     }
 
@@ -491,11 +464,10 @@ ParticipationRequestDaoStatus get_all_participation_requests_with_player_info(sq
 
         if (count == cap) {
             int new_cap = cap * 2;
-            ParticipationRequestWithPlayerNickname *tmp = realloc(p_request_array, sizeof(ParticipationRequestWithPlayerNickname) * new_cap); 
+            ParticipationRequestWithPlayerNickname *tmp = arena_grow(arena_thread(), p_request_array, sizeof(ParticipationRequestWithPlayerNickname) * cap, sizeof(ParticipationRequestWithPlayerNickname) * new_cap); 
 
             if(!tmp) {
-                free(p_request_array);
-                sqlite3_finalize(st);
+                db_statement_release(st);
                 return PARTICIPATION_DAO_REQUEST_MALLOC_ERROR;
             }
 
@@ -526,15 +498,14 @@ ParticipationRequestDaoStatus get_all_participation_requests_with_player_info(sq
 
     if (rc != SQLITE_DONE) {
         LOG_ERROR("DATABASE ERROR: %s\n", sqlite3_errmsg(db));
-        free(p_request_array);
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PARTICIPATION_DAO_REQUEST_SQL_ERROR;
     }
 
     *out_array = p_request_array;  
     *out_count = count;
 
-    sqlite3_finalize(st);
+    db_statement_release(st);
 
     return PARTICIPATION_DAO_REQUEST_OK;
 
@@ -552,22 +523,17 @@ ParticipationRequestDaoStatus get_all_pending_participation_request_by_id_game(s
     *out_count = 0;
     *out_array = NULL;
 
-    const char *sql = "SELECT id_request, id_player, id_game, unixepoch(created_at), state "
-                      "FROM Participation_request "
-                      "WHERE id_game = ?1 AND state = 'pending' "
-                      "ORDER BY created_at DESC"; 
-
     sqlite3_stmt *st = NULL;
     
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_PARTICIPATION_REQUEST_GET_PENDING_BY_GAME, &st);
     if(rc != SQLITE_OK) goto prepare_fail;
 
     int cap = 16;
 
-    ParticipationRequest *p_request_array = malloc(sizeof(ParticipationRequest) * cap);
+    ParticipationRequest *p_request_array = arena_alloc(arena_thread(), sizeof(ParticipationRequest) * cap);
 
     if(!p_request_array) {
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PARTICIPATION_DAO_REQUEST_MALLOC_ERROR;
     }
 
@@ -580,11 +546,10 @@ ParticipationRequestDaoStatus get_all_pending_participation_request_by_id_game(s
 
         if (count == cap) {
             int new_cap = cap*2;
-            ParticipationRequest *tmp = realloc(p_request_array, sizeof(ParticipationRequest) * new_cap);
+            ParticipationRequest *tmp = arena_grow(arena_thread(), p_request_array, sizeof(ParticipationRequest) * cap, sizeof(ParticipationRequest) * new_cap);
 
             if (!tmp) {
-                free(p_request_array);
-                sqlite3_finalize(st);
+                db_statement_release(st);
                 return PARTICIPATION_DAO_REQUEST_MALLOC_ERROR;
             }
             
@@ -610,15 +575,14 @@ ParticipationRequestDaoStatus get_all_pending_participation_request_by_id_game(s
 
     if (rc != SQLITE_DONE) {
         LOG_ERROR("DATABASE ERROR: %s\n", sqlite3_errmsg(db));
-        free(p_request_array);
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PARTICIPATION_DAO_REQUEST_SQL_ERROR;
     }
 
     *out_array = p_request_array;  
     *out_count = count;
 
-    sqlite3_finalize(st);
+    db_statement_release(st);
 
     return PARTICIPATION_DAO_REQUEST_OK;
 
@@ -628,6 +592,6 @@ ParticipationRequestDaoStatus get_all_pending_participation_request_by_id_game(s
 
     bind_fail:
     LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-    sqlite3_finalize(st);
+    db_statement_release(st);
     return PARTICIPATION_DAO_REQUEST_SQL_ERROR;
 }
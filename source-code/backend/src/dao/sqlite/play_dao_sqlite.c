@@ -6,6 +6,8 @@
 #include "../../../include/debug_log.h"
 
 #include "play_dao_sqlite.h"
+#include "db_connection_sqlite.h"
+#include "../../server/arena.h"
 
 const char *return_play_dao_status_to_string(PlayDaoStatus status) {
     switch (status) {
@@ -23,13 +25,9 @@ PlayDaoStatus get_play_by_pk(sqlite3 *db, int64_t id_player, int64_t id_round, P
         return PLAY_DAO_INVALID_INPUT;
     }
 
-    const char *sql = 
-        "SELECT result, player_number"
-        " FROM Play WHERE id_player = ?1 AND id_round = ?2";
-
     sqlite3_stmt *st = NULL;    
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_PLAY_GET_BY_PK, &st);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     rc = sqlite3_bind_int64(st , 1, id_player);
@@ -53,12 +51,12 @@ PlayDaoStatus get_play_by_pk(sqlite3 *db, int64_t id_player, int64_t id_round, P
             out->result = PLAY_RESULT_INVALID;
         }
 
-        sqlite3_finalize(st); 
+        db_statement_release(st); 
         return PLAY_DAO_OK;
 
     } else if (rc == SQLITE_DONE) { 
 
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAY_DAO_NOT_FOUND;
 
     } else goto step_fail;
@@ -69,12 +67,12 @@ PlayDaoStatus get_play_by_pk(sqlite3 *db, int64_t id_player, int64_t id_round, P
 
     bind_fail:
         LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAY_DAO_SQL_ERROR;
 
     step_fail:
         LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAY_DAO_SQL_ERROR;
 }
 
@@ -87,19 +85,17 @@ PlayDaoStatus get_all_plays(sqlite3 *db, Play **out_array, int *out_count) {
     *out_array = NULL;
     *out_count = 0; 
 
-    const char *sql = "SELECT id_player, id_round, result, player_number FROM Play"; 
-
     sqlite3_stmt *st = NULL;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_PLAY_GET_ALL, &st);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     int cap = 16; 
 
-    Play *plays_array = malloc(sizeof(Play) * cap);
+    Play *plays_array = arena_alloc(arena_thread(), sizeof(Play) * cap);
 
     if (!plays_array) {
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAY_DAO_MALLOC_ERROR;
     }
 
@@ -109,11 +105,10 @@ PlayDaoStatus get_all_plays(sqlite3 *db, Play **out_array, int *out_count) {
 
         if (count == cap) {
             int new_cap = cap * 2;
-            Play *tmp = realloc(plays_array, sizeof(Play)* new_cap); 
+            Play *tmp = arena_grow(arena_thread(), plays_array, sizeof(Play) * cap, sizeof(Play) * new_cap); 
 
             if(!tmp) {
-                free(plays_array);
-                sqlite3_finalize(st);
+                db_statement_release(st);
                 return PLAY_DAO_MALLOC_ERROR;
             }
 
@@ -139,15 +134,14 @@ PlayDaoStatus get_all_plays(sqlite3 *db, Play **out_array, int *out_count) {
 
     if (rc != SQLITE_DONE) {
         LOG_ERROR("DATABASE ERROR: %s\n", sqlite3_errmsg(db));
-        free(plays_array);
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAY_DAO_SQL_ERROR;
     }
 
     *out_array = plays_array; 
     *out_count = count;
 
-    sqlite3_finalize(st);
+    db_statement_release(st);
 
     return PLAY_DAO_OK;
 
@@ -259,11 +253,9 @@ PlayDaoStatus delete_play_by_pk(sqlite3 *db, int64_t id_player, int64_t id_round
         return PLAY_DAO_INVALID_INPUT;
     }
 
-    const char *query = "DELETE FROM Play WHERE id_player = ?1 AND id_round = ?2";
-
     sqlite3_stmt *stmt = NULL;
 
-    int rc = sqlite3_prepare_v2(db, query, -1, &stmt, NULL);
+    int rc = db_statement_prepare(db, STMT_PLAY_DELETE_BY_PK, &stmt);
     if (rc != SQLITE_OK) goto prepare_fail; 
 
     rc = sqlite3_bind_int64(stmt, 1, id_player);
@@ -275,7 +267,7 @@ PlayDaoStatus delete_play_by_pk(sqlite3 *db, int64_t id_player, int64_t id_round
     rc = sqlite3_step(stmt);
     if(rc != SQLITE_DONE) goto step_fail;
 
-    sqlite3_finalize(stmt);
+    db_statement_release(stmt);
 
     if (sqlite3_changes(db) == 0) return PLAY_DAO_NOT_FOUND;
 
@@ -287,12 +279,12 @@ PlayDaoStatus delete_play_by_pk(sqlite3 *db, int64_t id_player, int64_t id_round
     
     bind_fail:
         LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return PLAY_DAO_SQL_ERROR;
 
     step_fail:
         LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return PLAY_DAO_SQL_ERROR;
 }
 
@@ -308,11 +300,7 @@ PlayDaoStatus insert_play(sqlite3 *db, Play *in_out_play) {
 
     sqlite3_stmt *stmt = NULL;
 
-    const char *query = 
-        "INSERT INTO Play (id_player, id_round, result, player_number)"
-        " VALUES ( ?1, ?2, ?3, ?4) RETURNING id_player, id_round, result, player_number";
-
-    int rc = sqlite3_prepare_v2(db, query, -1, &stmt, NULL);
+    int rc = db_statement_prepare(db, STMT_PLAY_INSERT, &stmt);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     rc = sqlite3_bind_int64(stmt, 1, in_out_play->id_player);
@@ -328,7 +316,7 @@ PlayDaoStatus insert_play(sqlite3 *db, Play *in_out_play) {
     } else {
         const char *p_st = play_result_to_string(in_out_play->result);
         if (!p_st) {
-            sqlite3_finalize(stmt);
+            db_statement_release(stmt);
             return PLAY_DAO_INVALID_INPUT;
         }
         rc = sqlite3_bind_text(stmt, 3, p_st, -1, SQLITE_TRANSIENT);
@@ -353,7 +341,7 @@ PlayDaoStatus insert_play(sqlite3 *db, Play *in_out_play) {
 
     in_out_play->player_number = sqlite3_column_int(stmt, 3);
 
-    sqlite3_finalize(stmt);
+    db_statement_release(stmt);
     return PLAY_DAO_OK;
 
     prepare_fail:
@@ -362,12 +350,12 @@ PlayDaoStatus insert_play(sqlite3 *db, Play *in_out_play) {
 
     bind_fail:
         LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return PLAY_DAO_SQL_ERROR;
 
     step_fail:
         LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return PLAY_DAO_SQL_ERROR;
 }
 
@@ -377,19 +365,8 @@ PlayDaoStatus get_play_by_pk_with_player_info(sqlite3 *db, int64_t id_player, in
         return PLAY_DAO_INVALID_INPUT;
     }
 
-    const char *sql =
-        "SELECT "
-        " y.id_player, "
-        " y.id_round, "
-        " y.result, "
-        " y.player_number, "
-        " p.nickname AS player_nickname "
-        "FROM Play y "
-        "JOIN Player p ON y.id_player = p.id_player "
-        "WHERE y.id_player = ?1 AND y.id_round = ?2;";
-
     sqlite3_stmt *st = NULL;
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_PLAY_GET_BY_PK_WITH_PLAYER_INFO, &st);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     rc = sqlite3_bind_int64(st, 1, id_player);
@@ -416,11 +393,11 @@ PlayDaoStatus get_play_by_pk_with_player_info(sqlite3 *db, int64_t id_player, in
             out->result = PLAY_RESULT_INVALID;
         }
 
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAY_DAO_OK;
 
     }  else if (rc == SQLITE_DONE) {
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAY_DAO_NOT_FOUND;
         
     } else {
@@ -429,17 +406,17 @@ PlayDaoStatus get_play_by_pk_with_player_info(sqlite3 *db, int64_t id_player, in
 
 prepare_fail:
     LOG_ERROR("DATABASE ERROR (prepare): %s\n", sqlite3_errmsg(db));
-    if (st) sqlite3_finalize(st);
+    if (st) db_statement_release(st);
     return PLAY_DAO_SQL_ERROR;
 
 bind_fail:
     LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-    if (st) sqlite3_finalize(st);
+    if (st) db_statement_release(st);
     return PLAY_DAO_SQL_ERROR;
 
 step_fail:
     LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-    if (st) sqlite3_finalize(st);
+    if (st) db_statement_release(st);
     return PLAY_DAO_SQL_ERROR;
 }
 
@@ -452,21 +429,17 @@ PlayDaoStatus get_all_plays_with_player_info(sqlite3 *db, PlayWithPlayerNickname
     *out_array = NULL;
     *out_count = 0; 
 
-    const char *sql = "SELECT y.id_player, y.id_round, y.result, y.player_number, p.nickname AS player_nickname "
-                      "FROM Play y JOIN Player p ON y.id_player = p.id_player "
-                      "ORDER BY y.id_round ASC;"; 
-
     sqlite3_stmt *st = NULL;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_PLAY_GET_ALL_WITH_PLAYER_INFO, &st);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     int cap = 16; 
 
-    PlayWithPlayerNickname *plays_array = malloc(sizeof(PlayWithPlayerNickname) * cap);
+    PlayWithPlayerNickname *plays_array = arena_alloc(arena_thread(), sizeof(PlayWithPlayerNickname) * cap);
 
     if (!plays_array) {
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAY_DAO_MALLOC_ERROR;
     }
 
@@ -476,11 +449,10 @@ PlayDaoStatus get_all_plays_with_player_info(sqlite3 *db, PlayWithPlayerNickname
 
         if (count == cap) {
             int new_cap = cap * 2;
-            PlayWithPlayerNickname *tmp = realloc(plays_array, sizeof(PlayWithPlayerNickname)* new_cap); 
+            PlayWithPlayerNickname *tmp = arena_grow(arena_thread(), plays_array, sizeof(PlayWithPlayerNickname) * cap, sizeof(PlayWithPlayerNickname) * new_cap); 
 
             if(!tmp) {
-                free(plays_array);
-                sqlite3_finalize(st);
+                db_statement_release(st);
                 return PLAY_DAO_MALLOC_ERROR;
             }
 
@@ -508,15 +480,14 @@ PlayDaoStatus get_all_plays_with_player_info(sqlite3 *db, PlayWithPlayerNickname
 
     if (rc != SQLITE_DONE) {
         LOG_ERROR("DATABASE ERROR: %s\n", sqlite3_errmsg(db));
-        free(plays_array);
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAY_DAO_SQL_ERROR;
     }
 
     *out_array = plays_array; 
     *out_count = count;
 
-    sqlite3_finalize(st);
+    db_statement_release(st);
 
     return PLAY_DAO_OK;
 
@@ -534,14 +505,9 @@ PlayDaoStatus get_all_plays_by_round(sqlite3 *db, int64_t id_round, Play **out_a
     *out_array = NULL;
     *out_count = 0; 
 
-    const char *sql = "SELECT id_player, id_round, result, player_number "
-                      "FROM Play "
-                      "WHERE id_round = ?1 "
-                      "ORDER BY id_round ASC;"; 
-
     sqlite3_stmt *st = NULL;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_PLAY_GET_ALL_BY_ROUND, &st);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     rc = sqlite3_bind_int64(st, 1, id_round);
@@ -549,10 +515,10 @@ PlayDaoStatus get_all_plays_by_round(sqlite3 *db, int64_t id_round, Play **out_a
 
     int cap = 2; 
 
-    Play *plays_array = malloc(sizeof(Play) * cap);
+    Play *plays_array = arena_alloc(arena_thread(), sizeof(Play) * cap);
 
     if (!plays_array) {
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAY_DAO_MALLOC_ERROR;
     }
 
@@ -562,11 +528,10 @@ PlayDaoStatus get_all_plays_by_round(sqlite3 *db, int64_t id_round, Play **out_a
 
         if (count == cap) {
             int new_cap = cap * 2;
-            Play *tmp = realloc(plays_array, sizeof(Play)* new_cap); 
+            Play *tmp = arena_grow(arena_thread(), plays_array, sizeof(Play) * cap, sizeof(Play) * new_cap); 
 
             if(!tmp) {
-                free(plays_array);
-                sqlite3_finalize(st);
+                db_statement_release(st);
                 return PLAY_DAO_MALLOC_ERROR;
             }
 
@@ -592,15 +557,14 @@ PlayDaoStatus get_all_plays_by_round(sqlite3 *db, int64_t id_round, Play **out_a
 
     if (rc != SQLITE_DONE) {
         LOG_ERROR("DATABASE ERROR: %s\n", sqlite3_errmsg(db));
-        free(plays_array);
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAY_DAO_SQL_ERROR;
     }
 
     *out_array = plays_array; 
     *out_count = count;
 
-    sqlite3_finalize(st);
+    db_statement_release(st);
 
     return PLAY_DAO_OK;
 
@@ -610,6 +574,6 @@ PlayDaoStatus get_all_plays_by_round(sqlite3 *db, int64_t id_round, Play **out_a
 
     bind_fail:
         LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAY_DAO_SQL_ERROR;
 }
@@ -6,6 +6,8 @@
 #include "../../../include/debug_log.h"
 
 #include "player_dao_sqlite.h"
+#include "db_connection_sqlite.h"
+#include "../../server/arena.h"
 
 const char *return_player_dao_status_to_string(PlayerDaoStatus status) {
     switch (status) {
@@ -25,10 +27,6 @@ PlayerDaoStatus get_player_by_id(sqlite3 *db, int64_t id, Player *out) {
 
     //We have unixepoch(registration_date), which is a sqlite3 function that converts a TEXT db type to time_t entity value
 
-    const char *sql = 
-        "SELECT id_player, nickname, email, password, current_streak, max_streak, unixepoch(registration_date) "
-        "FROM Player WHERE id_player = ?1";
-
     sqlite3_stmt *st = NULL;    //pointer to compiled query (statement)
 
     //This SQLite function requires:
@@ -38,7 +36,7 @@ PlayerDaoStatus get_player_by_id(sqlite3 *db, int64_t id, Player *out) {
     //  4 - in this pointer the function saved the address of compiled object, the latter is obtained from the translation of the SQL string into bytecode for the SQLite engine.
     //  5 - used to find out where the query part used has ended up (is optional)
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_PLAYER_GET_BY_ID, &st);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     //This SQLite function used to replace placeholder in the query
@@ -84,12 +82,12 @@ PlayerDaoStatus get_player_by_id(sqlite3 *db, int64_t id, Player *out) {
             out->password[0] = '\0';
         }
 
-        sqlite3_finalize(st); //We're closing the statement here
+        db_statement_release(st); //We're closing the statement here
         return PLAYER_DAO_OK;
 
     } else if (rc == SQLITE_DONE) { //If slite3 return SQLITE_DONE and not SQLITE_ROW for SELECT operation, it means that the player was not found
 
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAYER_DAO_NOT_FOUND;
 
     } else goto step_fail;  
@@ -100,12 +98,12 @@ PlayerDaoStatus get_player_by_id(sqlite3 *db, int64_t id, Player *out) {
 
     bind_fail:
         LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAYER_DAO_SQL_ERROR;
 
     step_fail:
         LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAYER_DAO_SQL_ERROR;
 }
 
@@ -118,19 +116,17 @@ PlayerDaoStatus get_all_players(sqlite3 *db, Player **out_array, int *out_count)
     *out_array = NULL;
     *out_count = 0; 
 
-    const char *sql = "SELECT id_player, nickname, email, password, current_streak, max_streak, unixepoch(registration_date) FROM Player"; //Avoid using SELECT *, so if the table will change we won't have problems with columns
-
     sqlite3_stmt *st = NULL;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_PLAYER_GET_ALL, &st);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     int cap = 16; //arbitrary field
 
-    Player *player_array = malloc(sizeof(Player) * cap);
+    Player *player_array = arena_alloc(arena_thread(), sizeof(Player) * cap);
 
     if (!player_array) {
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAYER_DAO_MALLOC_ERROR;
     }
 
@@ -140,11 +136,10 @@ PlayerDaoStatus get_all_players(sqlite3 *db, Player **out_array, int *out_count)
 
         if (count == cap) {
             int new_cap = cap * 2;
-            Player *tmp = realloc(player_array, sizeof(Player)* new_cap); //We use realloc because we may alreay have some rows saved
+            Player *tmp = arena_grow(arena_thread(), player_array, sizeof(Player) * cap, sizeof(Player) * new_cap); //We grow the array because we may alreay have some rows saved
 
             if(!tmp) {
-                free(player_array);
-                sqlite3_finalize(st);
+                db_statement_release(st);
                 return PLAYER_DAO_MALLOC_ERROR;
             }
 
@@ -185,15 +180,14 @@ PlayerDaoStatus get_all_players(sqlite3 *db, Player **out_array, int *out_count)
 
     if (rc != SQLITE_DONE) {
         LOG_ERROR("DATABASE ERROR: %s\n", sqlite3_errmsg(db));
-        free(player_array);
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAYER_DAO_SQL_ERROR;
     }
 
     *out_array = player_array; //We're assigning to the caller pointer the address of array 
     *out_count = count;
 
-    sqlite3_finalize(st);
+    db_statement_release(st);
 
     return PLAYER_DAO_OK;
 
@@ -368,11 +362,9 @@ PlayerDaoStatus delete_player_by_id(sqlite3 *db, int64_t id) {
         return PLAYER_DAO_INVALID_INPUT;
     }
 
-    const char *query = "DELETE FROM Player WHERE id_player = ?1";
-
     sqlite3_stmt *stmt = NULL;
 
-    int rc = sqlite3_prepare_v2(db, query, -1, &stmt, NULL);
+    int rc = db_statement_prepare(db, STMT_PLAYER_DELETE_BY_ID, &stmt);
     if (rc != SQLITE_OK) goto prepare_fail; 
 
     rc = sqlite3_bind_int64(stmt, 1, id);
@@ -381,7 +373,7 @@ PlayerDaoStatus delete_player_by_id(sqlite3 *db, int64_t id) {
     rc = sqlite3_step(stmt);
     if(rc != SQLITE_DONE) goto step_fail;
 
-    sqlite3_finalize(stmt);
+    db_statement_release(stmt);
 
     //If there have been no changes, then it has not been found
     if (sqlite3_changes(db) == 0) return PLAYER_DAO_NOT_FOUND;
@@ -394,12 +386,12 @@ PlayerDaoStatus delete_player_by_id(sqlite3 *db, int64_t id) {
     
     bind_fail:
         LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return PLAYER_DAO_SQL_ERROR;
 
     step_fail:
         LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return PLAYER_DAO_SQL_ERROR;
 }
 
@@ -411,17 +403,13 @@ PlayerDaoStatus insert_player(sqlite3* db, Player *in_out_player) {
 
     sqlite3_stmt *stmt = NULL;
 
-    const char *query = 
-        "INSERT INTO Player (nickname, email, password, current_streak, max_streak, registration_date)"
-        " VALUES ( ?, ?, ?, ?, ?, datetime(?,'unixepoch')) RETURNING id_player, nickname, email, password, current_streak, max_streak, unixepoch(registration_date)";
-
     if (in_out_player->nickname[0] == '\0' || in_out_player->email[0]    == '\0' ||
         in_out_player->password[0] == '\0' || in_out_player->current_streak < 0   ||
         in_out_player->max_streak    < 0   || in_out_player->registration_date == 0) {
         return PLAYER_DAO_INVALID_INPUT;
     }
 
-    int rc = sqlite3_prepare_v2(db, query, -1, &stmt, NULL);
+    int rc = db_statement_prepare(db, STMT_PLAYER_INSERT, &stmt);
 
     if (rc != SQLITE_OK) goto prepare_fail;
 
@@ -455,7 +443,7 @@ PlayerDaoStatus insert_player(sqlite3* db, Player *in_out_player) {
     in_out_player->max_streak = sqlite3_column_int(stmt, 5);
     in_out_player->registration_date = (time_t) sqlite3_column_int64(stmt, 6);
 
-    sqlite3_finalize(stmt);
+    db_statement_release(stmt);
     return PLAYER_DAO_OK;
 
     prepare_fail:
@@ -464,12 +452,12 @@ PlayerDaoStatus insert_player(sqlite3* db, Player *in_out_player) {
 
     bind_fail:
         LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return PLAYER_DAO_SQL_ERROR;
 
     step_fail:
         LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        db_statement_release(stmt);
         return PLAYER_DAO_SQL_ERROR;
 }
 
@@ -479,12 +467,9 @@ PlayerDaoStatus get_player_by_nickname(sqlite3 *db, const char *nickname, Player
         return PLAYER_DAO_INVALID_INPUT;
     }
 
-    const char *sql= "SELECT id_player, nickname, email, password, current_streak, max_streak, unixepoch(registration_date) "
-                     "FROM Player WHERE nickname = ?1";
-
     sqlite3_stmt *st = NULL;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_PLAYER_GET_BY_NICKNAME, &st);
 
     if (st == NULL) {
         LOG_ERROR("DATABASE ERROR (prepare): %s\n", sqlite3_errmsg(db));
@@ -524,24 +509,24 @@ PlayerDaoStatus get_player_by_nickname(sqlite3 *db, const char *nickname, Player
             out->password[0] = '\0';
         }
 
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAYER_DAO_OK;
 
     } else if (rc == SQLITE_DONE) {
 
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAYER_DAO_NOT_FOUND;
 
     } else goto step_fail;
 
     bind_fail:
         LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAYER_DAO_SQL_ERROR;
 
     step_fail:
         LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAYER_DAO_SQL_ERROR;
 }
 
@@ -551,12 +536,9 @@ PlayerDaoStatus get_player_by_email(sqlite3 *db, const char *email, Player *out)
         return PLAYER_DAO_INVALID_INPUT;
     }
 
-    const char *sql= "SELECT id_player, nickname, email, password, current_streak, max_streak, unixepoch(registration_date) "
-                     "FROM Player WHERE email = ?1";
-
     sqlite3_stmt *st = NULL;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_PLAYER_GET_BY_EMAIL, &st);
 
     if (st == NULL) {
         LOG_ERROR("DATABASE ERROR (prepare): %s\n", sqlite3_errmsg(db));
@@ -596,23 +578,23 @@ PlayerDaoStatus get_player_by_email(sqlite3 *db, const char *email, Player *out)
             out->password[0] = '\0';
         }
 
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAYER_DAO_OK;
 
     } else if (rc == SQLITE_DONE) {
 
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAYER_DAO_NOT_FOUND;
 
     } else goto step_fail;
 
     bind_fail:
         LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAYER_DAO_SQL_ERROR;
 
     step_fail:
         LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return PLAYER_DAO_SQL_ERROR;
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 
 #include "../../../include/debug_log.h"
 #include "round_dao_sqlite.h"
+#include "db_connection_sqlite.h"
+#include "../../server/arena.h"
 
 /* =========================================================
  * Utils
@@ -22,25 +24,22 @@ const char *return_round_dao_status_to_string(RoundDaoStatus status) {
 }
 
 /* =========================================================
- * GET ROUND BY ID
+ * GET ONE ROUND
  * ========================================================= */
 
-RoundDaoStatus get_round_by_id(sqlite3 *db, int64_t id_round, Round *out) {
+// Runs a statement returning at most one Round row, `key` is bound to ?1
+static RoundDaoStatus get_one_round(sqlite3 *db, DbStatementId id, int64_t key, Round *out) {
 
-    if (!db || !out || id_round <= 0)
+    if (!db || !out || key <= 0)
         return ROUND_DAO_INVALID_INPUT;
 
     memset(out, 0, sizeof(*out));
 
-    const char *sql =
-        "SELECT id_round, id_game, state, start_time, end_time, board "
-        "FROM Round WHERE id_round = ?1";
-
     sqlite3_stmt *st = NULL;
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, id, &st);
     if (rc != SQLITE_OK) goto prepare_fail;
 
-    rc = sqlite3_bind_int64(st, 1, id_round);
+    rc = sqlite3_bind_int64(st, 1, key);
     if (rc != SQLITE_OK) goto bind_fail;
 
     rc = sqlite3_step(st);
@@ -63,17 +62,15 @@ RoundDaoStatus get_round_by_id(sqlite3 *db, int64_t id_round, Round *out) {
             out->end_time = sqlite3_column_int64(st, 4);
 
         const unsigned char *board = sqlite3_column_text(st, 5);
-        if (board) {
-            strncpy(out->board, (const char *)board, sizeof(out->board) - 1);
-            out->board[sizeof(out->board) - 1] = '\0';
-        }
+        if (board_from_string((const char *)board, sqlite3_column_int(st, 6), &out->board) != 0)
+            LOG_WARN("Round %" PRId64 " has an invalid board\n", out->id_round);
 
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return ROUND_DAO_OK;
     }
 
     if (rc == SQLITE_DONE) {
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return ROUND_DAO_NOT_FOUND;
     }
 
@@ -85,15 +82,37 @@ prepare_fail:
 
 bind_fail:
     LOG_ERROR("DATABASE ERROR (bind): %s\n", sqlite3_errmsg(db));
-    sqlite3_finalize(st);
+    db_statement_release(st);
     return ROUND_DAO_SQL_ERROR;
 
 step_fail:
     LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-    sqlite3_finalize(st);
+    db_statement_release(st);
     return ROUND_DAO_SQL_ERROR;
 }
 
+/* =========================================================
+ * GET ROUND BY ID
+ * ========================================================= */
+
+RoundDaoStatus get_round_by_id(sqlite3 *db, int64_t id_round, Round *out) {
+    return get_one_round(db, STMT_ROUND_GET_BY_ID, id_round, out);
+}
+
+/* =========================================================
+ * GET ROUNDS BY GAME
+ * ========================================================= */
+
+// Round of the game still being played, ROUND_DAO_NOT_FOUND if there is none
+RoundDaoStatus get_active_round_by_game(sqlite3 *db, int64_t id_game, Round *out) {
+    return get_one_round(db, STMT_ROUND_GET_ACTIVE_BY_GAME, id_game, out);
+}
+
+// Most recent round of the game whatever its state, ROUND_DAO_NOT_FOUND if the game has no rounds
+RoundDaoStatus get_last_round_by_game(sqlite3 *db, int64_t id_game, Round *out) {
+    return get_one_round(db, STMT_ROUND_GET_LAST_BY_GAME, id_game, out);
+}
+
 /* =========================================================
  * GET ALL ROUNDS
  * ========================================================= */
@@ -106,33 +125,29 @@ RoundDaoStatus get_all_rounds(sqlite3 *db, Round **out_array, int *out_count) {
     *out_array = NULL;
     *out_count = 0;
 
-    const char *sql =
-        "SELECT id_round, id_game, state, start_time, end_time, board FROM Round";
-
     sqlite3_stmt *st = NULL;
-    int rc = sqlite3_prepare_v2(db, sql, -1, &st, NULL);
+    int rc = db_statement_prepare(db, STMT_ROUND_GET_ALL, &st);
     if (rc != SQLITE_OK) goto prepare_fail;
 
     int cap = 16;
     int count = 0;
 
-    Round *array = malloc(sizeof(Round) * cap);
+    Round *array = arena_alloc(arena_thread(), sizeof(Round) * cap);
     if (!array) {
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return ROUND_DAO_MALLOC_ERROR;
     }
 
     while ((rc = sqlite3_step(st)) == SQLITE_ROW) {
 
         if (count == cap) {
-            cap *= 2;
-            Round *tmp = realloc(array, sizeof(Round) * cap);
+            Round *tmp = arena_grow(arena_thread(), array, sizeof(Round) * cap, sizeof(Round) * cap * 2);
             if (!tmp) {
-                free(array);
-                sqlite3_finalize(st);
+                db_statement_release(st);
                 return ROUND_DAO_MALLOC_ERROR;
             }
             array = tmp;
+            cap *= 2;
         }
 
         Round r = {0};
@@ -153,15 +168,13 @@ RoundDaoStatus get_all_rounds(sqlite3 *db, Round **out_array, int *out_count) {
             r.end_time = sqlite3_column_int64(st, 4);
 
         const unsigned char *board = sqlite3_column_text(st, 5);
-        if (board) {
-            strncpy(r.board, (const char *)board, sizeof(r.board) - 1);
-            r.board[sizeof(r.board) - 1] = '\0';
-        }
+        if (board_from_string((const char *)board, sqlite3_column_int(st, 6), &r.board) != 0)
+            LOG_WARN("Round %" PRId64 " has an invalid board\n", r.id_round);
 
         array[count++] = r;
     }
 
-    sqlite3_finalize(st);
+    db_statement_release(st);
 
     *out_array = array;
     *out_count = count;
@@ -181,26 +194,25 @@ RoundDaoStatus insert_round(sqlite3 *db, Round *r) {
     if (!db || !r || r->id_game <= 0 || r->start_time <= 0)
         return ROUND_DAO_INVALID_INPUT;
 
-    const char *sql =
-        "INSERT INTO Round (id_game, state, start_time, end_time, board) "
-        "VALUES (?1, ?2, ?3, NULL, ?4) RETURNING id_round";
-
     sqlite3_stmt *st = NULL;
-    if (sqlite3_prepare_v2(db, sql, -1, &st, NULL) != SQLITE_OK)
+    if (db_statement_prepare(db, STMT_ROUND_INSERT, &st) != SQLITE_OK)
         goto prepare_fail;
 
     sqlite3_bind_int64(st, 1, r->id_game);
     sqlite3_bind_text(st, 2,
         round_status_to_string(r->state), -1, SQLITE_TRANSIENT);
     sqlite3_bind_int64(st, 3, r->start_time);
-    sqlite3_bind_text(st, 4, r->board, -1, SQLITE_TRANSIENT);
+
+    char board[BOARD_TEXT_MAX];
+    board_to_string(&r->board, board);
+    sqlite3_bind_text(st, 4, board, -1, SQLITE_TRANSIENT);
 
     if (sqlite3_step(st) != SQLITE_ROW)
         goto step_fail;
 
     r->id_round = sqlite3_column_int64(st, 0);
 
-    sqlite3_finalize(st);
+    db_statement_release(st);
     return ROUND_DAO_OK;
 
 prepare_fail:
@@ -209,7 +221,7 @@ prepare_fail:
 
 step_fail:
     LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-    sqlite3_finalize(st);
+    db_statement_release(st);
     return ROUND_DAO_SQL_ERROR;
 }
 
@@ -231,7 +243,7 @@ RoundDaoStatus update_round_by_id(sqlite3 *db, const Round *upd) {
 
     if (orig.state      != upd->state)      flags |= UPDATE_ROUND_STATE;
     if (orig.end_time   != upd->end_time)   flags |= UPDATE_ROUND_END_TIME;
-    if (strcmp(orig.board, upd->board) != 0)
+    if (memcmp(orig.board.cells, upd->board.cells, sizeof(upd->board.cells)) != 0)
         flags |= UPDATE_ROUND_BOARD;
 
     if (flags == 0)
@@ -275,8 +287,11 @@ RoundDaoStatus update_round_by_id(sqlite3 *db, const Round *upd) {
             sqlite3_bind_int64(stmt, idx++, upd->end_time);
     }
 
-    if (flags & UPDATE_ROUND_BOARD)
-        sqlite3_bind_text(stmt, idx++, upd->board, -1, SQLITE_TRANSIENT);
+    if (flags & UPDATE_ROUND_BOARD) {
+        char board[BOARD_TEXT_MAX];
+        board_to_string(&upd->board, board);
+        sqlite3_bind_text(stmt, idx++, board, -1, SQLITE_TRANSIENT);
+    }
 
     sqlite3_bind_int64(stmt, idx, upd->id_round);
 
@@ -298,6 +313,84 @@ step_fail:
     return ROUND_DAO_SQL_ERROR;
 }
 
+/**
+ * Writes the board of a round, nothing else: the cached statement of a move.
+ * Unlike update_round_by_id() it does not read the row first, the caller already holds the current state.
+ */
+RoundDaoStatus update_round_board(sqlite3 *db, const Round *upd) {
+
+    if (!db || !upd || upd->id_round <= 0)
+        return ROUND_DAO_INVALID_INPUT;
+
+    sqlite3_stmt *st = NULL;
+
+    if (db_statement_prepare(db, STMT_ROUND_UPDATE_BOARD, &st) != SQLITE_OK)
+        goto prepare_fail;
+
+    char board[BOARD_TEXT_MAX];
+    board_to_string(&upd->board, board);
+
+    sqlite3_bind_int64(st, 1, upd->id_round);
+    sqlite3_bind_text(st, 2, board, -1, SQLITE_TRANSIENT);
+
+    if (sqlite3_step(st) != SQLITE_DONE)
+        goto step_fail;
+
+    db_statement_release(st);
+    return sqlite3_changes(db) > 0
+        ? ROUND_DAO_OK
+        : ROUND_DAO_NOT_FOUND;
+
+prepare_fail:
+    LOG_ERROR("DATABASE ERROR (prepare): %s\n", sqlite3_errmsg(db));
+    return ROUND_DAO_SQL_ERROR;
+
+step_fail:
+    LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
+    db_statement_release(st);
+    return ROUND_DAO_SQL_ERROR;
+}
+
+// Writes the state, end time and board of a round, e.g. when it ends
+RoundDaoStatus update_round_state(sqlite3 *db, const Round *upd) {
+
+    if (!db || !upd || upd->id_round <= 0)
+        return ROUND_DAO_INVALID_INPUT;
+
+    sqlite3_stmt *st = NULL;
+
+    if (db_statement_prepare(db, STMT_ROUND_UPDATE_STATE, &st) != SQLITE_OK)
+        goto prepare_fail;
+
+    char board[BOARD_TEXT_MAX];
+    board_to_string(&upd->board, board);
+
+    sqlite3_bind_int64(st, 1, upd->id_round);
+    sqlite3_bind_text(st, 2, round_status_to_string(upd->state), -1, SQLITE_TRANSIENT);
+    if (upd->end_time == 0)
+        sqlite3_bind_null(st, 3);
+    else
+        sqlite3_bind_int64(st, 3, upd->end_time);
+    sqlite3_bind_text(st, 4, board, -1, SQLITE_TRANSIENT);
+
+    if (sqlite3_step(st) != SQLITE_DONE)
+        goto step_fail;
+
+    db_statement_release(st);
+    return sqlite3_changes(db) > 0
+        ? ROUND_DAO_OK
+        : ROUND_DAO_NOT_FOUND;
+
+prepare_fail:
+    LOG_ERROR("DATABASE ERROR (prepare): %s\n", sqlite3_errmsg(db));
+    return ROUND_DAO_SQL_ERROR;
+
+step_fail:
+    LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
+    db_statement_release(st);
+    return ROUND_DAO_SQL_ERROR;
+}
+
 /* =========================================================
  * DELETE ROUND
  * ========================================================= */
@@ -307,10 +400,9 @@ RoundDaoStatus delete_round_by_id(sqlite3 *db, int64_t id_round) {
     if (!db || id_round <= 0)
         return ROUND_DAO_INVALID_INPUT;
 
-    const char *sql = "DELETE FROM Round WHERE id_round = ?1";
     sqlite3_stmt *st = NULL;
 
-    if (sqlite3_prepare_v2(db, sql, -1, &st, NULL) != SQLITE_OK)
+    if (db_statement_prepare(db, STMT_ROUND_DELETE_BY_ID, &st) != SQLITE_OK)
         goto prepare_fail;
 
     sqlite3_bind_int64(st, 1, id_round);
@@ -318,7 +410,7 @@ RoundDaoStatus delete_round_by_id(sqlite3 *db, int64_t id_round) {
     if (sqlite3_step(st) != SQLITE_DONE)
         goto step_fail;
 
-    sqlite3_finalize(st);
+    db_statement_release(st);
     return sqlite3_changes(db) > 0
         ? ROUND_DAO_OK
         : ROUND_DAO_NOT_FOUND;
@@ -329,7 +421,7 @@ prepare_fail:
 
 step_fail:
     LOG_ERROR("DATABASE ERROR (step): %s\n", sqlite3_errmsg(db));
-    sqlite3_finalize(st);
+    db_statement_release(st);
     return ROUND_DAO_SQL_ERROR;
 }
 
@@ -344,26 +436,14 @@ RoundDaoStatus round_find_full_info(sqlite3 *db, int64_t id_round, RoundFullDTO
 
     memset(out, 0, sizeof(*out));
 
-    const char *sql =
-        "SELECT "
-        "r.id_round, r.id_game, r.state, r.start_time, r.end_time, r.board, "
-        "p1.id_player, pl1.player_number, p1.nickname, "
-        "p2.id_player, pl2.player_number, p2.nickname "
-        "FROM Round r "
-        "JOIN Play pl1 ON pl1.id_round = r.id_round AND pl1.player_number = 1 "
-        "JOIN Player p1 ON p1.id_player = pl1.id_player "
-        "JOIN Play pl2 ON pl2.id_round = r.id_round AND pl2.player_number = 2 "
-        "JOIN Player p2 ON p2.id_player = pl2.id_player "
-        "WHERE r.id_round = ?1";
-
     sqlite3_stmt *st = NULL;
-    if (sqlite3_prepare_v2(db, sql, -1, &st, NULL) != SQLITE_OK)
+    if (db_statement_prepare(db, STMT_ROUND_GET_FULL_INFO, &st) != SQLITE_OK)
         return ROUND_DAO_SQL_ERROR;
 
     sqlite3_bind_int64(st, 1, id_round);
 
     if (sqlite3_step(st) != SQLITE_ROW) {
-        sqlite3_finalize(st);
+        db_statement_release(st);
         return ROUND_DAO_NOT_FOUND;
     }
 
@@ -399,6 +479,9 @@ RoundDaoStatus round_find_full_info(sqlite3 *db, int64_t id_round, RoundFullDTO
     strncpy(out->nickname_player2, n2 ? (const char *)n2 : "",
             sizeof(out->nickname_player2) - 1);
 
-    sqlite3_finalize(st);
+    out->board_size = sqlite3_column_int(st, 12);
+    out->win_length = sqlite3_column_int(st, 13);
+
+    db_statement_release(st);
     return ROUND_DAO_OK;
 }
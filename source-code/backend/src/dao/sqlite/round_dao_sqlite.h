@@ -27,10 +27,14 @@ typedef enum {
 RoundDaoStatus get_round_by_id(sqlite3 *db, int64_t id_round, Round *out); 
 RoundDaoStatus get_all_rounds(sqlite3 *db, Round **out_array, int *out_count);
 RoundDaoStatus update_round_by_id(sqlite3 *db, const Round *upd_round);
+RoundDaoStatus update_round_board(sqlite3 *db, const Round *upd_round);
+RoundDaoStatus update_round_state(sqlite3 *db, const Round *upd_round);
 RoundDaoStatus delete_round_by_id(sqlite3 *db, int64_t id_round);
 RoundDaoStatus insert_round(sqlite3 *db, Round *in_out_round);
 
 RoundDaoStatus round_find_full_info(sqlite3 *db, int64_t id_round, RoundFullDTO *out);
+RoundDaoStatus get_active_round_by_game(sqlite3 *db, int64_t id_game, Round *out);
+RoundDaoStatus get_last_round_by_game(sqlite3 *db, int64_t id_game, Round *out);
 
 // Funzione di utilità per messaggi di errore
 const char *return_round_dao_status_to_string(RoundDaoStatus status);
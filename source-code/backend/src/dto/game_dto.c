@@ -7,6 +7,8 @@ void map_game_to_dto(const Game *game, const char *creator_nick, const char *own
     if (!game || !out_dto) return;
 
     out_dto->id_game = game->id_game;
+    out_dto->board_size = game->board_size;
+    out_dto->win_length = game->win_length;
 
     // creator_nickname
     strncpy(out_dto->creator_nickname, creator_nick ? creator_nick : "", sizeof(out_dto->creator_nickname));
@@ -36,6 +38,8 @@ void map_game_with_streak_to_dto(const Game *game, const char *creator_nick, con
     if (!game || !out_dto) return;
 
     out_dto->id_game = game->id_game;
+    out_dto->board_size = game->board_size;
+    out_dto->win_length = game->win_length;
 
     // creator_nickname
     strncpy(out_dto->creator_nickname,
@@ -15,6 +15,8 @@ typedef struct GameDTO {
     int owner_max_streak;
     char state_str[16];
     char created_at_str[DATE_STR_MAX];
+    int board_size;
+    int win_length;
 } GameDTO;
 
 void map_game_to_dto(
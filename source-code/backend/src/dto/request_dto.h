@@ -0,0 +1,63 @@
+#ifndef REQUEST_DTO_H
+#define REQUEST_DTO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../entities/participation_request_entity.h"
+
+// A `req_id` is a JSON integer from 0 to the largest one a JavaScript client can represent exactly.
+// Anything else (a string, a fraction, a negative or larger number) means the request has none
+#define REQUEST_ID_MAX INT64_C(9007199254740991)
+
+/**
+ * Typed view of an incoming request, filled by a single pass over the JSON body.
+ * Missing integer keys are `-1`, missing string keys are `NULL`.
+ * Strings point inside the parsed JSON and live until free_request_dto() is called.
+ */
+typedef struct RequestDTO {
+    const char *action;
+    int64_t req_id;     // Chosen by the client and echoed in the response, so requests can be pipelined
+
+    // Shared identifiers
+    int64_t id_player;
+    int64_t id_game;
+    int64_t id_round;
+    int64_t id_participation_request;
+
+    // Player controller input
+    const char *nickname;
+    const char *email;
+    const char *password;
+
+    // Game controller input
+    const char *status;
+    int64_t id_creator;
+    int64_t id_owner;
+    int64_t id_player_accepting_rematch;
+    int board_size;
+    int win_length;
+
+    // Round controller input
+    int row;
+    int col;
+    int64_t id_player_ending_round;
+
+    // Participation Request controller input
+    const char *state;
+    const char *new_state;
+    ParticipationRequest *requests;         // Taken from the arena of the worker decoding the request
+    size_t requests_count;
+
+    // Notification controller input
+    int64_t id_sender;
+    int64_t id_receiver;
+
+    // Batch input
+    struct RequestDTO *operations;          // Taken from the arena, their strings live in `parsed_json` of the batch
+    size_t operations_count;
+
+    void *parsed_json;  // Owner of the strings above
+} RequestDTO;
+
+#endif
@@ -15,6 +15,7 @@ void map_round_to_dto(const Round *round, RoundDTO *out_dto) {
     out_dto->state_str[sizeof(out_dto->state_str) - 1] = '\0';
 
     // board
-    strncpy(out_dto->board, round->board, BOARD_MAX);
-    out_dto->board[BOARD_MAX - 1] = '\0';
+    out_dto->board_size = round->board.size;
+    out_dto->win_length = round->board.win_length;
+    board_to_string(&round->board, out_dto->board);
 }
\ No newline at end of file
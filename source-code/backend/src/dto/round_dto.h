@@ -14,7 +14,9 @@ typedef struct RoundDTO {
     int64_t start_time;
     int64_t end_time;
     char state_str[ROUND_STATE_STR_MAX];
-    char board[BOARD_MAX];
+    int board_size;
+    int win_length;
+    char board[BOARD_TEXT_MAX];
 } RoundDTO;
 
 void map_round_to_dto(const Round *round, RoundDTO *out_dto);
@@ -20,6 +20,8 @@ typedef struct Game {
     int64_t id_owner;
     GameStatus state;
     time_t created_at;
+    int board_size;         // Cells per side of the board of every round
+    int win_length;         // Symbols in a row needed to win a round
 } Game;
 
 void print_game(const Game *g);
@@ -22,7 +22,9 @@ void print_round(const Round *r) {
     printf("  state: \"%s\"\n", round_status_to_string(r->state));
     printf("  start_time: %" PRId64 "\n", r->start_time);
     printf("  end_time: %" PRId64 "\n", r->end_time);
-    printf("  board: \"%s\"\n", r->board);
+    char board[BOARD_TEXT_MAX];
+    board_to_string(&r->board, board);
+    printf("  board: \"%s\"\n", board);
 
     // Print duration only if the round has ended
     if (r->end_time > 0 && r->start_time > 0) {
@@ -47,6 +49,9 @@ void print_round_inline(const Round *r) {
         duration = r->end_time - r->start_time;
     }
 
+    char board[BOARD_TEXT_MAX];
+    board_to_string(&r->board, board);
+
     printf(
         "Round[id=%" PRId64
         ", game=%" PRId64
@@ -61,7 +66,7 @@ void print_round_inline(const Round *r) {
         r->start_time,
         r->end_time,
         duration,
-        r->board
+        board
     );
 }
 
@@ -114,40 +119,166 @@ int player_symbol_to_number(const char player_symbol) {
 }
 
 /*
- * Sets a symbol on the board at the given row and column.
+ * Checks the rules of a game: a square board of supported size, won by at least 3 symbols in a row.
  */
-void set_round_board_cell(char board[BOARD_MAX], int row, int col, char symbol) {
-    if (row < 0 || row >= BOARD_ROWS) {
-        LOG_WARN("Provided row not valid!\n");
-        return;
-    }
+bool board_rules_valid(int size, int win_length) {
+    return size >= BOARD_MIN_SIZE && size <= BOARD_MAX_SIZE
+        && win_length >= BOARD_MIN_SIZE && win_length <= size;
+}
 
-    if (col < 0 || col >= BOARD_COLS) {
-        LOG_WARN("Provided column not valid!\n");
-        return;
+/*
+ * Initializes an empty board.
+ * Returns 0 on success, -1 if the rules are not valid.
+ */
+int board_init(Board *board, int size, int win_length) {
+    memset(board, 0, sizeof(*board));
+
+    if (!board_rules_valid(size, win_length))
+        return -1;
+
+    board->size = (uint8_t)size;
+    board->win_length = (uint8_t)win_length;
+    return 0;
+}
+
+static bool holds_cell(const uint64_t cells[BOARD_WORDS], int cell) {
+    return cells[cell / 64] >> (cell % 64) & 1u;
+}
+
+/*
+ * Counts the cells held by the same player starting next to (row, col) and moving by (d_row, d_col).
+ * It stops after win_length - 1 cells, which are enough to complete a line.
+ */
+static int count_direction(const Board *board, const uint64_t cells[BOARD_WORDS], int row, int col, int d_row, int d_col) {
+    int count = 0;
+    int size = board->size;
+
+    for (int r = row + d_row, c = col + d_col;
+         count < board->win_length - 1 && r >= 0 && r < size && c >= 0 && c < size && holds_cell(cells, r * size + c);
+         r += d_row, c += d_col)
+        count++;
+
+    return count;
+}
+
+/*
+ * Checks whether the symbol just placed on (row, col) completes a line.
+ * Only the row, the column and the two diagonals through that cell are visited: O(win_length) per move.
+ */
+static bool completes_line(const Board *board, const uint64_t cells[BOARD_WORDS], int row, int col) {
+    static const int directions[4][2] = { {0, 1}, {1, 0}, {1, 1}, {1, -1} };
+
+    for (int i = 0; i < 4; i++) {
+        int d_row = directions[i][0];
+        int d_col = directions[i][1];
+
+        int line = 1 + count_direction(board, cells, row, col, d_row, d_col)
+                     + count_direction(board, cells, row, col, -d_row, -d_col);
+
+        if (line >= board->win_length)
+            return true;
     }
 
-    board[BOARD_ROWS * row + col] = symbol;
+    return false;
+}
+
+/*
+ * Places the symbol of `player_number` (1 or 2) on an empty cell and records a completed line.
+ * Returns 0 on success, -1 if the cell is outside the board or already taken.
+ */
+int board_play(Board *board, int row, int col, int player_number) {
+    if (row < 0 || row >= board->size || col < 0 || col >= board->size)
+        return -1;
+
+    if (player_number != 1 && player_number != 2)
+        return -1;
+
+    int cell = row * board->size + col;
+
+    if (holds_cell(board->cells[0], cell) || holds_cell(board->cells[1], cell))
+        return -1;
+
+    uint64_t *cells = board->cells[player_number - 1];
+    cells[cell / 64] |= (uint64_t)1 << (cell % 64);
+    board->moves[player_number - 1]++;
+
+    if (board->winner == 0 && completes_line(board, cells, row, col))
+        board->winner = player_number;
+
+    return 0;
 }
 
 /*
  * Returns the symbol at the given board position.
  */
-char get_round_board_cell(char board[BOARD_MAX], int row, int col) {
-    if (row < 0 || row >= BOARD_ROWS || col < 0 || col >= BOARD_COLS) {
+char get_round_board_cell(const Board *board, int row, int col) {
+    if (row < 0 || row >= board->size || col < 0 || col >= board->size) {
         LOG_WARN("Invalid board coordinates!\n");
         return NO_SYMBOL;
     }
 
-    return board[BOARD_ROWS * row + col];
+    int cell = row * board->size + col;
+
+    if (holds_cell(board->cells[0], cell)) return P1_SYMBOL;
+    if (holds_cell(board->cells[1], cell)) return P2_SYMBOL;
+
+    return EMPTY_SYMBOL;
 }
 
 /*
- * Initializes the board with empty symbols.
+ * Player 1 moves first, so it's their turn whenever both players made the same number of moves.
  */
-void fill_empty_board(char board[BOARD_MAX]) {
-    for (size_t i = 0; i < BOARD_MAX - 1; i++) {
-        board[i] = EMPTY_SYMBOL;
+int board_current_turn(const Board *board) {
+    return board->moves[0] <= board->moves[1] ? 1 : 2;
+}
+
+bool board_is_full(const Board *board) {
+    return board->moves[0] + board->moves[1] == board->size * board->size;
+}
+
+/*
+ * Converts the board to its text form (one symbol per cell, row by row), as stored in the database.
+ */
+void board_to_string(const Board *board, char out[BOARD_TEXT_MAX]) {
+    int cells = board->size * board->size;
+
+    for (int cell = 0; cell < cells; cell++) {
+        if (holds_cell(board->cells[0], cell))
+            out[cell] = P1_SYMBOL;
+        else if (holds_cell(board->cells[1], cell))
+            out[cell] = P2_SYMBOL;
+        else
+            out[cell] = EMPTY_SYMBOL;
     }
-    board[BOARD_MAX - 1] = '\0';
+    out[cells] = '\0';
+}
+
+/*
+ * Parses the text form of a board, whose length gives its size.
+ * Returns 0 on success, -1 if the text is not a valid board (`out` is left empty).
+ */
+int board_from_string(const char *text, int win_length, Board *out) {
+    memset(out, 0, sizeof(*out));
+
+    size_t len = text ? strlen(text) : 0;
+
+    int size = BOARD_MIN_SIZE;
+    while (size < BOARD_MAX_SIZE && (size_t)(size * size) < len)
+        size++;
+
+    Board board;
+    if ((size_t)(size * size) != len || board_init(&board, size, win_length) != 0)
+        return -1;
+
+    for (int cell = 0; cell < size * size; cell++) {
+        int player_number = player_symbol_to_number(text[cell]);
+
+        if (player_number > 0)
+            board_play(&board, cell / size, cell % size, player_number);
+        else if (text[cell] != EMPTY_SYMBOL)
+            return -1;
+    }
+
+    *out = board;
+    return 0;
 }
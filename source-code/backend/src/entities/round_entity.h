@@ -1,11 +1,18 @@
 #ifndef ROUND_ENTITY_H
 #define ROUND_ENTITY_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
-#define BOARD_ROWS 3
-#define BOARD_COLS 3 
-#define BOARD_MAX (BOARD_ROWS*BOARD_COLS)+1 // One more character for trailing '\0' char
+// Rules of a game: boards from 3x3 up to 15x15, won by `win_length` symbols in a row (e.g. 15x15 five in a row)
+#define BOARD_MIN_SIZE 3
+#define BOARD_MAX_SIZE 15
+#define DEFAULT_BOARD_SIZE 3
+#define DEFAULT_WIN_LENGTH 3
+
+#define BOARD_MAX_CELLS (BOARD_MAX_SIZE*BOARD_MAX_SIZE)
+#define BOARD_WORDS ((BOARD_MAX_CELLS + 63) / 64)
+#define BOARD_TEXT_MAX (BOARD_MAX_CELLS+1) // Text form: one character per cell plus the trailing '\0' char
 
 #define NO_SYMBOL '/'
 #define P1_SYMBOL 'X'
@@ -19,13 +26,26 @@ typedef enum {
     ROUND_STATUS_INVALID
 } RoundStatus;
 
+/**
+ * Packed board of `size`x`size` cells: bit `row*size + col` of `cells[0]` (`cells[1]`) is set when player 1 (2) holds that cell.
+ * Placing a symbol only checks the lines through that cell, and the winner is kept with the board.
+ * The text form ("X@O@@@@@@") is only used at the boundaries, i.e. the database and the JSON messages.
+ */
+typedef struct {
+    uint64_t cells[2][BOARD_WORDS];
+    uint8_t size;               // Cells per side
+    uint8_t win_length;         // Symbols in a row needed to win
+    uint16_t moves[2];          // Cells held by player 1 and 2
+    int winner;                 // Player number that completed a line, `0` if none
+} Board;
+
 typedef struct {
     int64_t id_round;
     int64_t id_game;
     RoundStatus state;
     int64_t start_time; // Unix timestamp (seconds, server-side)
     int64_t end_time;
-    char board[BOARD_MAX];
+    Board board;
 } Round;
 
 // ------------------- Debug / Utils -------------------
@@ -41,9 +61,14 @@ RoundStatus string_to_round_status(const char *state_str);
 char player_number_to_symbol(int player_number);
 int player_symbol_to_number(const char player_symbol);
 
-void set_round_board_cell(char board[BOARD_MAX], int row, int col, char symbol);
-char get_round_board_cell(char board[BOARD_MAX], int row, int col);
+bool board_rules_valid(int size, int win_length);
+int board_init(Board *board, int size, int win_length);
+int board_play(Board *board, int row, int col, int player_number);
+char get_round_board_cell(const Board *board, int row, int col);
+int board_current_turn(const Board *board);
+bool board_is_full(const Board *board);
 
-void fill_empty_board(char board[BOARD_MAX]);
+void board_to_string(const Board *board, char out[BOARD_TEXT_MAX]);
+int board_from_string(const char *text, int win_length, Board *out);
 
 #endif
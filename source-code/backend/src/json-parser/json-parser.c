@@ -10,630 +10,661 @@
 */
 
 #include <json-c/json.h> // Header to access all the functions that json-c offers
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "json-parser.h"
+#include "json-writer.h"
+#include "../server/arena.h"
+
+/* === Decode functions === */
+
+typedef enum {
+    REQUEST_FIELD_STRING,
+    REQUEST_FIELD_INT64,
+    REQUEST_FIELD_INT
+} RequestFieldType;
+
+typedef struct {
+    const char *key;
+    RequestFieldType type;
+    size_t offset;      // Position of the field inside RequestDTO
+} RequestField;
+
+// Known request keys, sorted by key so that each one is found with a binary search
+static const RequestField request_fields[] = {
+    { "action",                       REQUEST_FIELD_STRING, offsetof(RequestDTO, action) },
+    { "board_size",                   REQUEST_FIELD_INT,    offsetof(RequestDTO, board_size) },
+    { "col",                          REQUEST_FIELD_INT,    offsetof(RequestDTO, col) },
+    { "email",                        REQUEST_FIELD_STRING, offsetof(RequestDTO, email) },
+    { "id_creator",                   REQUEST_FIELD_INT64,  offsetof(RequestDTO, id_creator) },
+    { "id_game",                      REQUEST_FIELD_INT64,  offsetof(RequestDTO, id_game) },
+    { "id_owner",                     REQUEST_FIELD_INT64,  offsetof(RequestDTO, id_owner) },
+    { "id_participation_request",     REQUEST_FIELD_INT64,  offsetof(RequestDTO, id_participation_request) },
+    { "id_player",                    REQUEST_FIELD_INT64,  offsetof(RequestDTO, id_player) },
+    { "id_player_accepting_rematch",  REQUEST_FIELD_INT64,  offsetof(RequestDTO, id_player_accepting_rematch) },
+    { "id_player_ending_round",       REQUEST_FIELD_INT64,  offsetof(RequestDTO, id_player_ending_round) },
+    { "id_receiver",                  REQUEST_FIELD_INT64,  offsetof(RequestDTO, id_receiver) },
+    { "id_round",                     REQUEST_FIELD_INT64,  offsetof(RequestDTO, id_round) },
+    { "id_sender",                    REQUEST_FIELD_INT64,  offsetof(RequestDTO, id_sender) },
+    { "new_state",                    REQUEST_FIELD_STRING, offsetof(RequestDTO, new_state) },
+    { "nickname",                     REQUEST_FIELD_STRING, offsetof(RequestDTO, nickname) },
+    { "password",                     REQUEST_FIELD_STRING, offsetof(RequestDTO, password) },
+    { "row",                          REQUEST_FIELD_INT,    offsetof(RequestDTO, row) },
+    { "state",                        REQUEST_FIELD_STRING, offsetof(RequestDTO, state) },
+    { "status",                       REQUEST_FIELD_STRING, offsetof(RequestDTO, status) },
+    { "win_length",                   REQUEST_FIELD_INT,    offsetof(RequestDTO, win_length) },
+};
+
+static void decode_request_object(struct json_object *object, RequestDTO *out_request, bool with_operations);
+
+static int compare_request_field(const void *key, const void *field) {
+    return strcmp((const char *)key, ((const RequestField *)field)->key);
+}
 
-/* === Extract functions === */
+// Converts the `requests` array of participation_request_reject_all into entities
+static ParticipationRequest *decode_requests_array(struct json_object *requests_array, size_t *out_count) {
 
-// @param json_str is the variable which contains the entire JSON
-// @param key is the json key which we will use to extract the correct value from the JSON
-// @return The value extracted from the json key. It returns `NULL` if no key is found.
-char *extract_string_from_json(const char *json_str, const char *key) {
+    *out_count = 0;
 
-    // - parsed_join will contain the entire JSON object after the parsing
-    // - value will contain the value associated with the key
-    struct json_object *parsed_json, *value;                          
+    if (!json_object_is_type(requests_array, json_type_array))
+        return NULL;
 
-    // Convert a string in a json_object*
-    parsed_json = json_tokener_parse(json_str);
+    size_t len = json_object_array_length(requests_array);
+    if (len == 0)
+        return NULL;
 
-    if(!parsed_json) return NULL;
+    ParticipationRequest *buffer = arena_alloc(arena_thread(), sizeof(ParticipationRequest) * len);
+    if (!buffer)
+        return NULL;
 
-    // json_object_get_ex searches in parsed_json using key and put the value in the value variable if it finds him
-    // It returns false if it cannot be found, true otherwise
-    if(!json_object_object_get_ex(parsed_json, key, &value)) {
+    for (size_t i = 0; i < len; i++) {
+        struct json_object *item = json_object_array_get_idx(requests_array, i);
 
-        // This function is used to free up the memory allocated from json_tokener_parse() function
-        json_object_put(parsed_json);
-        return NULL;
+        buffer[i].id_request = json_object_get_int64(json_object_object_get(item, "id_request"));
+        buffer[i].id_player  = json_object_get_int64(json_object_object_get(item, "id_player"));
+        buffer[i].id_game    = json_object_get_int64(json_object_object_get(item, "id_game"));
+        buffer[i].created_at = 0;
+
+        const char *state = json_object_get_string(json_object_object_get(item, "state"));
+        buffer[i].state = string_to_request_participation_status(state);
     }
 
-    // Convert the json_object into desired type
-    const char *temp = json_object_get_string(value);
-    if (!temp) {
-        json_object_put(parsed_json);
+    *out_count = len;
+    return buffer;
+}
+
+// Every field of a request is optional: this is what the handlers see for the keys that are missing
+static const RequestDTO request_defaults = {
+    .req_id = -1,
+    .id_player = -1,
+    .id_game = -1,
+    .id_round = -1,
+    .id_participation_request = -1,
+    .id_creator = -1,
+    .id_owner = -1,
+    .id_player_accepting_rematch = -1,
+    .board_size = -1,
+    .win_length = -1,
+    .row = -1,
+    .col = -1,
+    .id_player_ending_round = -1,
+    .id_sender = -1,
+    .id_receiver = -1
+};
+
+/**
+ * Converts the `operations` array of a batch into requests taken from the arena.
+ * Their strings point inside the JSON of the batch, so they have no `parsed_json` of their own,
+ * and their own `operations` keys are ignored: a batch cannot nest another one.
+ */
+static RequestDTO *decode_operations_array(struct json_object *operations_array, size_t *out_count) {
+
+    *out_count = 0;
+
+    if (!json_object_is_type(operations_array, json_type_array))
         return NULL;
-    }
 
-    // With +1 we add the space for the string terminator \0
-    char *result = malloc(strlen(temp) + 1);
-    if (!result) {
-        json_object_put(parsed_json);
+    size_t len = json_object_array_length(operations_array);
+    if (len == 0)
         return NULL;
-    }
 
-    strcpy(result, temp);
-    json_object_put(parsed_json);
+    RequestDTO *buffer = arena_alloc(arena_thread(), sizeof(RequestDTO) * len);
+    if (!buffer)
+        return NULL;
 
-    return result;
-}
+    for (size_t i = 0; i < len; i++) {
+        buffer[i] = request_defaults;
 
-// @param json_str is the variable which contains the entire JSON
-// @param key is the json key which we will use to extract the correct value from the JSON
-// @return The value extracted from the json key. It returns `-1` if no key is found.
-int extract_int_from_json(const char *json_str, const char *key) {
-    
-    struct json_object *parsed_json, *value;
+        struct json_object *item = json_object_array_get_idx(operations_array, i);
+        if (json_object_is_type(item, json_type_object))
+            decode_request_object(item, &buffer[i], false);
+    }
 
-    // Parsing the JSON string content into JSON object
-    parsed_json = json_tokener_parse(json_str);
+    *out_count = len;
+    return buffer;
+}
 
-    if(!parsed_json) return -1;
+// Stores every known key of `object` in the matching field of `out_request`
+static void decode_request_object(struct json_object *object, RequestDTO *out_request, bool with_operations) {
 
-    // Get the value of a key in the JSON object
-    if(!json_object_object_get_ex(parsed_json, key, &value)) {
+    struct json_object_iter iter;
+    json_object_object_foreachC(object, iter) {
 
-        // This function is used to free up the memory allocated from json_tokener_parse() function
-        json_object_put(parsed_json);
-        return -1;
-    }
+        if (strcmp(iter.key, "requests") == 0) {
+            out_request->requests = decode_requests_array(iter.val, &out_request->requests_count);
+            continue;
+        }
 
-    // Convert the json_object into desired type
-    int result = json_object_get_int(value);
+        // Only a real integer is an id: json-c would turn "5" into 5 and "abc" into 0,
+        // while the reactor, which schedules the frame by its id, sees no id in either
+        if (strcmp(iter.key, "req_id") == 0) {
+            if (json_object_is_type(iter.val, json_type_int)) {
+                int64_t req_id = json_object_get_int64(iter.val);
+                out_request->req_id = req_id >= 0 && req_id <= REQUEST_ID_MAX ? req_id : -1;
+            } else {
+                out_request->req_id = -1;
+            }
+            continue;
+        }
 
-    json_object_put(parsed_json);
+        if (strcmp(iter.key, "operations") == 0) {
+            if (with_operations)
+                out_request->operations = decode_operations_array(iter.val, &out_request->operations_count);
+            continue;
+        }
 
-    return result;
+        const RequestField *field = bsearch(iter.key, request_fields,
+            sizeof(request_fields) / sizeof(request_fields[0]), sizeof(RequestField), compare_request_field);
+
+        // Unknown keys and null values are ignored
+        if (!field || !iter.val)
+            continue;
+
+        char *slot = (char *)out_request + field->offset;
+
+        switch (field->type) {
+            case REQUEST_FIELD_STRING:
+                *(const char **)slot = json_object_get_string(iter.val);
+                break;
+            case REQUEST_FIELD_INT64:
+                *(int64_t *)slot = json_object_get_int64(iter.val);
+                break;
+            case REQUEST_FIELD_INT:
+                *(int *)slot = json_object_get_int(iter.val);
+                break;
+        }
+    }
 }
 
-ParticipationRequest* extract_requests_array_from_json(const char *json_str, size_t *out_count) {
+/**
+ * Decodes the whole request with a single parse of the JSON body.
+ * Every key of the JSON object is visited once and stored in the matching RequestDTO field.
+ * @param json_str is the variable which contains the entire JSON
+ * @param out_request is filled with the decoded values, it must be released with free_request_dto()
+ * @return `0` on success, `-1` if the body is not a JSON object (every field is left to its default).
+ */
+int decode_request_from_json(const char *json_str, RequestDTO *out_request) {
 
-     if (!out_count) return NULL;
+    *out_request = request_defaults;
 
+    // Convert a string in a json_object*, this is the only parse of the body
     struct json_object *parsed_json = json_tokener_parse(json_str);
-    if (!parsed_json) return NULL;
-
-    struct json_object *requests_array;
+    if (!parsed_json)
+        return -1;
 
-    if (!json_object_object_get_ex(parsed_json, "requests", &requests_array)) {
+    if (!json_object_is_type(parsed_json, json_type_object)) {
         json_object_put(parsed_json);
-        *out_count = 0;
-        return NULL;
+        return -1;
     }
 
-    if (!json_object_is_type(requests_array, json_type_array)) {
-        json_object_put(parsed_json);
-        *out_count = 0;
-        return NULL;
-    }
+    out_request->parsed_json = parsed_json;
+    decode_request_object(parsed_json, out_request, true);
 
-    int len = json_object_array_length(requests_array);
-    *out_count = len;
+    return 0;
+}
 
-    ParticipationRequest *buffer =
-        malloc(sizeof(ParticipationRequest) * len);
+// Releases the parsed JSON (and the strings pointing inside it) of a decoded request
+void free_request_dto(RequestDTO *request) {
 
-    for (int i = 0; i < len; i++) {
-        struct json_object *item = json_object_array_get_idx(requests_array, i);
+    if (!request)
+        return;
 
-        buffer[i].id_request = json_object_get_int64(json_object_object_get(item, "id_request"));
-        buffer[i].id_player  = json_object_get_int64(json_object_object_get(item, "id_player"));
-        buffer[i].id_game    = json_object_get_int64(json_object_object_get(item, "id_game"));
+    if (request->parsed_json)
+        json_object_put(request->parsed_json);
 
-        const char *state = json_object_get_string(json_object_object_get(item, "state"));
-        buffer[i].state = string_to_request_participation_status(state);
+    request->parsed_json = NULL;
+    request->requests = NULL;
+    request->requests_count = 0;
+    request->operations = NULL;
+    request->operations_count = 0;
+}
+
+/* === Serialize functions === */
+
+/**
+ * Every serializer streams its document with a JsonWriter straight into a framed Message,
+ * ready for send_framed_message(). The caller owns the returned reference (`NULL` on failure).
+ */
+
+// Opens the response object with the fields shared by every response
+static void write_response_head(JsonWriter *writer, const char *status, const char *action) {
+    json_writer_object_begin(writer);
+    json_writer_field_string(writer, "status", status);
+    if (action) {
+        json_writer_field_string(writer, "action", action);
     }
+}
 
-    json_object_put(parsed_json);
-    return buffer;
+static Message *write_response_end(JsonWriter *writer) {
+    json_writer_object_end(writer);
+    return json_writer_finish(writer);
 }
 
-/* === Serialize functions === */
+// Fields of a game, `with_streak` adds the owner streaks when they are known
+static void write_game(JsonWriter *writer, const GameDTO *game, bool with_streak) {
+    json_writer_object_begin(writer);
+    json_writer_field_int64(writer, "id_game", game->id_game);
+    json_writer_field_string(writer, "creator_nickname", game->creator_nickname);
+    json_writer_field_string(writer, "owner_nickname", game->owner_nickname);
+    json_writer_field_string(writer, "state", game->state_str);
+    json_writer_field_string(writer, "created_at", game->created_at_str);
+    json_writer_field_int64(writer, "board_size", game->board_size);
+    json_writer_field_int64(writer, "win_length", game->win_length);
 
-// Serialize: Action Success
-char *serialize_action_success(const char *action, const char *message, int64_t id) {
-    struct json_object *json_response = json_object_new_object();
+    if (with_streak && game->owner_current_streak >= 0) {
+        json_writer_field_int64(writer, "owner_current_streak", game->owner_current_streak);
+    }
+    if (with_streak && game->owner_max_streak >= 0) {
+        json_writer_field_int64(writer, "owner_max_streak", game->owner_max_streak);
+    }
+    json_writer_object_end(writer);
+}
 
-    json_object_object_add(json_response, "status", json_object_new_string("success"));
+// Serialize: Action Success
+Message *serialize_action_success(const char *action, const char *message, int64_t id) {
+    JsonWriter writer;
+    json_writer_init(&writer);
 
+    json_writer_object_begin(&writer);
+    json_writer_field_string(&writer, "status", "success");
     if (id != -1) {
-        json_object_object_add(json_response, "id", json_object_new_int64(id));
+        json_writer_field_int64(&writer, "id", id);
     }
     if (action) {
-        json_object_object_add(json_response, "action", json_object_new_string(action));
+        json_writer_field_string(&writer, "action", action);
     }
     if (message) {
-        json_object_object_add(json_response, "message", json_object_new_string(message));
+        json_writer_field_string(&writer, "message", message);
     }
 
-    const char *json_str = json_object_to_json_string(json_response);
-    char *result = malloc(strlen(json_str) + 1);
-    if (result) strcpy(result, json_str);
-
-    json_object_put(json_response);
-    return result;
+    return write_response_end(&writer);
 }
 
 // Serialize: Action Success (with waiting flag)
-char *serialize_action_success_with_waiting(const char *action, const char *message, int64_t id, int waiting) {
-    struct json_object *json_response = json_object_new_object();
-
-    json_object_object_add(json_response, "status", json_object_new_string("success"));
+Message *serialize_action_success_with_waiting(const char *action, const char *message, int64_t id, int waiting) {
+    JsonWriter writer;
+    json_writer_init(&writer);
 
+    json_writer_object_begin(&writer);
+    json_writer_field_string(&writer, "status", "success");
     if (id != -1) {
-        json_object_object_add(json_response, "id", json_object_new_int64(id));
+        json_writer_field_int64(&writer, "id", id);
     }
     if (action) {
-        json_object_object_add(json_response, "action", json_object_new_string(action));
+        json_writer_field_string(&writer, "action", action);
     }
     if (message) {
-        json_object_object_add(json_response, "message", json_object_new_string(message));
+        json_writer_field_string(&writer, "message", message);
     }
 
     // waiting: 1 if the caller must wait for the opponent, 0 otherwise
-    json_object_object_add(json_response, "waiting", json_object_new_int(waiting));
+    json_writer_field_int64(&writer, "waiting", waiting);
 
-    const char *json_str = json_object_to_json_string(json_response);
-    char *result = malloc(strlen(json_str) + 1);
-    if (result) strcpy(result, json_str);
-
-    json_object_put(json_response);
-    return result;
+    return write_response_end(&writer);
 }
 
 // Serialize: Action Error
-char *serialize_action_error(const char *action, const char *error_message) {
-    struct json_object *json_response = json_object_new_object();
+Message *serialize_action_error(const char *action, const char *error_message) {
+    JsonWriter writer;
+    json_writer_init(&writer);
 
-    json_object_object_add(json_response, "status", json_object_new_string("error"));
-    if (action) {
-        json_object_object_add(json_response, "action", json_object_new_string(action));
-    }
+    write_response_head(&writer, "error", action);
     if (error_message) {
-        json_object_object_add(json_response, "error_message", json_object_new_string(error_message));
+        json_writer_field_string(&writer, "error_message", error_message);
     }
 
-    const char *json_str = json_object_to_json_string(json_response);
-    char *result = malloc(strlen(json_str) + 1);
-    if (result) strcpy(result, json_str);
-
-    json_object_put(json_response);
-    return result;
+    return write_response_end(&writer);
 }
 
 // Serialize: PlayerDTO
-char *serialize_players_to_json(const char *action, const PlayerDTO* players, size_t count) {
-    struct json_object *json_response = json_object_new_object();
-    struct json_object *json_array = json_object_new_array();
-
-    for (size_t i = 0; i < count; i++) {
-        struct json_object *json_player = json_object_new_object();
+Message *serialize_players_to_json(const char *action, const PlayerDTO* players, size_t count) {
+    JsonWriter writer;
+    json_writer_init(&writer);
 
-        json_object_object_add(json_player, "id_player", json_object_new_int64(players[i].id_player));
-        json_object_object_add(json_player, "nickname", json_object_new_string(players[i].nickname));
-        json_object_object_add(json_player, "current_streak", json_object_new_int(players[i].current_streak));
-        json_object_object_add(json_player, "max_streak", json_object_new_int(players[i].max_streak));
-        json_object_object_add(json_player, "registration_date", json_object_new_string(players[i].registration_date_str));
-
-        json_object_array_add(json_array, json_player);
-    }
+    write_response_head(&writer, "success", action);
+    json_writer_field_int64(&writer, "count", (int64_t)count);
 
-    json_object_object_add(json_response, "status", json_object_new_string("success"));
-    if (action) {
-        json_object_object_add(json_response, "action", json_object_new_string(action));
+    json_writer_key(&writer, "players");
+    json_writer_array_begin(&writer);
+    for (size_t i = 0; i < count; i++) {
+        json_writer_object_begin(&writer);
+        json_writer_field_int64(&writer, "id_player", players[i].id_player);
+        json_writer_field_string(&writer, "nickname", players[i].nickname);
+        json_writer_field_int64(&writer, "current_streak", players[i].current_streak);
+        json_writer_field_int64(&writer, "max_streak", players[i].max_streak);
+        json_writer_field_string(&writer, "registration_date", players[i].registration_date_str);
+        json_writer_object_end(&writer);
     }
-    json_object_object_add(json_response, "count", json_object_new_int64(count));
-    json_object_object_add(json_response, "players", json_array);
-
-    const char *json_str = json_object_to_json_string(json_response);
-    char *result = malloc(strlen(json_str) + 1);
-    if (result) strcpy(result, json_str);
+    json_writer_array_end(&writer);
 
-    json_object_put(json_response);
-    return result;
+    return write_response_end(&writer);
 }
 
 // Serialize: GameDTO
-char *serialize_games_to_json(const char *action, const GameDTO* games, size_t count) {
-    struct json_object *json_response = json_object_new_object();
-    struct json_object *json_array = json_object_new_array();
+Message *serialize_games_to_json(const char *action, const GameDTO* games, size_t count) {
+    JsonWriter writer;
+    json_writer_init(&writer);
 
-    for (size_t i = 0; i < count; i++) {
-        struct json_object *json_game = json_object_new_object();
-
-        json_object_object_add(json_game, "id_game", json_object_new_int64(games[i].id_game));
-        json_object_object_add(json_game, "creator_nickname", json_object_new_string(games[i].creator_nickname));
-        json_object_object_add(json_game, "owner_nickname", json_object_new_string(games[i].owner_nickname));
-        json_object_object_add(json_game, "state", json_object_new_string(games[i].state_str));
-        json_object_object_add(json_game, "created_at", json_object_new_string(games[i].created_at_str));
+    write_response_head(&writer, "success", action);
+    json_writer_field_int64(&writer, "count", (int64_t)count);
 
-        json_object_array_add(json_array, json_game);
-    }
-
-    json_object_object_add(json_response, "status", json_object_new_string("success"));
-    if (action) {
-        json_object_object_add(json_response, "action", json_object_new_string(action));
+    json_writer_key(&writer, "games");
+    json_writer_array_begin(&writer);
+    for (size_t i = 0; i < count; i++) {
+        write_game(&writer, &games[i], false);
     }
-    json_object_object_add(json_response, "count", json_object_new_int64(count));
-    json_object_object_add(json_response, "games", json_array);
+    json_writer_array_end(&writer);
 
-    const char *json_str = json_object_to_json_string(json_response);
-    char *result = malloc(strlen(json_str) + 1);
-    if (result) strcpy(result, json_str);
-
-    json_object_put(json_response);
-    return result;
+    return write_response_end(&writer);
 }
 
 //Serialize: GameDTO with streaks
-char *serialize_games_with_streak_to_json(const char *action, const GameDTO *games, size_t count) {
-    struct json_object *json_response = json_object_new_object();
-    struct json_object *json_array = json_object_new_array();
-
-    for (size_t i = 0; i < count; i++) {
-
-        struct json_object *json_game = json_object_new_object();
-
-        json_object_object_add(json_game, "id_game",
-            json_object_new_int64(games[i].id_game));
-
-        json_object_object_add(json_game, "creator_nickname",
-            json_object_new_string(games[i].creator_nickname ? games[i].creator_nickname : ""));
-
-        json_object_object_add(json_game, "owner_nickname",
-            json_object_new_string(games[i].owner_nickname ? games[i].owner_nickname : ""));
-
-        json_object_object_add(json_game, "state",
-            json_object_new_string(games[i].state_str ? games[i].state_str : ""));
+Message *serialize_games_with_streak_to_json(const char *action, const GameDTO *games, size_t count) {
+    JsonWriter writer;
+    json_writer_init(&writer);
 
-        json_object_object_add(json_game, "created_at",
-            json_object_new_string(games[i].created_at_str ? games[i].created_at_str : ""));
-
-        /* --- streak info --- */
-        if (games[i].owner_current_streak >= 0) {
-            json_object_object_add(json_game,
-                "owner_current_streak",
-                json_object_new_int(games[i].owner_current_streak));
-        }
-
-        if (games[i].owner_max_streak >= 0) {
-            json_object_object_add(json_game,
-                "owner_max_streak",
-                json_object_new_int(games[i].owner_max_streak));
-        }
-
-        json_object_array_add(json_array, json_game);
-    }
+    write_response_head(&writer, "success", action);
+    json_writer_field_int64(&writer, "count", (int64_t)count);
 
-    json_object_object_add(json_response, "status", json_object_new_string("success"));
-
-    if (action) {
-        json_object_object_add(json_response, "action", json_object_new_string(action));
-    }
-
-    json_object_object_add(json_response, "count", json_object_new_int64((int64_t)count));
-    json_object_object_add(json_response, "games", json_array);
-
-    const char *json_str = json_object_to_json_string(json_response);
-
-    char *result = malloc(strlen(json_str) + 1);
-    if (!result) {
-        json_object_put(json_response);
-        return NULL;
+    json_writer_key(&writer, "games");
+    json_writer_array_begin(&writer);
+    for (size_t i = 0; i < count; i++) {
+        write_game(&writer, &games[i], true);
     }
+    json_writer_array_end(&writer);
 
-    strcpy(result, json_str);
-
-    json_object_put(json_response);
-    return result;
+    return write_response_end(&writer);
 }
 
-char *serialize_game_with_streak_to_json(const char *action, const GameDTO *g) {
-    struct json_object *json_response = json_object_new_object();
-    struct json_object *json_game = json_object_new_object();
+Message *serialize_game_with_streak_to_json(const char *action, const GameDTO *g) {
+    JsonWriter writer;
+    json_writer_init(&writer);
 
-    json_object_object_add(json_game, "id_game", json_object_new_int64(g->id_game));
-    json_object_object_add(json_game, "creator_nickname", json_object_new_string(g->creator_nickname));
-    json_object_object_add(json_game, "owner_nickname", json_object_new_string(g->owner_nickname));
-    json_object_object_add(json_game, "state", json_object_new_string(g->state_str));
-    json_object_object_add(json_game, "created_at", json_object_new_string(g->created_at_str));
+    write_response_head(&writer, "success", action);
+    json_writer_key(&writer, "game");
+    write_game(&writer, g, true);
 
-    if (g->owner_current_streak >= 0) {
-        json_object_object_add(json_game, "owner_current_streak", json_object_new_int(g->owner_current_streak));
-    }
-    if (g->owner_max_streak >= 0) {
-        json_object_object_add(json_game, "owner_max_streak", json_object_new_int(g->owner_max_streak));
-    }
-
-    json_object_object_add(json_response, "status", json_object_new_string("success"));
-    if (action) json_object_object_add(json_response, "action", json_object_new_string(action));
-    json_object_object_add(json_response, "game", json_game);
-
-    const char *json_str = json_object_to_json_string(json_response);
-    char *result = malloc(strlen(json_str) + 1);
-    if (result) strcpy(result, json_str);
-
-    json_object_put(json_response);
-    return result;
+    return write_response_end(&writer);
 }
 
 
-char *serialize_game_updated_to_json(const GameDTO *game) {
+Message *serialize_game_updated_to_json(const GameDTO *game) {
     if (!game) return NULL;
 
-    struct json_object *json_response = json_object_new_object();
-    struct json_object *json_game = json_object_new_object();
-
-    json_object_object_add(json_game, "id_game",
-        json_object_new_int64(game->id_game));
-
-    json_object_object_add(json_game, "creator_nickname",
-        json_object_new_string(game->creator_nickname));
-
-    json_object_object_add(json_game, "owner_nickname",
-        json_object_new_string(game->owner_nickname));
-
-    json_object_object_add(json_game, "owner_current_streak",
-        json_object_new_int(game->owner_current_streak));
-
-    json_object_object_add(json_game, "owner_max_streak",
-        json_object_new_int(game->owner_max_streak));
-
-    json_object_object_add(json_game, "state",
-        json_object_new_string(game->state_str));
-
-    json_object_object_add(json_game, "created_at",
-        json_object_new_string(game->created_at_str));
-
-    json_object_object_add(json_response, "status",
-        json_object_new_string("success"));
-
-    json_object_object_add(json_response, "action",
-        json_object_new_string("server_game_updated"));
-
-    json_object_object_add(json_response, "game", json_game);
-
-    const char *json_str = json_object_to_json_string(json_response);
-
-    char *result = malloc(strlen(json_str) + 1);
-    if (result)
-        strcpy(result, json_str);
-
-    json_object_put(json_response);
-    return result;
+    JsonWriter writer;
+    json_writer_init(&writer);
+
+    write_response_head(&writer, "success", "server_game_updated");
+
+    json_writer_key(&writer, "game");
+    json_writer_object_begin(&writer);
+    json_writer_field_int64(&writer, "id_game", game->id_game);
+    json_writer_field_string(&writer, "creator_nickname", game->creator_nickname);
+    json_writer_field_string(&writer, "owner_nickname", game->owner_nickname);
+    json_writer_field_int64(&writer, "owner_current_streak", game->owner_current_streak);
+    json_writer_field_int64(&writer, "owner_max_streak", game->owner_max_streak);
+    json_writer_field_string(&writer, "state", game->state_str);
+    json_writer_field_string(&writer, "created_at", game->created_at_str);
+    json_writer_field_int64(&writer, "board_size", game->board_size);
+    json_writer_field_int64(&writer, "win_length", game->win_length);
+    json_writer_object_end(&writer);
+
+    return write_response_end(&writer);
 }
 
 // Serialize: RoundDTO
-char *serialize_rounds_to_json(const char *action, const RoundDTO* rounds, size_t count) {
-    struct json_object *json_response = json_object_new_object();
-    struct json_object *json_array = json_object_new_array();
+Message *serialize_rounds_to_json(const char *action, const RoundDTO* rounds, size_t count) {
+    JsonWriter writer;
+    json_writer_init(&writer);
 
-    for (size_t i = 0; i < count; i++) {
-        struct json_object *json_round = json_object_new_object();
+    write_response_head(&writer, "success", action);
+    json_writer_field_int64(&writer, "count", (int64_t)count);
 
-        json_object_object_add(json_round, "id_round",
-            json_object_new_int64(rounds[i].id_round));
-
-        json_object_object_add(json_round, "id_game",
-            json_object_new_int64(rounds[i].id_game));
-
-        json_object_object_add(json_round, "state",
-            json_object_new_string(rounds[i].state_str));
-
-        json_object_object_add(json_round, "start_time",
-            json_object_new_int64(rounds[i].start_time));
-
-        json_object_object_add(json_round, "end_time",
-            json_object_new_int64(rounds[i].end_time));
+    json_writer_key(&writer, "rounds");
+    json_writer_array_begin(&writer);
+    for (size_t i = 0; i < count; i++) {
+        json_writer_object_begin(&writer);
+        json_writer_field_int64(&writer, "id_round", rounds[i].id_round);
+        json_writer_field_int64(&writer, "id_game", rounds[i].id_game);
+        json_writer_field_string(&writer, "state", rounds[i].state_str);
+        json_writer_field_int64(&writer, "start_time", rounds[i].start_time);
+        json_writer_field_int64(&writer, "end_time", rounds[i].end_time);
 
         // Duration is DERIVED, not stored
         if (rounds[i].end_time > 0 && rounds[i].start_time > 0) {
-            json_object_object_add(json_round, "duration",
-                json_object_new_int64(rounds[i].end_time - rounds[i].start_time));
+            json_writer_field_int64(&writer, "duration", rounds[i].end_time - rounds[i].start_time);
         }
 
-        json_object_object_add(json_round, "board",
-            json_object_new_string(rounds[i].board));
-
-        json_object_array_add(json_array, json_round);
-    }
-
-    json_object_object_add(json_response, "status",
-        json_object_new_string("success"));
-
-    if (action) {
-        json_object_object_add(json_response, "action",
-            json_object_new_string(action));
+        json_writer_field_string(&writer, "board", rounds[i].board);
+        json_writer_field_int64(&writer, "board_size", rounds[i].board_size);
+        json_writer_field_int64(&writer, "win_length", rounds[i].win_length);
+        json_writer_object_end(&writer);
     }
+    json_writer_array_end(&writer);
 
-    json_object_object_add(json_response, "count",
-        json_object_new_int64(count));
-
-    json_object_object_add(json_response, "rounds", json_array);
-
-    const char *json_str = json_object_to_json_string(json_response);
-    char *result = malloc(strlen(json_str) + 1);
-    if (result) strcpy(result, json_str);
-
-    json_object_put(json_response);
-    return result;
+    return write_response_end(&writer);
 }
 
 
 // Serialize: ParticipationRequestDTO
-char *serialize_participation_requests_to_json(const char *action, const ParticipationRequestDTO* participationRequests, size_t count) {
-    struct json_object *json_response = json_object_new_object();
-    struct json_object *json_array = json_object_new_array();
-
-    for (size_t i = 0; i < count; i++) {
-        struct json_object *json_request = json_object_new_object();
-
-        json_object_object_add(json_request, "id_request", json_object_new_int64(participationRequests[i].id_request));
-        json_object_object_add(json_request, "id_game", json_object_new_int64(participationRequests[i].id_game));
-        json_object_object_add(json_request, "player_nickname", json_object_new_string(participationRequests[i].player_nickname));
-        json_object_object_add(json_request, "state", json_object_new_string(participationRequests[i].state_str));
-        json_object_object_add(json_request, "created_at", json_object_new_string(participationRequests[i].created_at_str));
+Message *serialize_participation_requests_to_json(const char *action, const ParticipationRequestDTO* participationRequests, size_t count) {
+    JsonWriter writer;
+    json_writer_init(&writer);
 
-        json_object_array_add(json_array, json_request);
-    }
+    write_response_head(&writer, "success", action);
+    json_writer_field_int64(&writer, "count", (int64_t)count);
 
-    json_object_object_add(json_response, "status", json_object_new_string("success"));
-    if (action) {
-        json_object_object_add(json_response, "action", json_object_new_string(action));
+    json_writer_key(&writer, "participation_requests");
+    json_writer_array_begin(&writer);
+    for (size_t i = 0; i < count; i++) {
+        json_writer_object_begin(&writer);
+        json_writer_field_int64(&writer, "id_request", participationRequests[i].id_request);
+        json_writer_field_int64(&writer, "id_game", participationRequests[i].id_game);
+        json_writer_field_string(&writer, "player_nickname", participationRequests[i].player_nickname);
+        json_writer_field_string(&writer, "state", participationRequests[i].state_str);
+        json_writer_field_string(&writer, "created_at", participationRequests[i].created_at_str);
+        json_writer_object_end(&writer);
     }
-    json_object_object_add(json_response, "count", json_object_new_int64(count));
-    json_object_object_add(json_response, "participation_requests", json_array);
-
-    const char *json_str = json_object_to_json_string(json_response);
-    char *result = malloc(strlen(json_str) + 1);
+    json_writer_array_end(&writer);
 
-    if (result) strcpy(result, json_str);
-
-    json_object_put(json_response);
-    return result;
+    return write_response_end(&writer);
 }
 
 // Serialize: PlayDTO
-char *serialize_plays_to_json(const char *action, const PlayDTO* plays, size_t count) {
-    struct json_object *json_response = json_object_new_object();
-    struct json_object *json_array = json_object_new_array();
-
-    for (size_t i = 0; i < count; i++) {
-        struct json_object *json_play = json_object_new_object();
+Message *serialize_plays_to_json(const char *action, const PlayDTO* plays, size_t count) {
+    JsonWriter writer;
+    json_writer_init(&writer);
 
-        json_object_object_add(json_play, "id_player", json_object_new_int64(plays[i].id_player));
-        json_object_object_add(json_play, "id_round", json_object_new_int64(plays[i].id_round));
-        json_object_object_add(json_play, "player_number", json_object_new_int(plays[i].player_number));
-        json_object_object_add(json_play, "player_nickname", json_object_new_string(plays[i].player_nickname));
-        json_object_object_add(json_play, "result", json_object_new_string(plays[i].result_str));
+    write_response_head(&writer, "success", action);
+    json_writer_field_int64(&writer, "count", (int64_t)count);
 
-        json_object_array_add(json_array, json_play);
-    }
-
-    json_object_object_add(json_response, "status", json_object_new_string("success"));
-    if (action) {
-        json_object_object_add(json_response, "action", json_object_new_string(action));
+    json_writer_key(&writer, "plays");
+    json_writer_array_begin(&writer);
+    for (size_t i = 0; i < count; i++) {
+        json_writer_object_begin(&writer);
+        json_writer_field_int64(&writer, "id_player", plays[i].id_player);
+        json_writer_field_int64(&writer, "id_round", plays[i].id_round);
+        json_writer_field_int64(&writer, "player_number", plays[i].player_number);
+        json_writer_field_string(&writer, "player_nickname", plays[i].player_nickname);
+        json_writer_field_string(&writer, "result", plays[i].result_str);
+        json_writer_object_end(&writer);
     }
-    json_object_object_add(json_response, "count", json_object_new_int64(count));
-    json_object_object_add(json_response, "plays", json_array);
-
-    const char *json_str = json_object_to_json_string(json_response);
-    char *result = malloc(strlen(json_str) + 1);
-    if (result) strcpy(result, json_str);
+    json_writer_array_end(&writer);
 
-    json_object_put(json_response);
-    return result;
+    return write_response_end(&writer);
 }
 
-char *serialize_notification_to_json(const char *action, NotificationDTO* in_notification) {
+Message *serialize_notification_to_json(const char *action, NotificationDTO* in_notification) {
 
     if (!in_notification) return NULL;
 
-    struct json_object *json_response = json_object_new_object();
+    JsonWriter writer;
+    json_writer_init(&writer);
 
-    json_object_object_add(json_response, "status", json_object_new_string("success"));
-    if (action) {
-        json_object_object_add(json_response, "action", json_object_new_string(action));
-    }
+    write_response_head(&writer, "success", action);
     if (in_notification->id_playerSender != -1) {
-        json_object_object_add(json_response, "id_sender", json_object_new_int64(in_notification->id_playerSender));
+        json_writer_field_int64(&writer, "id_sender", in_notification->id_playerSender);
     }
     if (in_notification->id_playerReceiver != -1) {
-        json_object_object_add(json_response, "id_receiver", json_object_new_int64(in_notification->id_playerReceiver));
+        json_writer_field_int64(&writer, "id_receiver", in_notification->id_playerReceiver);
     }
     if (in_notification->id_game != -1) {
-        json_object_object_add(json_response, "id_game", json_object_new_int64(in_notification->id_game));
+        json_writer_field_int64(&writer, "id_game", in_notification->id_game);
     }
     if (in_notification->id_round != -1) {
-        json_object_object_add(json_response, "id_round", json_object_new_int64(in_notification->id_round));
+        json_writer_field_int64(&writer, "id_round", in_notification->id_round);
     }
 
     if (in_notification->id_request != -1) {
-        json_object_object_add(json_response, "id_request", json_object_new_int64(in_notification->id_request));
+        json_writer_field_int64(&writer, "id_request", in_notification->id_request);
     }
-    
-    json_object_object_add(json_response, "message", json_object_new_string(in_notification->message));
-
-    const char *json_str = json_object_to_json_string(json_response);
-    char *result = malloc(strlen(json_str) + 1);
-    if (result) strcpy(result, json_str);
 
-    json_object_put(json_response); 
+    json_writer_field_string(&writer, "message", in_notification->message);
 
-    return result;     
+    return write_response_end(&writer);
 }
 
-char *serialize_round_full_to_json(const char *action, RoundFullDTO* in_round_full) {
+Message *serialize_round_full_to_json(const char *action, RoundFullDTO* in_round_full) {
 
     if (!in_round_full || !action) return NULL;
 
-    json_object *root = json_object_new_object();
-    if (!root) return NULL;
+    JsonWriter writer;
+    json_writer_init(&writer);
 
-    json_object_object_add(root, "status", json_object_new_string("success"));
-    json_object_object_add(root, "action", json_object_new_string(action));
+    write_response_head(&writer, "success", action);
 
-    json_object *round_obj = json_object_new_object();
+    json_writer_key(&writer, "round");
+    json_writer_object_begin(&writer);
+    json_writer_field_int64(&writer, "id_round", in_round_full->id_round);
+    json_writer_field_int64(&writer, "id_game", in_round_full->id_game);
+    json_writer_field_string(&writer, "state", in_round_full->state);
+    json_writer_field_int64(&writer, "start_time", in_round_full->start_time);
+    json_writer_field_int64(&writer, "end_time", in_round_full->end_time);
 
-    json_object_object_add(round_obj, "id_round",
-        json_object_new_int64(in_round_full->id_round));
+    // Duration is derived, not persisted
+    if (in_round_full->start_time > 0 && in_round_full->end_time > 0) {
+        json_writer_field_int64(&writer, "duration", in_round_full->end_time - in_round_full->start_time);
+    }
 
-    json_object_object_add(round_obj, "id_game",
-        json_object_new_int64(in_round_full->id_game));
+    json_writer_field_string(&writer, "board", in_round_full->board);
+    json_writer_field_int64(&writer, "board_size", in_round_full->board_size);
+    json_writer_field_int64(&writer, "win_length", in_round_full->win_length);
 
-    json_object_object_add(round_obj, "state",
-        json_object_new_string(in_round_full->state));
+    json_writer_field_int64(&writer, "id_player1", in_round_full->id_player1);
+    json_writer_field_int64(&writer, "id_player2", in_round_full->id_player2);
 
-    json_object_object_add(round_obj, "start_time",
-        json_object_new_int64(in_round_full->start_time));
+    json_writer_field_string(&writer, "nickname_player1", in_round_full->nickname_player1);
+    json_writer_field_string(&writer, "nickname_player2", in_round_full->nickname_player2);
 
-    json_object_object_add(round_obj, "end_time",
-        json_object_new_int64(in_round_full->end_time));
+    json_writer_field_int64(&writer, "player_number_player1", in_round_full->player_number_player1);
+    json_writer_field_int64(&writer, "player_number_player2", in_round_full->player_number_player2);
+    json_writer_object_end(&writer);
 
-    // Duration is derived, not persisted
-    if (in_round_full->start_time > 0 && in_round_full->end_time > 0) {
-        json_object_object_add(round_obj, "duration",
-            json_object_new_int64(in_round_full->end_time - in_round_full->start_time));
-    }
+    return write_response_end(&writer);
+}
 
-    json_object_object_add(round_obj, "board",
-        json_object_new_string(in_round_full->board));
+/**
+ * Serialize: results of a batch, each one copied as it is (the response the operation would get on its own).
+ * An operation that produced no response is written as `null`. `error_message` turns the batch into an error,
+ * e.g. when its transaction was rolled back, but the results are still reported.
+ */
+Message *serialize_batch_to_json(const char *action, Message *const *results, size_t count, const char *error_message) {
+    JsonWriter writer;
+    json_writer_init(&writer);
+
+    write_response_head(&writer, error_message ? "error" : "success", action);
+    if (error_message) {
+        json_writer_field_string(&writer, "error_message", error_message);
+    }
 
-    json_object_object_add(round_obj, "id_player1",
-        json_object_new_int64(in_round_full->id_player1));
-    json_object_object_add(round_obj, "id_player2",
-        json_object_new_int64(in_round_full->id_player2));
+    json_writer_key(&writer, "results");
+    json_writer_array_begin(&writer);
+    for (size_t i = 0; i < count; i++) {
+        if (results[i])
+            json_writer_raw(&writer, message_body(results[i]), results[i]->len - MESSAGE_PREFIX_SIZE);
+        else
+            json_writer_null(&writer);
+    }
+    json_writer_array_end(&writer);
 
-    json_object_object_add(round_obj, "nickname_player1",
-        json_object_new_string(in_round_full->nickname_player1));
-    json_object_object_add(round_obj, "nickname_player2",
-        json_object_new_string(in_round_full->nickname_player2));
+    return write_response_end(&writer);
+}
 
-    json_object_object_add(round_obj, "player_number_player1",
-        json_object_new_int(in_round_full->player_number_player1));
-    json_object_object_add(round_obj, "player_number_player2",
-        json_object_new_int(in_round_full->player_number_player2));
+// Every response starts with its status, after the `req_id` stamped by add_req_id_to_json() if any.
+// Error responses are the ones of serialize_action_error()
+bool is_error_response(const Message *response) {
 
-    json_object_object_add(root, "round", round_obj);
+    static const char req_id[] = "{\"req_id\":";
+    static const char status[] = "\"status\":\"error\"";
 
-    const char *json_str = json_object_to_json_string_ext(root, JSON_C_TO_STRING_PLAIN);
-    if (!json_str) {
-        json_object_put(root);
-        return NULL;
-    }
+    if (!response)
+        return false;
 
-    size_t len = strlen(json_str);
+    const char *body = message_body(response);
+    const char *end = body + (response->len - MESSAGE_PREFIX_SIZE);
+    const char *cursor = body + 1;
 
-    char *result = malloc(len + 1);
-    if (!result) {
-        json_object_put(root);
-        return NULL;
+    if ((size_t)(end - body) >= sizeof(req_id) - 1 && memcmp(body, req_id, sizeof(req_id) - 1) == 0) {
+        cursor = body + sizeof(req_id) - 1;
+        while (cursor < end && *cursor != ',' && *cursor != '}')
+            cursor++;
+        if (cursor == end || *cursor != ',')
+            return false;
+        cursor++;
     }
 
-    memcpy(result, json_str, len + 1);
-
-    json_object_put(root);
+    return (size_t)(end - cursor) >= sizeof(status) - 1 && memcmp(cursor, status, sizeof(status) - 1) == 0;
+}
 
-    return result;
+/**
+ * Adds `"req_id":<req_id>` as the first key of a response that is not shared yet, so the client can
+ * match it with its request. Handlers build their responses without knowing the id, the router stamps it once.
+ * @return The stamped message (it may have moved), the unchanged one if it could not be stamped.
+ */
+Message *add_req_id_to_json(Message *response, int64_t req_id) {
+
+    char *body = response->data + MESSAGE_PREFIX_SIZE;
+    size_t body_len = response->len - MESSAGE_PREFIX_SIZE;
+    if (body_len < 2 || body[0] != '{')
+        return response;
+
+    char field[40];
+    int field_len = snprintf(field, sizeof(field), "\"req_id\":%" PRId64 "%s", req_id, body[1] == '}' ? "" : ",");
+    if (field_len < 0 || (size_t)field_len >= sizeof(field))
+        return response;
+
+    Message *stamped = message_grow(response, response->len + (size_t)field_len + 1);
+    if (!stamped)
+        return response;
+
+    body = stamped->data + MESSAGE_PREFIX_SIZE;
+    memmove(body + 1 + field_len, body + 1, body_len - 1);
+    memcpy(body + 1, field, (size_t)field_len);
+    message_seal(stamped, body_len + (size_t)field_len);
+
+    return stamped;
 }
@@ -0,0 +1,243 @@
+#include <string.h>
+
+#include "json-writer.h"
+
+// ==================== Private functions ====================
+
+static bool reserve(JsonWriter *writer, size_t bytes);
+static void append(JsonWriter *writer, const char *bytes, size_t count);
+static void before_value(JsonWriter *writer);
+static void container_begin(JsonWriter *writer, char open);
+static void container_end(JsonWriter *writer, char close);
+
+// ===========================================================
+
+void json_writer_init(JsonWriter *writer) {
+
+    writer->message = message_alloc(MESSAGE_POOL_BUFFER_SIZE);
+    writer->len = MESSAGE_PREFIX_SIZE;
+    writer->has_items = 0;
+    writer->depth = 0;
+    writer->after_key = false;
+    writer->failed = writer->message == NULL;
+}
+
+/**
+ * Frames the written document.
+ * @return The message with one reference owned by the caller, `NULL` if anything failed.
+ */
+Message *json_writer_finish(JsonWriter *writer) {
+
+    Message *message = writer->message;
+    writer->message = NULL;
+
+    if (!message)
+        return NULL;
+
+    if (writer->failed || writer->depth != 0 || message_seal(message, writer->len - MESSAGE_PREFIX_SIZE) < 0) {
+        message_release(message);
+        return NULL;
+    }
+
+    return message;
+}
+
+// Makes room for `bytes` more bytes and the terminator, doubling the buffer when it is full
+static bool reserve(JsonWriter *writer, size_t bytes) {
+
+    if (writer->failed)
+        return false;
+
+    size_t needed = writer->len + bytes + 1;
+    if (needed <= writer->message->capacity)
+        return true;
+
+    size_t capacity = writer->message->capacity * 2;
+    while (capacity < needed)
+        capacity *= 2;
+
+    Message *grown = message_grow(writer->message, capacity);
+    if (!grown) {
+        writer->failed = true;
+        return false;
+    }
+
+    writer->message = grown;
+    return true;
+}
+
+static void append(JsonWriter *writer, const char *bytes, size_t count) {
+
+    if (!reserve(writer, count))
+        return;
+
+    memcpy(writer->message->data + writer->len, bytes, count);
+    writer->len += count;
+}
+
+// Writes the comma that separates a value from the previous item of its container
+static void before_value(JsonWriter *writer) {
+
+    if (writer->after_key) {
+        writer->after_key = false;
+        return;
+    }
+
+    if (writer->depth > 0) {
+        uint64_t bit = (uint64_t)1 << (writer->depth - 1);
+        if (writer->has_items & bit)
+            append(writer, ",", 1);
+        writer->has_items |= bit;
+    }
+}
+
+static void container_begin(JsonWriter *writer, char open) {
+
+    before_value(writer);
+
+    if (writer->depth == JSON_WRITER_MAX_DEPTH) {
+        writer->failed = true;
+        return;
+    }
+
+    append(writer, &open, 1);
+    writer->depth++;
+    writer->has_items &= ~((uint64_t)1 << (writer->depth - 1));
+}
+
+static void container_end(JsonWriter *writer, char close) {
+
+    if (writer->depth == 0) {
+        writer->failed = true;
+        return;
+    }
+
+    append(writer, &close, 1);
+    writer->depth--;
+}
+
+void json_writer_object_begin(JsonWriter *writer) {
+    container_begin(writer, '{');
+}
+
+void json_writer_object_end(JsonWriter *writer) {
+    container_end(writer, '}');
+}
+
+void json_writer_array_begin(JsonWriter *writer) {
+    container_begin(writer, '[');
+}
+
+void json_writer_array_end(JsonWriter *writer) {
+    container_end(writer, ']');
+}
+
+void json_writer_key(JsonWriter *writer, const char *key) {
+    json_writer_string(writer, key);
+    append(writer, ":", 1);
+    writer->after_key = true;
+}
+
+/**
+ * Writes a quoted string, escaping quotes, backslashes and control characters.
+ * Runs of characters that need no escape are copied at once. `NULL` is written as `""`.
+ */
+void json_writer_string(JsonWriter *writer, const char *value) {
+
+    static const char hex[] = "0123456789abcdef";
+
+    before_value(writer);
+    append(writer, "\"", 1);
+
+    const char *run = value ? value : "";
+    const char *p = run;
+
+    for (;; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        append(writer, run, (size_t)(p - run));
+        if (c == '\0')
+            break;
+
+        char escape[6] = { '\\', 0, 0, 0, 0, 0 };
+        size_t escape_len = 2;
+
+        switch (c) {
+            case '"':  escape[1] = '"'; break;
+            case '\\': escape[1] = '\\'; break;
+            case '\b': escape[1] = 'b'; break;
+            case '\f': escape[1] = 'f'; break;
+            case '\n': escape[1] = 'n'; break;
+            case '\r': escape[1] = 'r'; break;
+            case '\t': escape[1] = 't'; break;
+            default:
+                escape[1] = 'u';
+                escape[2] = '0';
+                escape[3] = '0';
+                escape[4] = hex[c >> 4];
+                escape[5] = hex[c & 0xf];
+                escape_len = 6;
+        }
+
+        append(writer, escape, escape_len);
+        run = p + 1;
+    }
+
+    append(writer, "\"", 1);
+}
+
+// Digits are produced backwards into a small buffer, no printf
+void json_writer_int64(JsonWriter *writer, int64_t value) {
+
+    char digits[20];
+    size_t count = 0;
+
+    // Negating INT64_MIN overflows: work on the unsigned magnitude
+    uint64_t magnitude = value < 0 ? (uint64_t)0 - (uint64_t)value : (uint64_t)value;
+
+    do {
+        digits[sizeof(digits) - 1 - count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    before_value(writer);
+    if (value < 0)
+        append(writer, "-", 1);
+    append(writer, digits + sizeof(digits) - count, count);
+}
+
+void json_writer_bool(JsonWriter *writer, bool value) {
+    before_value(writer);
+    if (value)
+        append(writer, "true", 4);
+    else
+        append(writer, "false", 5);
+}
+
+void json_writer_null(JsonWriter *writer) {
+    before_value(writer);
+    append(writer, "null", 4);
+}
+
+// Writes a value that is already serialized, e.g. the body of another message
+void json_writer_raw(JsonWriter *writer, const char *json, size_t len) {
+    before_value(writer);
+    append(writer, json, len);
+}
+
+void json_writer_field_string(JsonWriter *writer, const char *key, const char *value) {
+    json_writer_key(writer, key);
+    json_writer_string(writer, value);
+}
+
+void json_writer_field_int64(JsonWriter *writer, const char *key, int64_t value) {
+    json_writer_key(writer, key);
+    json_writer_int64(writer, value);
+}
+
+void json_writer_field_bool(JsonWriter *writer, const char *key, bool value) {
+    json_writer_key(writer, key);
+    json_writer_bool(writer, value);
+}
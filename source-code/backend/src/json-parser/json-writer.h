@@ -0,0 +1,47 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../server/message.h"
+
+#define JSON_WRITER_MAX_DEPTH 64        // Nested objects and arrays
+
+/**
+ * Streaming JSON writer: values are escaped and appended straight into a framed Message,
+ * after the 4 bytes reserved for its length prefix, without building a tree first.
+ * The buffer comes from the message pool, so a response costs no allocation in steady state.
+ * Writing errors are sticky: json_writer_finish() reports them once, at the end.
+ */
+typedef struct {
+    Message *message;
+    size_t len;                         // Bytes written in `message->data`, prefix included
+    uint64_t has_items;                 // Bit `d` is set once the container at depth `d` has an item
+    int depth;
+    bool after_key;                     // The next value belongs to the key just written
+    bool failed;
+} JsonWriter;
+
+void json_writer_init(JsonWriter *writer);
+Message *json_writer_finish(JsonWriter *writer);
+
+void json_writer_object_begin(JsonWriter *writer);
+void json_writer_object_end(JsonWriter *writer);
+void json_writer_array_begin(JsonWriter *writer);
+void json_writer_array_end(JsonWriter *writer);
+
+void json_writer_key(JsonWriter *writer, const char *key);
+void json_writer_string(JsonWriter *writer, const char *value);
+void json_writer_int64(JsonWriter *writer, int64_t value);
+void json_writer_bool(JsonWriter *writer, bool value);
+void json_writer_null(JsonWriter *writer);
+void json_writer_raw(JsonWriter *writer, const char *json, size_t len);
+
+// Shorthands for a key followed by its value
+void json_writer_field_string(JsonWriter *writer, const char *key, const char *value);
+void json_writer_field_int64(JsonWriter *writer, const char *key, int64_t value);
+void json_writer_field_bool(JsonWriter *writer, const char *key, bool value);
+
+#endif
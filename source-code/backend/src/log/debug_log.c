@@ -0,0 +1,310 @@
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../include/debug_log.h"
+
+#define LOG_OUTPUT_SIZE 65536       // Bytes collected by the writer before each write() to stderr
+
+// A formatted message waiting in a ring, the writer adds the prefix
+typedef struct {
+    time_t time;
+    const char *file;               // __FILE__ and __func__ are string literals, they outlive the record
+    const char *func;
+    int line;
+    LogSeverity severity;
+    char text[LOG_MESSAGE_SIZE];
+} LogRecord;
+
+/**
+ * Single producer, single consumer ring: only its thread writes `head`, only the writer thread writes `tail`.
+ * Rings are never unlinked while their thread runs, so producers don't take any lock.
+ */
+typedef struct LogRing {
+    LogRecord records[LOG_RING_RECORDS];
+    atomic_size_t head;             // Next record written by the thread
+    atomic_size_t tail;             // Next record read by the writer
+    atomic_size_t dropped;          // Lines lost because the ring was full
+    atomic_bool closed;             // The thread exited, the writer frees the ring once drained
+    struct LogRing *next;
+} LogRing;
+
+atomic_int log_runtime_severity = LOG_DEFAULT_SEVERITY;
+
+static const char *severity_names[] = {
+    [LOG_SEVERITY_DEBUG] = COLOR_DEBUG "DEBUG" COLOR_RESET,
+    [LOG_SEVERITY_INFO]  = COLOR_INFO "INFO" COLOR_RESET,
+    [LOG_SEVERITY_WARN]  = COLOR_WARN "WARN" COLOR_RESET,
+    [LOG_SEVERITY_ERROR] = COLOR_ERROR "ERROR" COLOR_RESET
+};
+
+static LogRing *rings;              // Rings of every thread that logged, protected by rings_lock
+static pthread_mutex_t rings_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t ring_key;      // Its destructor marks the ring of an exiting thread as closed
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+static _Thread_local LogRing *thread_ring;
+
+static pthread_t writer_thread;
+static atomic_bool writer_running;
+static atomic_bool writer_sleeping;
+static pthread_mutex_t writer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t writer_wakeup = PTHREAD_COND_INITIALIZER;
+
+// Synchronous lines, before the writer starts and after it stops
+static pthread_mutex_t direct_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// ==================== Private functions ====================
+
+static void ring_key_create(void);
+static void ring_close(void *ring);
+static LogRing *ring_of_thread(void);
+static size_t format_line(char *out, size_t size, const LogRecord *record);
+static void write_all(const char *buffer, size_t length);
+static bool drain_rings(void);
+static void *writer_loop(void *arg);
+
+// ===========================================================
+
+static void ring_key_create(void) {
+    pthread_key_create(&ring_key, ring_close);
+}
+
+static void ring_close(void *ring) {
+    atomic_store_explicit(&((LogRing *)ring)->closed, true, memory_order_release);
+}
+
+// The ring of the calling thread, created on its first line. `NULL` if it can't be allocated
+static LogRing *ring_of_thread(void) {
+
+    if (thread_ring)
+        return thread_ring;
+
+    pthread_once(&ring_key_once, ring_key_create);
+
+    LogRing *ring = calloc(1, sizeof(LogRing));
+    if (!ring)
+        return NULL;
+
+    pthread_mutex_lock(&rings_lock);
+    ring->next = rings;
+    rings = ring;
+    pthread_mutex_unlock(&rings_lock);
+
+    pthread_setspecific(ring_key, ring);
+    thread_ring = ring;
+    return ring;
+}
+
+/**
+ * Writes `[hh:mm:ss][LEVEL] file:line:func(): message` into `out`, always ending with a newline.
+ * The clock is formatted once per second and reused by the following lines.
+ */
+static size_t format_line(char *out, size_t size, const LogRecord *record) {
+
+    static _Thread_local time_t cached_second = -1;
+    static _Thread_local char cached_clock[16];
+
+    if (record->time != cached_second) {
+        struct tm timeStruct;
+        localtime_r(&record->time, &timeStruct);
+        snprintf(cached_clock, sizeof(cached_clock), "%02d:%02d:%02d", timeStruct.tm_hour, timeStruct.tm_min, timeStruct.tm_sec);
+        cached_second = record->time;
+    }
+
+    int written = snprintf(out, size, "[%s][%s] %s:%d:%s(): %s", cached_clock, severity_names[record->severity],
+                           record->file, record->line, record->func, record->text);
+    if (written < 0)
+        return 0;
+
+    size_t length = (size_t)written < size ? (size_t)written : size - 1;
+    if (length > 0 && out[length - 1] != '\n') {
+        if (length == size - 1)
+            length--;
+        out[length++] = '\n';
+        out[length] = '\0';
+    }
+
+    return length;
+}
+
+static void write_all(const char *buffer, size_t length) {
+
+    while (length > 0) {
+        ssize_t written = write(STDERR_FILENO, buffer, length);
+        if (written <= 0)
+            return;
+        buffer += written;
+        length -= (size_t)written;
+    }
+}
+
+void log_write(LogSeverity severity, const char *file, int line, const char *func, const char *format_string, ...) {
+
+    LogRing *ring = atomic_load(&writer_running) ? ring_of_thread() : NULL;
+
+    LogRecord direct;
+    LogRecord *record = &direct;
+    size_t head = 0;
+
+    if (ring) {
+        head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        if (head - atomic_load_explicit(&ring->tail, memory_order_acquire) == LOG_RING_RECORDS) {
+            atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+            return;
+        }
+        record = &ring->records[head & (LOG_RING_RECORDS - 1)];
+    }
+
+    record->time = time(NULL);
+    record->file = file;
+    record->func = func;
+    record->line = line;
+    record->severity = severity;
+
+    va_list args;
+    va_start(args, format_string);
+    vsnprintf(record->text, sizeof(record->text), format_string, args);
+    va_end(args);
+
+    if (!ring) {
+        char line_buffer[LOG_MESSAGE_SIZE + 256];
+        pthread_mutex_lock(&direct_lock);
+        write_all(line_buffer, format_line(line_buffer, sizeof(line_buffer), record));
+        pthread_mutex_unlock(&direct_lock);
+        return;
+    }
+
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    // The writer is waiting for work: wake it up instead of letting the line wait for its timeout
+    if (atomic_load(&writer_sleeping)) {
+        pthread_mutex_lock(&writer_lock);
+        pthread_cond_signal(&writer_wakeup);
+        pthread_mutex_unlock(&writer_lock);
+    }
+}
+
+/**
+ * Moves every buffered line to stderr, batching the writes, and frees the rings of the exited threads.
+ * Only the writer thread (or log_shutdown() once it has stopped) calls it.
+ * @return `true` if at least one line was written
+ */
+static bool drain_rings(void) {
+
+    static char output[LOG_OUTPUT_SIZE];
+    size_t used = 0;
+    bool any = false;
+
+    pthread_mutex_lock(&rings_lock);
+    LogRing **link = &rings;
+
+    while (*link) {
+        LogRing *ring = *link;
+        bool closed = atomic_load_explicit(&ring->closed, memory_order_acquire);
+
+        size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+        for (; tail != head; tail++) {
+            if (LOG_OUTPUT_SIZE - used < LOG_MESSAGE_SIZE + 256) {
+                write_all(output, used);
+                used = 0;
+            }
+            used += format_line(output + used, LOG_OUTPUT_SIZE - used, &ring->records[tail & (LOG_RING_RECORDS - 1)]);
+            any = true;
+        }
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+
+        size_t dropped = atomic_exchange_explicit(&ring->dropped, 0, memory_order_relaxed);
+        if (dropped > 0) {
+            int written = snprintf(output + used, LOG_OUTPUT_SIZE - used, "[%s] %zu log lines dropped, the ring of a thread was full\n",
+                                   severity_names[LOG_SEVERITY_WARN], dropped);
+            if (written > 0 && (size_t)written < LOG_OUTPUT_SIZE - used)
+                used += (size_t)written;
+        }
+
+        // A closed ring gets no new lines: everything it had was just written
+        if (closed) {
+            *link = ring->next;
+            free(ring);
+        } else {
+            link = &ring->next;
+        }
+    }
+
+    pthread_mutex_unlock(&rings_lock);
+
+    write_all(output, used);
+    return any;
+}
+
+static void *writer_loop(void *arg) {
+    (void)arg;
+
+    while (atomic_load(&writer_running)) {
+
+        if (drain_rings())
+            continue;
+
+        // Nothing to write: sleep until a thread signals a new line, at most one second
+        pthread_mutex_lock(&writer_lock);
+        atomic_store(&writer_sleeping, true);
+        struct timespec deadline = { .tv_sec = time(NULL) + 1, .tv_nsec = 0 };
+        if (atomic_load(&writer_running))
+            pthread_cond_timedwait(&writer_wakeup, &writer_lock, &deadline);
+        atomic_store(&writer_sleeping, false);
+        pthread_mutex_unlock(&writer_lock);
+    }
+
+    return NULL;
+}
+
+int log_init(void) {
+
+    const char *level = getenv("LOG_LEVEL");
+    if (level) {
+        if (strcmp(level, "debug") == 0)
+            log_set_level(LOG_SEVERITY_DEBUG);
+        else if (strcmp(level, "info") == 0)
+            log_set_level(LOG_SEVERITY_INFO);
+        else if (strcmp(level, "warn") == 0)
+            log_set_level(LOG_SEVERITY_WARN);
+        else if (strcmp(level, "error") == 0)
+            log_set_level(LOG_SEVERITY_ERROR);
+        else
+            LOG_WARN("Unknown LOG_LEVEL \"%s\", keeping the default level\n", level);
+    }
+
+    atomic_store(&writer_running, true);
+    if (pthread_create(&writer_thread, NULL, writer_loop, NULL) != 0) {
+        atomic_store(&writer_running, false);
+        LOG_ERROR("%s\n", "Failed to start the log writer, logging synchronously");
+        return -1;
+    }
+
+    atomic_store(&writer_sleeping, false);
+    atexit(log_shutdown);
+    return 0;
+}
+
+void log_shutdown(void) {
+
+    if (!atomic_exchange(&writer_running, false))
+        return;
+
+    pthread_mutex_lock(&writer_lock);
+    pthread_cond_signal(&writer_wakeup);
+    pthread_mutex_unlock(&writer_lock);
+
+    pthread_join(writer_thread, NULL);
+
+    // Lines written between the last drain and the stop
+    drain_rings();
+}
+
+void log_set_level(LogSeverity severity) {
+    atomic_store(&log_runtime_severity, (int)severity);
+}
@@ -8,13 +8,32 @@
 
 #include "./server/router.h"
 
+#include "./dao/sqlite/db_connection_sqlite.h"
+
+#include "./controllers/bot_controller.h"
+
 #define SERVER_PORT 5050
 
 int main(void) {
 
     int server_port = SERVER_PORT;
+
+    // Log lines are written by a background thread from here on
+    log_init();
     LOG_INFO("%s\n", "Starting LS-TRIS server...");
 
+    // Database connections are opened once, before accepting any client
+    if (db_pool_init(DB_POOL_SIZE) != 0) {
+        LOG_ERROR("%s\n", "Failed to open the database connections");
+        exit(1);
+    }
+
+    // The bot player and its compute threads are ready before the first round can start
+    if (bot_init() != 0) {
+        LOG_ERROR("%s\n", "Failed to start the bot");
+        exit(1);
+    }
+
     if (start_server(server_port) == 0) {
 
         LOG_INFO("Server started successfully on port %d\n", server_port);
@@ -25,5 +44,8 @@ int main(void) {
         exit(1);
     }
 
+    bot_shutdown();
+    log_shutdown();
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/debug_log.h"
+
+#include "arena.h"
+
+#define ARENA_ALIGNMENT alignof(max_align_t)
+
+struct ArenaChunk {
+    ArenaChunk *next;
+    size_t size;                // Bytes available in `data`
+    size_t used;
+    alignas(max_align_t) unsigned char data[];
+};
+
+// One arena per thread, created empty: its first chunk is allocated on first use
+static _Thread_local Arena thread_arena;
+
+// ==================== Private functions ====================
+
+static size_t align_size(size_t size);
+static ArenaChunk *chunk_create(size_t size);
+static void *alloc_in_chunk(Arena *arena, size_t size, size_t room);
+
+// ===========================================================
+
+// Arena of the calling thread, reset by the worker pool after each job
+Arena *arena_thread(void) {
+    return &thread_arena;
+}
+
+static size_t align_size(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+}
+
+static ArenaChunk *chunk_create(size_t size) {
+
+    ArenaChunk *chunk = malloc(sizeof(ArenaChunk) + size);
+    if (!chunk) {
+        LOG_ERROR("%s\n", "malloc() failed for arena chunk");
+        return NULL;
+    }
+
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+
+    return chunk;
+}
+
+/**
+ * Takes `size` bytes, aligned for any type, from the arena.
+ * @return The memory, valid until the next arena_reset(), `NULL` on failure.
+ */
+void *arena_alloc(Arena *arena, size_t size) {
+    return alloc_in_chunk(arena, size, size);
+}
+
+// Bumps the chunk in use, or a new one with at least `room` bytes if `size` does not fit
+static void *alloc_in_chunk(Arena *arena, size_t size, size_t room) {
+
+    if (size == 0) size = 1;
+    if (size > SIZE_MAX - ARENA_ALIGNMENT) return NULL;
+    size = align_size(size);
+
+    ArenaChunk *chunk = arena->chunks;
+    if (!chunk || chunk->size - chunk->used < size) {
+        if (room < size) room = size;
+        chunk = chunk_create(room > ARENA_CHUNK_SIZE ? room : ARENA_CHUNK_SIZE);
+        if (!chunk)
+            return NULL;
+
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+    }
+
+    void *ptr = chunk->data + chunk->used;
+    chunk->used += size;
+    arena->last = ptr;
+
+    return ptr;
+}
+
+/**
+ * Resizes an allocation of `old_size` bytes, the arena equivalent of realloc(): the latest allocation
+ * grows in place while its chunk has room, anything else is copied. `ptr` may be `NULL`.
+ * @return The resized memory, `NULL` on failure (the old one is left as it was).
+ */
+void *arena_grow(Arena *arena, void *ptr, size_t old_size, size_t new_size) {
+
+    if (!ptr)
+        return arena_alloc(arena, new_size);
+
+    if (new_size <= old_size)
+        return ptr;
+
+    ArenaChunk *chunk = arena->chunks;
+    if (ptr == arena->last && new_size <= SIZE_MAX - ARENA_ALIGNMENT) {
+        size_t offset = (size_t)((unsigned char *)ptr - chunk->data);
+        size_t needed = align_size(new_size);
+
+        if (needed <= chunk->size - offset) {
+            chunk->used = offset + needed;
+            return ptr;
+        }
+    }
+
+    // A moved array gets twice the room it needs, so growing it one item at a time stays linear
+    size_t room = new_size <= SIZE_MAX / 2 ? new_size * 2 : new_size;
+    void *grown = alloc_in_chunk(arena, new_size, room);
+    if (grown)
+        memcpy(grown, ptr, old_size);
+
+    return grown;
+}
+
+/**
+ * Releases everything allocated from the arena at once. The oldest chunk is kept and reused,
+ * the ones added by larger requests are returned to malloc.
+ */
+void arena_reset(Arena *arena) {
+
+    ArenaChunk *chunk = arena->chunks;
+    if (!chunk)
+        return;
+
+    while (chunk->next) {
+        ArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    // A chunk created for a single large allocation is not worth keeping
+    if (chunk->size > ARENA_CHUNK_SIZE) {
+        free(chunk);
+        chunk = NULL;
+    } else {
+        chunk->used = 0;
+    }
+
+    arena->chunks = chunk;
+    arena->last = NULL;
+}
+
+// Frees every chunk, the arena stays usable and starts empty
+void arena_destroy(Arena *arena) {
+
+    arena_reset(arena);
+    free(arena->chunks);
+    arena->chunks = NULL;
+}
@@ -0,0 +1,31 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bytes of a chunk, larger allocations get a chunk of their own (e.g. `make CPPFLAGS=-DARENA_CHUNK_SIZE=262144`)
+#ifndef ARENA_CHUNK_SIZE
+#define ARENA_CHUNK_SIZE 65536
+#endif
+
+typedef struct ArenaChunk ArenaChunk;
+
+/**
+ * Bump allocator for the data that lives as long as one request (decoded fields, DAO rows, DTOs).
+ * Every worker thread owns one, so allocating never takes a lock, and nothing taken from it is freed
+ * one by one: the worker resets it after each job. The first chunk is kept across resets,
+ * so a request that fits in it does not call malloc at all.
+ */
+typedef struct {
+    ArenaChunk *chunks;         // Chunk in use, the older ones follow it
+    void *last;                 // Latest allocation, the only one arena_grow() can extend in place
+} Arena;
+
+Arena *arena_thread(void);
+
+void *arena_alloc(Arena *arena, size_t size);
+void *arena_grow(Arena *arena, void *ptr, size_t old_size, size_t new_size);
+void arena_reset(Arena *arena);
+void arena_destroy(Arena *arena);
+
+#endif
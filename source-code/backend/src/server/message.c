@@ -0,0 +1,140 @@
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/debug_log.h"
+
+#include "message.h"
+
+// Free buffers of MESSAGE_POOL_BUFFER_SIZE bytes: messages are built on the workers and released by the reactor
+static Message *pool_head;
+static size_t pool_count;
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Returns an empty message able to hold `capacity` bytes (length prefix included), taken from the pool when it fits.
+ * Its body is written by the caller and closed with message_seal().
+ * @return A message with one reference owned by the caller, `NULL` on failure.
+ */
+Message *message_alloc(size_t capacity) {
+
+    Message *message = NULL;
+
+    if (capacity <= MESSAGE_POOL_BUFFER_SIZE) {
+        capacity = MESSAGE_POOL_BUFFER_SIZE;
+
+        pthread_mutex_lock(&pool_lock);
+        message = pool_head;
+        if (message) {
+            pool_head = message->next_free;
+            pool_count--;
+        }
+        pthread_mutex_unlock(&pool_lock);
+    }
+
+    if (!message) {
+        message = malloc(sizeof(Message) + capacity);
+        if (!message) {
+            LOG_ERROR("%s\n", "malloc() failed for message");
+            return NULL;
+        }
+        message->capacity = capacity;
+    }
+
+    message->len = 0;
+    message->next_free = NULL;
+    atomic_init(&message->refcount, 1);
+
+    return message;
+}
+
+/**
+ * Enlarges a message that is still being written, keeping its content.
+ * @return The moved message, `NULL` on failure (the old one is still valid and owned by the caller).
+ */
+Message *message_grow(Message *message, size_t capacity) {
+
+    if (capacity <= message->capacity)
+        return message;
+
+    Message *grown = realloc(message, sizeof(Message) + capacity);
+    if (!grown) {
+        LOG_ERROR("%s\n", "realloc() failed for message");
+        return NULL;
+    }
+
+    grown->capacity = capacity;
+    return grown;
+}
+
+/**
+ * Writes the length prefix of a body already in place after it, and the terminator of the body.
+ * The message must have room for the prefix, the body and the terminator.
+ */
+int message_seal(Message *message, size_t body_len) {
+
+    if (body_len > UINT32_MAX) {
+        LOG_WARN("Message too large (%zu bytes)\n", body_len);
+        return -1;
+    }
+
+    uint32_t len_net = htonl((uint32_t)body_len);
+    memcpy(message->data, &len_net, sizeof(len_net));
+    message->data[MESSAGE_PREFIX_SIZE + body_len] = '\0';
+    message->len = MESSAGE_PREFIX_SIZE + body_len;
+
+    return 0;
+}
+
+/**
+ * Frames a JSON body once.
+ * @return A message with one reference owned by the caller, `NULL` on failure.
+ */
+Message *message_create(const char *json) {
+
+    if (!json) return NULL;
+
+    size_t body_len = strlen(json);
+
+    Message *message = message_alloc(MESSAGE_PREFIX_SIZE + body_len + 1);
+    if (!message)
+        return NULL;
+
+    memcpy(message->data + MESSAGE_PREFIX_SIZE, json, body_len);
+    if (message_seal(message, body_len) < 0) {
+        message_release(message);
+        return NULL;
+    }
+
+    return message;
+}
+
+Message *message_retain(Message *message) {
+
+    if (message)
+        atomic_fetch_add_explicit(&message->refcount, 1, memory_order_relaxed);
+
+    return message;
+}
+
+// Drops a reference, the last one gives the buffer back to the pool or frees it
+void message_release(Message *message) {
+
+    if (!message || atomic_fetch_sub_explicit(&message->refcount, 1, memory_order_acq_rel) != 1)
+        return;
+
+    if (message->capacity == MESSAGE_POOL_BUFFER_SIZE) {
+        pthread_mutex_lock(&pool_lock);
+        if (pool_count < MESSAGE_POOL_CAPACITY) {
+            message->next_free = pool_head;
+            pool_head = message;
+            pool_count++;
+            message = NULL;
+        }
+        pthread_mutex_unlock(&pool_lock);
+    }
+
+    free(message);
+}
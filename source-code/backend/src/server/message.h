@@ -0,0 +1,44 @@
+#ifndef MESSAGE_H
+#define MESSAGE_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Buffers of this size are recycled instead of being freed (e.g. `make CPPFLAGS=-DMESSAGE_POOL_CAPACITY=4096`)
+#ifndef MESSAGE_POOL_BUFFER_SIZE
+#define MESSAGE_POOL_BUFFER_SIZE 4096   // Bytes of a pooled buffer, enough for almost every response
+#endif
+#ifndef MESSAGE_POOL_CAPACITY
+#define MESSAGE_POOL_CAPACITY 1024      // Free buffers kept for reuse, the others are released to malloc
+#endif
+
+#define MESSAGE_PREFIX_SIZE sizeof(uint32_t)
+
+/**
+ * Immutable framed message, ready to be written to any socket: [4 bytes length (big endian)] + [JSON body]
+ * in a single buffer. It is reference counted so the same message can wait in the outbound queues
+ * of many connections (e.g. a lobby-wide broadcast) without being serialized, framed or copied again.
+ * The body is followed by a `\0` that is not sent, so it can be logged as a string.
+ */
+typedef struct Message {
+    atomic_size_t refcount;
+    size_t len;                 // Length prefix + JSON body
+    size_t capacity;            // Bytes available in `data`
+    struct Message *next_free;  // Link in the pool of free buffers
+    char data[];
+} Message;
+
+Message *message_alloc(size_t capacity);
+Message *message_grow(Message *message, size_t capacity);
+int message_seal(Message *message, size_t body_len);
+Message *message_create(const char *json);
+Message *message_retain(Message *message);
+void message_release(Message *message);
+
+// JSON body of the message, as a string
+static inline const char *message_body(const Message *message) {
+    return message->data + MESSAGE_PREFIX_SIZE;
+}
+
+#endif
@@ -1,12 +1,17 @@
 #include <string.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <inttypes.h>
 
 #include "../../include/debug_log.h"
 
+#include "arena.h"
 #include "server.h"
 #include "session_manager.h"
 #include "../json-parser/json-parser.h"
+#include "../dao/sqlite/db_connection_sqlite.h"
 
 #include "../dto/game_dto.h"
 #include "../dto/notification_dto.h"
@@ -22,450 +27,764 @@
 #include "../controllers/player_controller.h"
 #include "../controllers/round_controller.h"
 
+/**
+ * Sessions are not checked by default: the web client restores a login from its local storage
+ * and keeps playing on the new socket without signing in again (e.g. `make CPPFLAGS=-DROUTER_ENFORCE_AUTH=1`).
+ */
+#ifndef ROUTER_ENFORCE_AUTH
+#define ROUTER_ENFORCE_AUTH 0
+#endif
+
+// Operations a single `batch` request may carry (e.g. `make CPPFLAGS=-DBATCH_MAX_OPERATIONS=128`)
+#ifndef BATCH_MAX_OPERATIONS
+#define BATCH_MAX_OPERATIONS 64
+#endif
+
+/* === Dispatch table types === */
+
+// Request keys a route cannot work without, checked before its handler runs
+typedef enum {
+    FIELD_ID_PLAYER                   = 1u << 0,
+    FIELD_ID_GAME                     = 1u << 1,
+    FIELD_ID_ROUND                    = 1u << 2,
+    FIELD_ID_PARTICIPATION_REQUEST    = 1u << 3,
+    FIELD_NICKNAME                    = 1u << 4,
+    FIELD_EMAIL                       = 1u << 5,
+    FIELD_PASSWORD                    = 1u << 6,
+    FIELD_STATUS                      = 1u << 7,
+    FIELD_ID_CREATOR                  = 1u << 8,
+    FIELD_ID_OWNER                    = 1u << 9,
+    FIELD_ID_PLAYER_ACCEPTING_REMATCH = 1u << 10,
+    FIELD_ROW                         = 1u << 11,
+    FIELD_COL                         = 1u << 12,
+    FIELD_ID_PLAYER_ENDING_ROUND      = 1u << 13,
+    FIELD_STATE                       = 1u << 14,
+    FIELD_NEW_STATE                   = 1u << 15,
+    FIELD_ID_SENDER                   = 1u << 16,
+    FIELD_ID_RECEIVER                 = 1u << 17
+} RouteField;
+
+typedef enum {
+    FIELD_TYPE_STRING,
+    FIELD_TYPE_INT64,
+    FIELD_TYPE_INT
+} RouteFieldType;
+
+typedef struct {
+    RouteField field;
+    const char *key;
+    RouteFieldType type;
+    size_t offset;      // Position of the field inside RequestDTO, missing values are `NULL` or `-1`
+} RouteFieldInfo;
+
+static const RouteFieldInfo route_fields[] = {
+    { FIELD_ID_PLAYER,                   "id_player",                   FIELD_TYPE_INT64,  offsetof(RequestDTO, id_player) },
+    { FIELD_ID_GAME,                     "id_game",                     FIELD_TYPE_INT64,  offsetof(RequestDTO, id_game) },
+    { FIELD_ID_ROUND,                    "id_round",                    FIELD_TYPE_INT64,  offsetof(RequestDTO, id_round) },
+    { FIELD_ID_PARTICIPATION_REQUEST,    "id_participation_request",    FIELD_TYPE_INT64,  offsetof(RequestDTO, id_participation_request) },
+    { FIELD_NICKNAME,                    "nickname",                    FIELD_TYPE_STRING, offsetof(RequestDTO, nickname) },
+    { FIELD_EMAIL,                       "email",                       FIELD_TYPE_STRING, offsetof(RequestDTO, email) },
+    { FIELD_PASSWORD,                    "password",                    FIELD_TYPE_STRING, offsetof(RequestDTO, password) },
+    { FIELD_STATUS,                      "status",                      FIELD_TYPE_STRING, offsetof(RequestDTO, status) },
+    { FIELD_ID_CREATOR,                  "id_creator",                  FIELD_TYPE_INT64,  offsetof(RequestDTO, id_creator) },
+    { FIELD_ID_OWNER,                    "id_owner",                    FIELD_TYPE_INT64,  offsetof(RequestDTO, id_owner) },
+    { FIELD_ID_PLAYER_ACCEPTING_REMATCH, "id_player_accepting_rematch", FIELD_TYPE_INT64,  offsetof(RequestDTO, id_player_accepting_rematch) },
+    { FIELD_ROW,                         "row",                         FIELD_TYPE_INT,    offsetof(RequestDTO, row) },
+    { FIELD_COL,                         "col",                         FIELD_TYPE_INT,    offsetof(RequestDTO, col) },
+    { FIELD_ID_PLAYER_ENDING_ROUND,      "id_player_ending_round",      FIELD_TYPE_INT64,  offsetof(RequestDTO, id_player_ending_round) },
+    { FIELD_STATE,                       "state",                       FIELD_TYPE_STRING, offsetof(RequestDTO, state) },
+    { FIELD_NEW_STATE,                   "new_state",                   FIELD_TYPE_STRING, offsetof(RequestDTO, new_state) },
+    { FIELD_ID_SENDER,                   "id_sender",                   FIELD_TYPE_INT64,  offsetof(RequestDTO, id_sender) },
+    { FIELD_ID_RECEIVER,                 "id_receiver",                 FIELD_TYPE_INT64,  offsetof(RequestDTO, id_receiver) },
+};
+
+typedef enum {
+    AUTH_NONE,          // Allowed before signing in
+    AUTH_SESSION        // The connection must belong to a signed in player
+} RouteAuth;
+
+// How the writes of a route behave inside the transaction shared by the operations of a batch
+typedef enum {
+    TX_READ,            // Reads only, it needs no transaction
+    TX_JOIN,            // Its writes can join the batch transaction
+    TX_ALONE            // Writes while holding an in-memory lock (active rounds, rematches): it must commit on its own
+} RouteTransaction;
+
+// Builds the response of an action, `action` is the name the client sent
+typedef Message *(*RouteHandler)(const char *action, const RequestDTO *request, int client_socket);
+
+typedef struct {
+    const char *action;
+    RouteHandler handler;
+    bool persistent;    // `false`: the connection is closed once the response has been written
+    RouteAuth auth;
+    unsigned required;  // RouteField flags
+    RouteTransaction transaction;
+} Route;
+
+// ==================== Private functions ====================
+
+static Message *route_batch(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_player_get_public_info(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_player_signup(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_player_signin(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_games_get_public_info(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_game_start(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_game_end(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_game_forfeit(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_game_refuse_rematch(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_game_accept_rematch(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_game_cancel(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_game_play_bot(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_round_get_public_info(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_round_make_move(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_round_end(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_participation_requests_get_public_info(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_participation_request_send(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_participation_request_change_state(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_participation_request_cancel(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_participation_request_reject_all(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_plays_get_public_info(const char *action, const RequestDTO *request, int client_socket);
+static Message *route_notification_rematch_game(const char *action, const RequestDTO *request, int client_socket);
+
+static const Route *find_route(const char *action);
+static Message *dispatch_request(const RequestDTO *request, int client_socket, bool in_batch, int *persistence);
+static bool batch_needs_transaction(const RequestDTO *request);
+static void broadcast_game_updated(int64_t id_game, int64_t id_sender);
+static const RouteFieldInfo *missing_field(const RequestDTO *request, unsigned required);
+
+// ===========================================================
+
+/**
+ * Every action the server accepts, sorted by name so that each request finds its route with a binary search.
+ * A new action is one more row here, in its sorted place.
+ */
+static const Route routes[] = {
+    { "batch",                                  route_batch,                                  true,  AUTH_NONE,    0,                                                        TX_READ },
+    { "game_accept_rematch",                    route_game_accept_rematch,                    true,  AUTH_SESSION, FIELD_ID_GAME | FIELD_ID_PLAYER_ACCEPTING_REMATCH,        TX_ALONE },
+    { "game_cancel",                            route_game_cancel,                            true,  AUTH_SESSION, FIELD_ID_GAME | FIELD_ID_OWNER,                           TX_JOIN },
+    { "game_end",                               route_game_end,                               true,  AUTH_SESSION, FIELD_ID_GAME | FIELD_ID_OWNER,                           TX_JOIN },
+    { "game_forfeit",                           route_game_forfeit,                           true,  AUTH_SESSION, FIELD_ID_GAME | FIELD_ID_PLAYER,                          TX_ALONE },
+    { "game_play_bot",                          route_game_play_bot,                          true,  AUTH_SESSION, FIELD_ID_GAME | FIELD_ID_OWNER,                           TX_ALONE },
+    { "game_refuse_rematch",                    route_game_refuse_rematch,                    true,  AUTH_SESSION, FIELD_ID_GAME,                                            TX_ALONE },
+    { "game_start",                             route_game_start,                             true,  AUTH_SESSION, FIELD_ID_CREATOR,                                         TX_JOIN },
+    { "games_get_public_info",                  route_games_get_public_info,                  true,  AUTH_NONE,    FIELD_STATUS,                                             TX_READ },
+    { "notification_rematch_game",              route_notification_rematch_game,              true,  AUTH_SESSION, FIELD_ID_GAME | FIELD_ID_SENDER | FIELD_ID_RECEIVER,      TX_READ },
+    { "participation_request_cancel",           route_participation_request_cancel,           true,  AUTH_SESSION, FIELD_ID_PARTICIPATION_REQUEST | FIELD_ID_PLAYER,         TX_JOIN },
+    { "participation_request_change_state",     route_participation_request_change_state,     true,  AUTH_SESSION, FIELD_ID_PARTICIPATION_REQUEST | FIELD_NEW_STATE,         TX_ALONE },
+    { "participation_request_reject_all",       route_participation_request_reject_all,       true,  AUTH_SESSION, 0,                                                        TX_JOIN },
+    { "participation_request_send",             route_participation_request_send,             true,  AUTH_SESSION, FIELD_ID_GAME | FIELD_ID_PLAYER,                          TX_JOIN },
+    { "participation_requests_get_public_info", route_participation_requests_get_public_info, true,  AUTH_NONE,    FIELD_STATE,                                              TX_READ },
+    { "player_get_public_info",                 route_player_get_public_info,                 true,  AUTH_NONE,    FIELD_NICKNAME,                                           TX_READ },
+    { "player_signin",                          route_player_signin,                          true,  AUTH_NONE,    FIELD_NICKNAME | FIELD_PASSWORD,                          TX_READ },
+    { "player_signup",                          route_player_signup,                          false, AUTH_NONE,    FIELD_NICKNAME | FIELD_EMAIL | FIELD_PASSWORD,            TX_JOIN },
+    { "plays_get_public_info",                  route_plays_get_public_info,                  true,  AUTH_NONE,    0,                                                        TX_READ },
+    { "round_end",                              route_round_end,                              true,  AUTH_SESSION, FIELD_ID_ROUND | FIELD_ID_PLAYER_ENDING_ROUND,            TX_ALONE },
+    { "round_get_public_info",                  route_round_get_public_info,                  true,  AUTH_NONE,    FIELD_ID_ROUND,                                           TX_READ },
+    { "round_make_move",                        route_round_make_move,                        true,  AUTH_SESSION, FIELD_ID_ROUND | FIELD_ID_PLAYER | FIELD_ROW | FIELD_COL, TX_ALONE },
+};
+
+static int compare_route(const void *key, const void *route) {
+    return strcmp((const char *)key, ((const Route *)route)->action);
+}
+
+// Route of an action, `NULL` if the server does not know it
+static const Route *find_route(const char *action) {
+    return action ? bsearch(action, routes, sizeof(routes) / sizeof(routes[0]), sizeof(Route), compare_route) : NULL;
+}
+
 void route_request(const char* json_body, int client_socket, int* persistence) {
 
     LOG_DEBUG("Received JSON: '%s'\n", json_body);
 
-    char *action = extract_string_from_json(json_body, "action");
+    /* === Decoded request === */
+
+    // The body is parsed once, every handler reads its input from this struct
+    RequestDTO request;
+    decode_request_from_json(json_body, &request);
+
+    /* === Router === */
+
+    Message *json_response = dispatch_request(&request, client_socket, false, persistence);
+
+
+    /* === Send response === */
+
+    if (json_response) {
+        LOG_DEBUG("Server Router Response successfully built: %s\n", message_body(json_response));
+        if (send_server_response(client_socket, json_response) < 0) {
+            LOG_WARN("Error sending the Server Router Response to Client socket %d\n", client_socket);
+        } else {
+            LOG_DEBUG("Server Router Response sent: Client socket %d \n", client_socket);
+        }
+    } else {
+        LOG_WARN("%s\n", "JSON response is empty");
+    }
+
+
+    /* === Free dynamically allocated variables (the DTOs come from the arena, reset once the request is done) */
+
+    free_request_dto(&request);
 
-    *persistence = 1; 
+    if (json_response)
+        message_release(json_response);
+}
+
+/**
+ * Finds the route of a request, checks it and runs its handler.
+ * Operations of a batch cannot be a batch themselves, nor close the connection.
+ * @param persistence is set to `0` when the connection must be closed after the response
+ * @return The response, stamped with the `req_id` of the request if it has one.
+ */
+static Message *dispatch_request(const RequestDTO *request, int client_socket, bool in_batch, int *persistence) {
+
+    Message *json_response = NULL;
+    const char *action = request->action;
+
+    *persistence = 1;
 
     if (!action) {
         LOG_WARN("%s\n", "Missing 'action' key in JSON");
-        action = "NULL";
+        json_response = serialize_action_error("NULL", "Missing 'action' key");
+    } else {
+
+        const Route *route = find_route(action);
+        const RouteFieldInfo *missing = route ? missing_field(request, route->required) : NULL;
+
+        bool signed_in = true;
+        if (route && route->auth == AUTH_SESSION) {
+            Session session;
+            signed_in = session_find_by_fd(&session_manager, client_socket, &session);
+            if (!signed_in)
+                LOG_DEBUG("Action \"%s\" from client socket %d without a session\n", action, client_socket);
+        }
+
+        if (!route) {
+            json_response = serialize_action_error(action, "Action not recognized");
+        } else if (in_batch && (route->handler == route_batch || !route->persistent)) {
+            json_response = serialize_action_error(action, "Action not allowed in a batch");
+        } else if (ROUTER_ENFORCE_AUTH && !signed_in) {
+            json_response = serialize_action_error(action, "Player not signed in");
+        } else if (missing) {
+            char error_message[64];
+            snprintf(error_message, sizeof(error_message), "Missing '%s' key", missing->key);
+            json_response = serialize_action_error(action, error_message);
+        } else {
+            json_response = route->handler(action, request, client_socket);
+        }
+
+        if (route && !route->persistent && !in_batch)
+            *persistence = 0;
+    }
+
+    if (json_response && request->req_id >= 0)
+        json_response = add_req_id_to_json(json_response, request->req_id);
+
+    return json_response;
+}
+
+// First field of `required` the request does not carry, `NULL` if it has all of them
+static const RouteFieldInfo *missing_field(const RequestDTO *request, unsigned required) {
+
+    for (size_t i = 0; required != 0 && i < sizeof(route_fields) / sizeof(route_fields[0]); i++) {
+
+        const RouteFieldInfo *info = &route_fields[i];
+        if (!(required & info->field))
+            continue;
+
+        const char *slot = (const char *)request + info->offset;
+        bool present;
+        switch (info->type) {
+            case FIELD_TYPE_STRING: present = *(const char *const *)slot != NULL; break;
+            case FIELD_TYPE_INT64:  present = *(const int64_t *)slot != -1; break;
+            default:                present = *(const int *)slot != -1; break;
+        }
+
+        if (!present)
+            return info;
     }
 
-    /* === Extracted value === */
+    return NULL;
+}
 
-    int64_t id_player = extract_int_from_json(json_body, "id_player");
-    int64_t id_game = extract_int_from_json(json_body, "id_game");
-    int64_t id_round = extract_int_from_json(json_body, "id_round");
-    int64_t id_participation_request = extract_int_from_json(json_body, "id_participation_request");
-    
-    // Player controller input
-    char *nickname = extract_string_from_json(json_body, "nickname");
-    char *email = extract_string_from_json(json_body, "email");
-    char *password = extract_string_from_json(json_body, "password");
+// Sends the current state of a game to every other player in the lobby
+static void broadcast_game_updated(int64_t id_game, int64_t id_sender) {
+
+    Game updatedGame;
+    if (game_find_one(id_game, &updatedGame) != GAME_CONTROLLER_OK)
+        return;
+
+    GameWithPlayerNickname info;
+    if (game_find_one_with_player_info(id_game, &info) != GAME_CONTROLLER_OK)
+        return;
+
+    GameDTO dto;
+    map_game_with_streak_to_dto(
+        &updatedGame,
+        info.creator,
+        info.owner,
+        info.owner_current_streak,
+        info.owner_max_streak,
+        &dto
+    );
+
+    Message *json_broadcast = serialize_game_with_streak_to_json("server_game_updated", &dto);
+    send_server_broadcast_message(json_broadcast, id_sender);
+    message_release(json_broadcast);
+}
+
+/* === Batch route === */
+
+// A shared transaction is worth opening when some operation writes and none of them has to commit on its own
+static bool batch_needs_transaction(const RequestDTO *request) {
+
+    bool writes = false;
+
+    for (size_t i = 0; i < request->operations_count; i++) {
+
+        const Route *route = find_route(request->operations[i].action);
+        if (!route)
+            continue;
+
+        if (route->transaction == TX_ALONE)
+            return false;
+        if (route->transaction == TX_JOIN)
+            writes = true;
+    }
 
-    // Game controller input
-    char *status = extract_string_from_json(json_body, "status");
-    int64_t id_creator = extract_int_from_json(json_body, "id_creator");
-    int64_t id_owner = extract_int_from_json(json_body, "id_owner");
-    int64_t id_player_accepting_rematch = extract_int_from_json(json_body, "id_player_accepting_rematch");
+    return writes;
+}
 
-    // Round controller input
-    int row = extract_int_from_json(json_body, "row");
-    int col = extract_int_from_json(json_body, "col");
-    int64_t id_player_ending_round = extract_int_from_json(json_body, "id_player_ending_round");
+/**
+ * Runs the operations of the request one after the other and answers with all their responses in one frame.
+ * The operations keep their own `req_id`.
+ * Their writes share a single transaction when they can: the controllers join it instead of committing each.
+ * Then the batch is all or nothing: once a writing operation answers with an error, the transaction is rolled
+ * back and the operations after it are not run. The notifications of the operations are held back meanwhile,
+ * sent once the transaction is committed and dropped if it is rolled back.
+ */
+static Message *route_batch(const char *action, const RequestDTO *request, int client_socket) {
 
-    // Participation Request controller input
-    char *state = extract_string_from_json(json_body, "state");
-    char *new_state = extract_string_from_json(json_body, "new_state");
+    if (request->operations_count == 0)
+        return serialize_action_error(action, "Missing 'operations' key");
+    if (request->operations_count > BATCH_MAX_OPERATIONS)
+        return serialize_action_error(action, "Too many operations");
 
-    int out_requests_count;
-    ParticipationRequest *requests = extract_requests_array_from_json(json_body, &out_requests_count);
+    Message **results = arena_alloc(arena_thread(), sizeof(Message *) * request->operations_count);
+    if (!results)
+        return serialize_action_error(action, "Internal error");
 
-    // Notification controller input
-    int64_t id_sender = extract_int_from_json(json_body, "id_sender");
-    int64_t id_receiver = extract_int_from_json(json_body, "id_receiver");
+    sqlite3 *db = batch_needs_transaction(request) ? db_transaction_begin() : NULL;
+    bool transactional = db != NULL;
+    bool rolled_back = false;
 
-    /* === Result value === */
-        int out_count = 0;
+    if (transactional)
+        server_notifications_defer();
+
+    for (size_t i = 0; i < request->operations_count; i++) {
+
+        const RequestDTO *operation = &request->operations[i];
+
+        if (rolled_back) {
+            results[i] = serialize_action_error(operation->action ? operation->action : "NULL", "Not run, the batch was rolled back");
+            if (results[i] && operation->req_id >= 0)
+                results[i] = add_req_id_to_json(results[i], operation->req_id);
+            continue;
+        }
+
+        int persistence;
+        results[i] = dispatch_request(operation, client_socket, true, &persistence);
+
+        const Route *route = find_route(operation->action);
+        if (transactional && route && route->persistent && route->transaction == TX_JOIN && (!results[i] || is_error_response(results[i]))) {
+            db_transaction_rollback(db);
+            rolled_back = true;
+        }
+    }
+
+    if (transactional && !rolled_back && db_transaction_commit(db) < 0)
+        rolled_back = true;
+
+    if (transactional)
+        server_notifications_flush(!rolled_back);
+
+    const char *error_message = NULL;
+    if (rolled_back) {
+        LOG_WARN("Batch of %zu operations from client socket %d rolled back\n", request->operations_count, client_socket);
+        error_message = "Batch rolled back";
+    }
+
+    Message *json_response = serialize_batch_to_json(action, results, request->operations_count, error_message);
+
+    for (size_t i = 0; i < request->operations_count; i++) {
+        if (results[i])
+            message_release(results[i]);
+    }
+
+    return json_response;
+}
+
+/* === Player routes === */
+
+static Message *route_player_get_public_info(const char *action, const RequestDTO *request, int client_socket) {
+
+    (void)client_socket;
+
+    PlayerDTO *out_player = NULL;
+    int out_count = 0;
+
+    PlayerControllerStatus playerStatus = player_get_public_info(request->nickname, &out_player, &out_count);
+    if (playerStatus == PLAYER_CONTROLLER_OK || playerStatus == PLAYER_CONTROLLER_NOT_FOUND)
+        return serialize_players_to_json(action, out_player, out_count);
+
+    return serialize_action_error(action, return_player_controller_status_to_string(playerStatus));
+}
+
+static Message *route_player_signup(const char *action, const RequestDTO *request, int client_socket) {
+
+    (void)client_socket;
+
+    PlayerControllerStatus playerStatus = player_signup(request->nickname, request->email, request->password);
+    if (playerStatus == PLAYER_CONTROLLER_OK) {
+        return serialize_action_success(action, "Player signed up", -1);
+    } else if (playerStatus == PLAYER_CONTROLLER_INVALID_INPUT) {
+        return serialize_action_error(action, "Invalid input values");
+    } else if (playerStatus == PLAYER_CONTROLLER_STATE_VIOLATION_NICKNAME) {
+        return serialize_action_error(action, "Nickname already used");
+    } else if (playerStatus == PLAYER_CONTROLLER_STATE_VIOLATION_EMAIL) {
+        return serialize_action_error(action, "Email already used");
+    }
+
+    return serialize_action_error(action, return_player_controller_status_to_string(playerStatus));
+}
+
+static Message *route_player_signin(const char *action, const RequestDTO *request, int client_socket) {
 
-    // Player controller output
     bool out_signedIn = false;
     int64_t out_id_player = -1;
-    PlayerDTO *out_player = NULL;
-    
-    // Game controller output
-    int64_t out_id_game = -1;
+
+    PlayerControllerStatus playerStatus = player_signin(request->nickname, request->password, &out_signedIn, &out_id_player);
+    if (playerStatus == PLAYER_CONTROLLER_OK) {
+        if (!out_signedIn)
+            return serialize_action_error(action, "Log in failed");
+
+        // We add a session if the user logged in succesfully
+        session_add(&session_manager, client_socket, out_id_player, request->nickname);
+        LOG_INFO("Player \"%s\" (id_player %" PRId64 ") has been added in session list", request->nickname, out_id_player);
+
+        return serialize_action_success(action, "Player signed in", out_id_player);
+    } else if (playerStatus == PLAYER_CONTROLLER_INVALID_INPUT) {
+        return serialize_action_error(action, "Invalid input values");
+    }
+
+    return serialize_action_error(action, return_player_controller_status_to_string(playerStatus));
+}
+
+/* === Game routes === */
+
+static Message *route_games_get_public_info(const char *action, const RequestDTO *request, int client_socket) {
+
+    (void)client_socket;
+
     GameDTO *out_games = NULL;
+    int out_count = 0;
 
-    // Round controller output
-    int64_t out_id_round = -1;
-    RoundDTO *out_round = NULL;
+    GameControllerStatus gameStatus = games_get_public_info(request->status, &out_games, &out_count);
+    if (gameStatus == GAME_CONTROLLER_OK || gameStatus == GAME_CONTROLLER_NOT_FOUND) {
+        return serialize_games_with_streak_to_json(action, out_games, out_count);
+    } else if (gameStatus == GAME_CONTROLLER_INVALID_INPUT) {
+        return serialize_action_error(action, "Invalid input values");
+    }
 
-    // Participation Request controller output
-    int64_t out_id_participation_request = -1;
-    ParticipationRequestDTO *out_participation_requests = NULL;
+    return serialize_action_error(action, return_game_controller_status_to_string(gameStatus));
+}
 
-    // Play controller output
-    PlayDTO *out_plays = NULL;
+static Message *route_game_start(const char *action, const RequestDTO *request, int client_socket) {
 
-    // Notification controller output
-    NotificationDTO *out_notification = NULL;
+    (void)client_socket;
 
+    int64_t out_id_game = -1;
 
-    /* === Router === */
+    GameControllerStatus gameStatus = game_start(request->id_creator, request->board_size, request->win_length, &out_id_game);
+    if (gameStatus == GAME_CONTROLLER_OK) {
+        return serialize_action_success(action, "Game started", out_id_game);
+    } else if (gameStatus == GAME_CONTROLLER_INVALID_INPUT) {
+        return serialize_action_error(action, "Invalid board size or win length");
+    }
 
-    char *json_response = NULL;
+    return serialize_action_error(action, return_game_controller_status_to_string(gameStatus));
+}
 
-    if (strcmp(action, "NULL") == 0) {
-        json_response = serialize_action_error(action, "Missing 'action' key");
-    } else
+static Message *route_game_end(const char *action, const RequestDTO *request, int client_socket) {
 
-    // Player routes
-    if (strcmp(action, "player_get_public_info") == 0) {
-        PlayerControllerStatus playerStatus = player_get_public_info(nickname, &out_player, &out_count);
-        if (playerStatus == PLAYER_CONTROLLER_OK || playerStatus == PLAYER_CONTROLLER_NOT_FOUND) {
-            json_response = serialize_players_to_json(action, out_player, out_count);
-        } else {
-            json_response = serialize_action_error(action, return_player_controller_status_to_string(playerStatus));
-        }
+    (void)client_socket;
 
-    } else if (strcmp(action, "player_signup") == 0) {
-        PlayerControllerStatus playerStatus = player_signup(nickname, email, password);
-        if (playerStatus == PLAYER_CONTROLLER_OK) {
-            json_response = serialize_action_success(action, "Player signed up", -1);
-        } else if (playerStatus == PLAYER_CONTROLLER_INVALID_INPUT) {
-            json_response = serialize_action_error(action, "Invalid input values");
-        } else if (playerStatus == PLAYER_CONTROLLER_STATE_VIOLATION_NICKNAME) {
-            json_response = serialize_action_error(action, "Nickname already used");
-        } else if (playerStatus == PLAYER_CONTROLLER_STATE_VIOLATION_EMAIL) {
-            json_response = serialize_action_error(action, "Email already used");
-        } else {
-            json_response = serialize_action_error(action, return_player_controller_status_to_string(playerStatus));
-        }
+    int64_t out_id_game = -1;
 
-        *persistence = 0;
+    GameControllerStatus gameStatus = game_end(request->id_game, request->id_owner, &out_id_game);
+    if (gameStatus == GAME_CONTROLLER_OK) {
+        Message *json_response = serialize_action_success(action, "Game closed", out_id_game);
+        broadcast_game_updated(request->id_game, request->id_owner);
+        return json_response;
+    } else if (gameStatus == GAME_CONTROLLER_FORBIDDEN) {
+        return serialize_action_error(action, "Action not allowed");
+    }
 
-    } else if (strcmp(action, "player_signin") == 0) {
-        PlayerControllerStatus playerStatus = player_signin(nickname, password, &out_signedIn, &out_id_player);
-        if (playerStatus == PLAYER_CONTROLLER_OK) {
-            if (out_signedIn == true) {
-                json_response = serialize_action_success(action, "Player signed in", out_id_player);
+    return serialize_action_error(action, return_game_controller_status_to_string(gameStatus));
+}
 
-                // We add a session if the user logged in succesfully
-                session_add(&session_manager, client_socket, out_id_player, nickname);
-                LOG_INFO("Player \"%s\" (id_player %" PRId64 ") has been added in session list", nickname, out_id_player);
+static Message *route_game_forfeit(const char *action, const RequestDTO *request, int client_socket) {
 
-            } else
-                json_response = serialize_action_error(action, "Log in failed");
-        } else if (playerStatus == PLAYER_CONTROLLER_INVALID_INPUT) {
-            json_response = serialize_action_error(action, "Invalid input values");
-        } else {
-            json_response = serialize_action_error(action, return_player_controller_status_to_string(playerStatus));
-        }
+    (void)client_socket;
 
-    } else 
+    int64_t winner = -1;
 
-    // Game routes
-    if (strcmp(action, "games_get_public_info") == 0) {
-        GameControllerStatus gameStatus = games_get_public_info(status, &out_games, &out_count);
-        if (gameStatus == GAME_CONTROLLER_OK || gameStatus == GAME_CONTROLLER_NOT_FOUND) {
-            json_response = serialize_games_with_streak_to_json(action, out_games, out_count);
-        } else if (gameStatus == GAME_CONTROLLER_INVALID_INPUT) {
-            json_response = serialize_action_error(action, "Invalid input values");
-        } else {
-            json_response = serialize_action_error(action, return_game_controller_status_to_string(gameStatus));
-        }
+    GameControllerStatus gameStatus = game_forfeit(request->id_game, request->id_player, &winner);
+    if (gameStatus == GAME_CONTROLLER_OK) {
 
-    } else if (strcmp(action, "game_start") == 0) {
-        GameControllerStatus gameStatus = game_start(id_creator, &out_id_game);
-        if (gameStatus == GAME_CONTROLLER_OK) {
-            json_response = serialize_action_success(action, "Game started", out_id_game);
-        } else {
-            json_response = serialize_action_error(action, return_game_controller_status_to_string(gameStatus));
+        NotificationDTO *out_notification = NULL;
+        if (notification_game_forfeit(request->id_game, winner, request->id_sender, &out_notification) == NOTIFICATION_CONTROLLER_OK) {
+            Message *json_notification = serialize_notification_to_json("server_game_forfeit_notification", out_notification);
+            send_server_unicast_message(json_notification, winner);
+            message_release(json_notification);
         }
 
-    } else if (strcmp(action, "game_end") == 0) {
+        Message *json_response = serialize_action_success(action, "Game forfeited", winner);
+        broadcast_game_updated(request->id_game, request->id_owner);
+        return json_response;
 
-        GameControllerStatus gameStatus = game_end(id_game, id_owner, &out_id_game);
-        if (gameStatus == GAME_CONTROLLER_OK) {
+    } else if (gameStatus == GAME_CONTROLLER_FORBIDDEN) {
+        return serialize_action_error(action, "Action not allowed");
+    }
 
-            json_response = serialize_action_success(action, "Game closed", out_id_game);
+    return serialize_action_error(action, return_game_controller_status_to_string(gameStatus));
+}
 
-            Game updatedGame;
-            if (game_find_one(id_game, &updatedGame) == GAME_CONTROLLER_OK) {
+// Sent by the player who got the rematch notification
+static Message *route_game_refuse_rematch(const char *action, const RequestDTO *request, int client_socket) {
 
-                GameWithPlayerNickname info;
-                if (game_find_one_with_player_info(id_game, &info) == GAME_CONTROLLER_OK) {
+    (void)client_socket;
 
-                    GameDTO dto;
-                    map_game_with_streak_to_dto(
-                        &updatedGame,
-                        info.creator,
-                        info.owner,
-                        info.owner_current_streak,
-                        info.owner_max_streak,
-                        &dto
-                    );
+    int64_t out_id_game = -1;
 
-                    char *json_broadcast = serialize_game_with_streak_to_json("server_game_updated", &dto);
+    GameControllerStatus gameStatus = game_refuse_rematch(request->id_game, &out_id_game);
+    if (gameStatus == GAME_CONTROLLER_OK)
+        return serialize_action_success(action, "Rematch refused", out_id_game);
 
-                    send_server_broadcast_message(json_broadcast, id_owner);
+    return serialize_action_error(action, return_game_controller_status_to_string(gameStatus));
+}
 
-                    free(json_broadcast);
-                }
-            }
+static Message *route_game_accept_rematch(const char *action, const RequestDTO *request, int client_socket) {
 
-        } else if (gameStatus == GAME_CONTROLLER_FORBIDDEN) {
-            json_response = serialize_action_error(action, "Action not allowed");
-        } else {
-            json_response = serialize_action_error(action, return_game_controller_status_to_string(gameStatus));
-        }
-        
-    } else if (strcmp(action, "game_forfeit") == 0) {
-
-        int64_t winner = -1;
-
-        GameControllerStatus gameStatus = game_forfeit(
-            id_game,
-            id_player,
-            &winner
-        );
-
-        if (gameStatus == GAME_CONTROLLER_OK) {
-
-            NotificationDTO *out_notification = NULL;
-            if (notification_game_forfeit(id_game, winner, id_sender, &out_notification) == NOTIFICATION_CONTROLLER_OK) {
-                char *json_notification = serialize_notification_to_json(
-                    "server_game_forfeit_notification",
-                    out_notification
-                );
-                send_server_unicast_message(json_notification, winner);
-                free(json_notification);
-                free(out_notification);
-            }
-
-            json_response = serialize_action_success(
-                action,
-                "Game forfeited",
-                winner
-            );
-
-            Game updatedGame;
-            if (game_find_one(id_game, &updatedGame) == GAME_CONTROLLER_OK) {
-
-                GameWithPlayerNickname info;
-                if (game_find_one_with_player_info(id_game, &info) == GAME_CONTROLLER_OK) {
-
-                    GameDTO dto;
-                    map_game_with_streak_to_dto(
-                        &updatedGame,
-                        info.creator,
-                        info.owner,
-                        info.owner_current_streak,
-                        info.owner_max_streak,
-                        &dto
-                    );
-
-                    char *json_broadcast = serialize_game_with_streak_to_json(
-                        "server_game_updated",
-                        &dto
-                    );
-
-                    send_server_broadcast_message(json_broadcast, id_owner);
-                    free(json_broadcast);
-                }
-            }
-
-        } else if (gameStatus == GAME_CONTROLLER_FORBIDDEN) {
-
-            json_response = serialize_action_error(
-                action,
-                "Action not allowed"
-            );
+    (void)client_socket;
 
-        } else {
+    int64_t out_id_game = -1;
+    int waiting = 0;
 
-            json_response = serialize_action_error(
-                action,
-                return_game_controller_status_to_string(gameStatus)
-            );
-        }
+    GameControllerStatus gameStatus = game_accept_rematch(request->id_game, request->id_player_accepting_rematch, &out_id_game, &waiting);
+    if (gameStatus == GAME_CONTROLLER_OK) {
+        const char *msg = waiting ? "Waiting for opponent" : "Rematch accepted";
+        return serialize_action_success_with_waiting(action, msg, out_id_game, waiting);
+    }
 
-    } else if (strcmp(action, "game_refuse_rematch") == 0) { // Sent by the player who got the rematch notification
-        GameControllerStatus gameStatus = game_refuse_rematch(id_game, &out_id_game);
-        if (gameStatus == GAME_CONTROLLER_OK) {
-            json_response = serialize_action_success(action, "Rematch refused", out_id_game);
-        } else {
-            json_response = serialize_action_error(action, return_game_controller_status_to_string(gameStatus));
-        }
+    return serialize_action_error(action, return_game_controller_status_to_string(gameStatus));
+}
 
-    } else if (strcmp(action, "game_accept_rematch") == 0) {
-        int waiting = 0;
-        GameControllerStatus gameStatus = game_accept_rematch(id_game, id_player_accepting_rematch, &out_id_game, &waiting);
-        if (gameStatus == GAME_CONTROLLER_OK) {
-            const char *msg = waiting ? "Waiting for opponent" : "Rematch accepted";
-            json_response = serialize_action_success_with_waiting(action, msg, out_id_game, waiting);
-        } else {
-            json_response = serialize_action_error(action, return_game_controller_status_to_string(gameStatus));
-        }
+// Sent by the game creator, accepted if the game has no round finished
+static Message *route_game_cancel(const char *action, const RequestDTO *request, int client_socket) {
 
-    } else if (strcmp(action, "game_cancel") == 0) { // Sent by the game creator, accepted if the game has no round finished
-        LOG_DEBUG("ID_GAME: %" PRId64 ", ID_OWNER: %" PRId64 "\n", id_game, id_owner);
-        GameControllerStatus gameStatus = game_cancel(id_game, id_owner, &out_id_game);
-        if (gameStatus == GAME_CONTROLLER_OK) {
-            json_response = serialize_action_success(action, "Game canceled", out_id_game);
-        } else {
-            json_response = serialize_action_error(action, return_game_controller_status_to_string(gameStatus));
-        }
+    (void)client_socket;
 
-    } else 
+    int64_t out_id_game = -1;
 
-    // Round routes
-    if (strcmp(action, "round_get_public_info") == 0) {
-        RoundControllerStatus roundStatus = round_get_public_info(id_round, &out_round, &out_count);
-        if (roundStatus == ROUND_CONTROLLER_OK || roundStatus == ROUND_CONTROLLER_NOT_FOUND) {
-            json_response = serialize_rounds_to_json(action, out_round, out_count);
-        } else {
-            json_response = serialize_action_error(action, return_round_controller_status_to_string(roundStatus));
-        }
+    LOG_DEBUG("ID_GAME: %" PRId64 ", ID_OWNER: %" PRId64 "\n", request->id_game, request->id_owner);
+    GameControllerStatus gameStatus = game_cancel(request->id_game, request->id_owner, &out_id_game);
+    if (gameStatus == GAME_CONTROLLER_OK)
+        return serialize_action_success(action, "Game canceled", out_id_game);
 
-    } else if (strcmp(action, "round_make_move") == 0) { // Sent by one of the players in the round
-        RoundControllerStatus roundStatus = round_make_move(id_round, id_player, row, col, &out_id_round);
-        if (roundStatus == ROUND_CONTROLLER_OK) {
-            json_response = serialize_action_success(action, "Move registered", out_id_round);
-        } else if (roundStatus == ROUND_CONTROLLER_STATE_VIOLATION) {
-            json_response = serialize_action_error(action, "Not an active round");
-        } else if (roundStatus == ROUND_CONTROLLER_FORBIDDEN) {
-            json_response = serialize_action_error(action, "Action not allowed");
-        } else if (roundStatus == ROUND_CONTROLLER_INVALID_INPUT) {
-            json_response = serialize_action_error(action, "Invalid input values");
-        } else {
-            json_response = serialize_action_error(action, return_round_controller_status_to_string(roundStatus));
-        }
+    return serialize_action_error(action, return_game_controller_status_to_string(gameStatus));
+}
 
-    } else if (strcmp(action, "round_end") == 0) { // Sent by one of the players in the round
-        RoundControllerStatus roundStatus = round_end(id_round, id_player_ending_round, &out_id_round);
-        if (roundStatus == ROUND_CONTROLLER_OK) {
-            json_response = serialize_action_success(action, "Round closed", out_id_round);
-        } else {
-            json_response = serialize_action_error(action, return_round_controller_status_to_string(roundStatus));
-        }
+// Sent by the game owner, starts a round against the server bot
+static Message *route_game_play_bot(const char *action, const RequestDTO *request, int client_socket) {
 
-    } else
+    (void)client_socket;
 
-    // Participation Request routes
-    if (strcmp(action, "participation_requests_get_public_info") == 0) {
-        ParticipationRequestControllerStatus participationRequestStatus = participation_requests_get_public_info(state, id_game, &out_participation_requests, &out_count);
-        if (participationRequestStatus == PARTICIPATION_REQUEST_CONTROLLER_OK || participationRequestStatus == PARTICIPATION_REQUEST_CONTROLLER_NOT_FOUND) {
-            json_response = serialize_participation_requests_to_json(action, out_participation_requests, out_count);
-        } else if (participationRequestStatus == PARTICIPATION_REQUEST_CONTROLLER_INVALID_INPUT) {
-            json_response = serialize_action_error(action, "Invalid input values");
-        } else {
-            json_response = serialize_action_error(action, return_participation_request_controller_status_to_string(participationRequestStatus));
-        }
+    int64_t out_id_round = -1;
 
-    } else if (strcmp(action, "participation_request_send") == 0) {
-        ParticipationRequestControllerStatus participationRequestStatus = participation_request_send(id_game, id_player, &out_id_participation_request);
-        if (participationRequestStatus == PARTICIPATION_REQUEST_CONTROLLER_OK) {
-            json_response = serialize_action_success(action, "Participation request sent", out_id_participation_request);
-        } else {
-            json_response = serialize_action_error(action, return_participation_request_controller_status_to_string(participationRequestStatus));
-        }
+    GameControllerStatus gameStatus = game_play_bot(request->id_game, request->id_owner, &out_id_round);
+    if (gameStatus == GAME_CONTROLLER_OK) {
+        return serialize_action_success(action, "Round against the bot started", out_id_round);
+    } else if (gameStatus == GAME_CONTROLLER_STATE_VIOLATION) {
+        return serialize_action_error(action, "Game is not waiting for a player");
+    }
 
-    } else if (strcmp(action, "participation_request_change_state") == 0) { // Sent by the game owner
-        ParticipationRequestControllerStatus participationRequestStatus = participation_request_change_state(id_participation_request, new_state, &out_id_participation_request);
-        if (participationRequestStatus == PARTICIPATION_REQUEST_CONTROLLER_OK) {
-            json_response = serialize_action_success(action, "Participation request state changed", out_id_participation_request);
-        } else if (participationRequestStatus == PARTICIPATION_REQUEST_CONTROLLER_INVALID_INPUT) {
-            json_response = serialize_action_error(action, "Invalid input values");
-        } else {
-            json_response = serialize_action_error(action, return_participation_request_controller_status_to_string(participationRequestStatus));
-        }
+    return serialize_action_error(action, return_game_controller_status_to_string(gameStatus));
+}
 
-    } else if (strcmp(action, "participation_request_cancel") == 0) { // Sent by the participation request sender
-        ParticipationRequestControllerStatus participationRequestStatus = participation_request_cancel(id_participation_request, id_player, &out_id_participation_request);
-        if (participationRequestStatus == PARTICIPATION_REQUEST_CONTROLLER_OK) {
-            json_response = serialize_action_success(action, "Participation request canceled", out_id_participation_request);
-        } else {
-            json_response = serialize_action_error(action, return_participation_request_controller_status_to_string(participationRequestStatus));
-        }
+/* === Round routes === */
 
-    } else if (strcmp(action, "participation_request_reject_all") == 0) { // Sent by the game owner
+static Message *route_round_get_public_info(const char *action, const RequestDTO *request, int client_socket) {
 
-        ParticipationRequestControllerStatus participationRequestStatus = participation_request_reject_all(requests, out_requests_count);
-        if (participationRequestStatus == PARTICIPATION_REQUEST_CONTROLLER_OK) {
-            json_response = serialize_action_success(action, "All Participation requests rejected", out_id_participation_request);
-        } else {
-            json_response = serialize_action_error(action, return_participation_request_controller_status_to_string(participationRequestStatus));
-        }
+    (void)client_socket;
 
-    } else
+    RoundDTO *out_round = NULL;
+    int out_count = 0;
 
-    // Play routes
-    if (strcmp(action, "plays_get_public_info") == 0) {
-        PlayControllerStatus playStatus = plays_get_public_info(id_player, id_round, &out_plays, &out_count);
-        if (playStatus == PLAY_CONTROLLER_OK || playStatus == PLAY_CONTROLLER_NOT_FOUND) {
-            json_response = serialize_plays_to_json(action, out_plays, out_count);
-        } else {
-            json_response = serialize_action_error(action, return_play_controller_status_to_string(playStatus));
-        }
+    RoundControllerStatus roundStatus = round_get_public_info(request->id_round, &out_round, &out_count);
+    if (roundStatus == ROUND_CONTROLLER_OK || roundStatus == ROUND_CONTROLLER_NOT_FOUND)
+        return serialize_rounds_to_json(action, out_round, out_count);
 
-    } else
-    
-    // Notification routes
-    if (strcmp(action, "notification_rematch_game") == 0) { // Sent by the game owner
-        NotificationControllerStatus notificationStatus = notification_rematch_game(id_game, id_sender, id_receiver, &out_notification);
-        if (notificationStatus == NOTIFICATION_CONTROLLER_OK) {
-            char *json_message = serialize_notification_to_json(NULL, out_notification);
-            if (send_server_unicast_message(json_message, id_receiver) < 0 ) {
-                json_response = serialize_action_error(action, "Could not send rematch invitation");
-            } else {
-                json_response = serialize_action_success(action, "Rematch invitation sent", -1);
-            }
-            free(json_message);
-        } else {
-            json_response = serialize_action_error(action, return_notification_controller_status_to_string(notificationStatus));
-        }
+    return serialize_action_error(action, return_round_controller_status_to_string(roundStatus));
+}
 
-    } else {
-        json_response = serialize_action_error(action, "Action not recognized");
+// Sent by one of the players in the round
+static Message *route_round_make_move(const char *action, const RequestDTO *request, int client_socket) {
+
+    (void)client_socket;
+
+    int64_t out_id_round = -1;
+
+    RoundControllerStatus roundStatus = round_make_move(request->id_round, request->id_player, request->row, request->col, &out_id_round);
+    if (roundStatus == ROUND_CONTROLLER_OK) {
+        return serialize_action_success(action, "Move registered", out_id_round);
+    } else if (roundStatus == ROUND_CONTROLLER_STATE_VIOLATION) {
+        return serialize_action_error(action, "Not an active round");
+    } else if (roundStatus == ROUND_CONTROLLER_FORBIDDEN) {
+        return serialize_action_error(action, "Action not allowed");
+    } else if (roundStatus == ROUND_CONTROLLER_INVALID_INPUT) {
+        return serialize_action_error(action, "Invalid input values");
     }
 
+    return serialize_action_error(action, return_round_controller_status_to_string(roundStatus));
+}
 
-    /* === Send response === */
+// Sent by one of the players in the round
+static Message *route_round_end(const char *action, const RequestDTO *request, int client_socket) {
 
-    LOG_INFO("Server Router Response successfully built: %s\n", json_response);
-    if (json_response) {
-        if (send_server_response(client_socket, json_response) < 0) {
-            LOG_WARN("Error sending the Server Router Response to Client socket %d\n", client_socket);
-        } else {
-            LOG_DEBUG("Server Router Response sent: Client socket %d \n", client_socket);
-        }
+    (void)client_socket;
+
+    int64_t out_id_round = -1;
+
+    RoundControllerStatus roundStatus = round_end(request->id_round, request->id_player_ending_round, &out_id_round);
+    if (roundStatus == ROUND_CONTROLLER_OK)
+        return serialize_action_success(action, "Round closed", out_id_round);
+
+    return serialize_action_error(action, return_round_controller_status_to_string(roundStatus));
+}
+
+/* === Participation Request routes === */
+
+static Message *route_participation_requests_get_public_info(const char *action, const RequestDTO *request, int client_socket) {
+
+    (void)client_socket;
+
+    ParticipationRequestDTO *out_participation_requests = NULL;
+    int out_count = 0;
+
+    ParticipationRequestControllerStatus participationRequestStatus = participation_requests_get_public_info(request->state, request->id_game, &out_participation_requests, &out_count);
+    if (participationRequestStatus == PARTICIPATION_REQUEST_CONTROLLER_OK || participationRequestStatus == PARTICIPATION_REQUEST_CONTROLLER_NOT_FOUND) {
+        return serialize_participation_requests_to_json(action, out_participation_requests, out_count);
+    } else if (participationRequestStatus == PARTICIPATION_REQUEST_CONTROLLER_INVALID_INPUT) {
+        return serialize_action_error(action, "Invalid input values");
+    }
+
+    return serialize_action_error(action, return_participation_request_controller_status_to_string(participationRequestStatus));
+}
+
+static Message *route_participation_request_send(const char *action, const RequestDTO *request, int client_socket) {
+
+    (void)client_socket;
+
+    int64_t out_id_participation_request = -1;
+
+    ParticipationRequestControllerStatus participationRequestStatus = participation_request_send(request->id_game, request->id_player, &out_id_participation_request);
+    if (participationRequestStatus == PARTICIPATION_REQUEST_CONTROLLER_OK)
+        return serialize_action_success(action, "Participation request sent", out_id_participation_request);
+
+    return serialize_action_error(action, return_participation_request_controller_status_to_string(participationRequestStatus));
+}
+
+// Sent by the game owner
+static Message *route_participation_request_change_state(const char *action, const RequestDTO *request, int client_socket) {
+
+    (void)client_socket;
+
+    int64_t out_id_participation_request = -1;
+
+    ParticipationRequestControllerStatus participationRequestStatus = participation_request_change_state(request->id_participation_request, request->new_state, &out_id_participation_request);
+    if (participationRequestStatus == PARTICIPATION_REQUEST_CONTROLLER_OK) {
+        return serialize_action_success(action, "Participation request state changed", out_id_participation_request);
+    } else if (participationRequestStatus == PARTICIPATION_REQUEST_CONTROLLER_INVALID_INPUT) {
+        return serialize_action_error(action, "Invalid input values");
+    }
+
+    return serialize_action_error(action, return_participation_request_controller_status_to_string(participationRequestStatus));
+}
+
+// Sent by the participation request sender
+static Message *route_participation_request_cancel(const char *action, const RequestDTO *request, int client_socket) {
+
+    (void)client_socket;
+
+    int64_t out_id_participation_request = -1;
+
+    ParticipationRequestControllerStatus participationRequestStatus = participation_request_cancel(request->id_participation_request, request->id_player, &out_id_participation_request);
+    if (participationRequestStatus == PARTICIPATION_REQUEST_CONTROLLER_OK)
+        return serialize_action_success(action, "Participation request canceled", out_id_participation_request);
+
+    return serialize_action_error(action, return_participation_request_controller_status_to_string(participationRequestStatus));
+}
+
+// Sent by the game owner
+static Message *route_participation_request_reject_all(const char *action, const RequestDTO *request, int client_socket) {
+
+    (void)client_socket;
+
+    ParticipationRequestControllerStatus participationRequestStatus = participation_request_reject_all(request->requests, request->requests_count);
+    if (participationRequestStatus == PARTICIPATION_REQUEST_CONTROLLER_OK)
+        return serialize_action_success(action, "All Participation requests rejected", -1);
+
+    return serialize_action_error(action, return_participation_request_controller_status_to_string(participationRequestStatus));
+}
+
+/* === Play routes === */
+
+static Message *route_plays_get_public_info(const char *action, const RequestDTO *request, int client_socket) {
+
+    (void)client_socket;
+
+    PlayDTO *out_plays = NULL;
+    int out_count = 0;
+
+    PlayControllerStatus playStatus = plays_get_public_info(request->id_player, request->id_round, &out_plays, &out_count);
+    if (playStatus == PLAY_CONTROLLER_OK || playStatus == PLAY_CONTROLLER_NOT_FOUND)
+        return serialize_plays_to_json(action, out_plays, out_count);
+
+    return serialize_action_error(action, return_play_controller_status_to_string(playStatus));
+}
+
+/* === Notification routes === */
+
+// Sent by the game owner
+static Message *route_notification_rematch_game(const char *action, const RequestDTO *request, int client_socket) {
+
+    (void)client_socket;
+
+    NotificationDTO *out_notification = NULL;
+
+    NotificationControllerStatus notificationStatus = notification_rematch_game(request->id_game, request->id_sender, request->id_receiver, &out_notification);
+    if (notificationStatus != NOTIFICATION_CONTROLLER_OK)
+        return serialize_action_error(action, return_notification_controller_status_to_string(notificationStatus));
+
+    Message *json_response;
+    Message *json_message = serialize_notification_to_json(NULL, out_notification);
+    if (send_server_unicast_message(json_message, request->id_receiver) < 0 ) {
+        json_response = serialize_action_error(action, "Could not send rematch invitation");
     } else {
-        LOG_WARN("%s\n", "JSON response is empty");
-        return;
+        json_response = serialize_action_success(action, "Rematch invitation sent", -1);
     }
-    
-
-    /* === Free dynamically allocated variables */
-
-    if (action && (strcmp(action, "NULL") != 0))
-        free(action); 
-
-    if (nickname)
-        free(nickname);
-    if (email)
-        free(email);
-    if (password)
-        free(password);
-    if (out_player)
-        free(out_player);
-    
-    if (status)
-        free(status);
-    if (out_games)
-        free(out_games);
-
-    if (out_round)
-        free(out_round);
-
-    if (state)
-        free(state);
-    if (new_state)
-        free(new_state);
-    if (out_participation_requests)
-        free(out_participation_requests);
-
-    if (out_plays)
-        free(out_plays);
-
-    if (out_notification)
-        free(out_notification);
+    message_release(json_message);
 
-    if (json_response)
-        free(json_response);
-}
\ No newline at end of file
+    return json_response;
+}
@@ -2,24 +2,147 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <arpa/inet.h>
 #include <pthread.h>
+#include <arpa/inet.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 
 #include "../../include/debug_log.h"
 
+#include "arena.h"
 #include "server.h"
 #include "session_manager.h"
 #include "router.h"
+#include "worker_pool.h"
+#include "../json-parser/json-parser.h"
 
 SessionManager session_manager;
 
+// Workers running route_request(), fed by the reactor
+static WorkerPool request_pool;
+
+// Timers of the whole server, one tick per second. The reactor queues a tick on the workers when the second changes
+static TimerWheel server_timers;
+static pthread_once_t server_timers_once = PTHREAD_ONCE_INIT;
+static atomic_int timers_tick_queued;
+
+// A complete frame waiting to be routed
+typedef struct PendingFrame {
+    char *json_body;
+    int64_t req_id;             // Correlation id of the client, -1 if the frame has none
+    struct Connection *conn;    // Owner of the frame while it is routed on its own
+    struct PendingFrame *next;
+} PendingFrame;
+
+// A reference to a shared framed message waiting to be written to the socket
+typedef struct OutboundMessage {
+    struct OutboundMessage *next;
+    Message *message;
+    size_t sent;                // Bytes of the message already written
+} OutboundMessage;
+
+// State of a client socket, shared between the reactor and the workers
+typedef struct Connection {
+    int fd;
+
+    // Frame reader state, only touched by the reactor thread
+    unsigned char header[4];    // Length prefix of the current frame (big endian)
+    size_t header_read;         // Bytes of the length prefix received so far
+    char *body;                 // JSON body of the current frame, allocated once the length is known
+    uint32_t body_len;
+    uint32_t body_read;
+    int closing;                // Set when the connection must be closed at the end of the event
+
+    // Request state, protected by `lock`
+    pthread_mutex_t lock;
+    int refcount;               // One reference for the reactor, one for each scheduled worker job
+    int busy;                   // A worker is routing the frames of this connection
+    PendingFrame *pending_head; // Frames routed in arrival order by the worker owning the connection
+    PendingFrame *pending_tail;
+    int pending_count;
+    int independent_count;      // Frames with a `req_id` queued or being routed on their own
+    int rejected_count;         // Ordered frames rejected while busy, answered "Server busy" in their turn
+    int shut_down;              // No more frames will be routed
+
+    // Outbound state, protected by `lock`: every write to the socket goes through this queue,
+    // so messages sent by different threads are never interleaved
+    OutboundMessage *out_head;
+    OutboundMessage *out_tail;
+    size_t out_bytes;           // Bytes queued and not written yet
+    int write_failed;           // The socket can't be written anymore, new messages are discarded
+    int close_after_flush;      // Shut the socket down once the queue is empty (non-persistent requests)
+    int corked;                 // Requests being handled: frames are held and written together when one of them ends
+
+    time_t last_activity;       // Arrival of the last frame, protected by `lock`
+    Timer idle_timer;           // Closes the connection after IDLE_TIMEOUT_SECONDS without frames
+} Connection;
+
+/**
+ * Notification held back until the unit of work that produced it is committed,
+ * taken from the arena of the thread. `id_sender` is set for a broadcast, `id_receiver` for a unicast.
+ */
+typedef struct DeferredNotification {
+    struct DeferredNotification *next;
+    Message *message;
+    int64_t id_sender;
+    int64_t id_receiver;        // -1 for a broadcast
+} DeferredNotification;
+
 // ==================== Private functions ====================
 
-static void *handle_client(void *arg);
+static int set_non_blocking(int fd);
+static void accept_clients(int epoll_fd, int server_fd);
+static void handle_client_readable(Connection *conn);
+static int consume_frame_bytes(Connection *conn, const char *data, size_t len);
+static void dispatch_frame(Connection *conn);
+static void process_connection_frames(void *arg);
+static void process_independent_frame(void *arg);
+static void route_frame(Connection *conn, PendingFrame *frame);
+static int64_t frame_req_id(const char *json_body);
+static int64_t parse_req_id_value(const char *p);
+static const char *skip_json_space(const char *p);
+static void reject_frame(Connection *conn, int64_t req_id);
+static void drop_pending_frames(Connection *conn);
+static void close_client(int epoll_fd, Connection *conn);
+static void connection_release(Connection *conn);
+static int connection_register(Connection *conn);
+static Connection *connection_get(int fd);
+static int connection_send(Connection *conn, Message *message);
+static void connection_flush(Connection *conn);
+static void drop_outbound_messages(Connection *conn);
+static void connection_cork(Connection *conn);
+static void connection_uncork(Connection *conn);
+static void configure_client_socket(int fd);
+static void timers_init(void);
+static void run_timers(void *arg);
+static void connection_idle_timeout(int64_t fd);
+static int defer_notification(Message *message, int64_t id_sender, int64_t id_receiver);
+static int broadcast_now(Message *message, int64_t id_sender);
+static int unicast_now(Message *message, int64_t id_receiver);
 
 // ===========================================================
 
+// The listening socket is registered in epoll with this marker instead of a Connection pointer
+static char listener_marker;
+
+// Notifications of the thread being deferred, see server_notifications_defer()
+static _Thread_local bool notifications_deferred;
+static _Thread_local DeferredNotification *deferred_head;
+static _Thread_local DeferredNotification *deferred_tail;
+
+// Connections indexed by fd, so sessions (which only know the fd) can queue messages on them
+static Connection **connections;
+static size_t connections_size;
+static pthread_mutex_t connections_lock = PTHREAD_MUTEX_INITIALIZER;
+
 // This function starts the server
 int start_server(int port) {
     
@@ -27,6 +150,9 @@ int start_server(int port) {
     // This structure provides us with a way to describe a IPv4 (is provided by netinet.h library)
     struct sockaddr_in addr;
 
+    // A peer closing the socket while we are writing must not kill the whole process
+    signal(SIGPIPE, SIG_IGN);
+
     // With socket() function we're creating a new sockest, it returns a: 
     // integer < 0 in case of errors or a integer >= 0 which rapresents the assigned file descriptor
     if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
@@ -34,6 +160,10 @@ int start_server(int port) {
         return -1;
     }
 
+    // Allows a quick restart of the server without waiting for TIME_WAIT sockets to expire
+    int reuse = 1;
+    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
     addr.sin_family = AF_INET;              // It represents IPv4
     addr.sin_addr.s_addr = INADDR_ANY;      // It means "listen on all newtwork interfaces"
     addr.sin_port = htons(port);            // The listening port 
@@ -46,12 +176,19 @@ int start_server(int port) {
     }
 
     // listen() function puts the socket in passive mode (listening mode)
-    if(listen(server_fd, MAX_CLIENTS) < 0) {
+    if(listen(server_fd, LISTEN_BACKLOG) < 0) {
         perror("listen");
         close(server_fd);
         return -1;
     }
 
+    // The listening socket is non-blocking too: in edge-triggered mode we accept until EAGAIN
+    if (set_non_blocking(server_fd) < 0) {
+        perror("fcntl");
+        close(server_fd);
+        return -1;
+    }
+
     LOG_INFO("Server listens on port: %d... \n", port);
 
 
@@ -59,193 +196,958 @@ int start_server(int port) {
     session_manager_init(&session_manager);
     LOG_INFO("%s\n", "Session manager initialized. Ready to accept clients.");
 
-    // Infinite loops continue to accept clients 
+    pthread_once(&server_timers_once, timers_init);
+    time_t last_tick = time(NULL);
+
+    // The reactor only does I/O, the requests are routed by a fixed number of workers
+    if (worker_pool_init(&request_pool, WORKER_THREADS, WORKER_QUEUE_CAPACITY) < 0) {
+        close(server_fd);
+        return -1;
+    }
+
+    // epoll lets a single thread wait on every client socket at once (reactor pattern),
+    // so an idle client only costs a Connection struct instead of a whole thread stack
+    int epoll_fd = epoll_create1(0);
+    if (epoll_fd < 0) {
+        perror("epoll_create1");
+        close(server_fd);
+        return -1;
+    }
+
+    struct epoll_event ev = {
+        .events = EPOLLIN | EPOLLET,
+        .data.ptr = &listener_marker
+    };
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, server_fd, &ev) < 0) {
+        perror("epoll_ctl");
+        close(epoll_fd);
+        close(server_fd);
+        return -1;
+    }
+
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+
+    // Infinite loop that waits for socket events and reacts to them
     while(1) {
-        // For each iteration we will have a new address in the heap, in the handle_client function we read
-        // this value and then we relase him using free()
-        int *client_fd = malloc(sizeof(int));
 
-        // With accept() function we get out the estabilished connection in the queue 
-        *client_fd = accept(server_fd, NULL, NULL);
+        int n = epoll_wait(epoll_fd, events, MAX_EPOLL_EVENTS, TIMER_TICK_MS);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
 
-        if(*client_fd < 0) {
-            perror("accept");
-            free(client_fd);
-            continue;
+        // A new second: the expired timers run on a worker, their callbacks may need the database
+        time_t now = time(NULL);
+        if (now != last_tick && !atomic_exchange(&timers_tick_queued, 1)) {
+            last_tick = now;
+            if (worker_pool_submit(&request_pool, run_timers, NULL) < 0)
+                atomic_store(&timers_tick_queued, 0);
         }
 
-        // We can use a local variable because pthread_create() function assign to him a new tid every time
-        // handle_client is the function executed by the thread, client_fd the handle_client parameter
-        int errorNumber;
-        pthread_t tid;
-        if ((errorNumber = pthread_create(&tid, NULL, handle_client, client_fd) != 0)) {
-            errno=errorNumber;
-            perror("pthread_create");
-            continue;
+        for (int i = 0; i < n; i++) {
+
+            // New connections are waiting in the listen queue
+            if (events[i].data.ptr == &listener_marker) {
+                accept_clients(epoll_fd, server_fd);
+                continue;
+            }
+
+            Connection *conn = events[i].data.ptr;
+
+            if (events[i].events & EPOLLIN)
+                handle_client_readable(conn);
+
+            // The socket buffer has room again: resume writing the queued messages
+            if (events[i].events & EPOLLOUT) {
+                pthread_mutex_lock(&conn->lock);
+                connection_flush(conn);
+                pthread_mutex_unlock(&conn->lock);
+            }
+
+            // The peer hung up, an error occurred or the frame handling asked us to close
+            if ((events[i].events & (EPOLLHUP | EPOLLERR)) || conn->closing)
+                close_client(epoll_fd, conn);
         }
-        
-        // pthread_detach() marks the thread as "detached"
-        // This means that when the thread finishes, its resources are released automatically
-        // Therefore the parent thread does not need to call pthread_join() to clean up
-        pthread_detach(tid);
     }
 
+    worker_pool_shutdown(&request_pool);
+    close(epoll_fd);
     close(server_fd);
     return 0;
 }
 
-// Reads exactly that byte from the socket (or fails)
-// Returns: 1 = OK, 0 = connection closed, -1 = error
-static int recv_all(int fd, void *buf, size_t len) {
+static int set_non_blocking(int fd) {
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0)
+        return -1;
+
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+// Applies the write policy of server.h, a failure only costs latency
+static void configure_client_socket(int fd) {
+
+    int nodelay = SOCKET_TCP_NODELAY ? 1 : 0;
+
+    if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)) < 0)
+        LOG_WARN("setsockopt(TCP_NODELAY) failed for fd=%d: %s\n", fd, strerror(errno));
+}
+
+// Accepts every pending connection (edge-triggered: we must drain the listen queue)
+static void accept_clients(int epoll_fd, int server_fd) {
+
+    while (1) {
+        // With accept() function we get out the estabilished connection in the queue 
+        int client_fd = accept(server_fd, NULL, NULL);
+
+        if (client_fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                perror("accept");
+            return;
+        }
+
+        if (set_non_blocking(client_fd) < 0) {
+            perror("fcntl");
+            close(client_fd);
+            continue;
+        }
+
+        configure_client_socket(client_fd);
 
-    char *p = buf;
-    size_t remaining = len;
+        // The Connection only keeps the state of the frame being read, idle clients hold no buffers
+        Connection *conn = calloc(1, sizeof(Connection));
+        if (!conn) {
+            LOG_ERROR("malloc() failed for connection state fd=%d\n", client_fd);
+            close(client_fd);
+            continue;
+        }
+        conn->fd = client_fd;
+        conn->refcount = 1;
+        conn->last_activity = time(NULL);
+        pthread_mutex_init(&conn->lock, NULL);
+
+        if (connection_register(conn) < 0) {
+            pthread_mutex_destroy(&conn->lock);
+            free(conn);
+            close(client_fd);
+            continue;
+        }
+
+        // EPOLLOUT is edge-triggered too: it is reported only when a full socket buffer drains
+        struct epoll_event ev = {
+            .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+            .data.ptr = conn
+        };
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client_fd, &ev) < 0) {
+            perror("epoll_ctl");
+            close_client(epoll_fd, conn);
+            continue;
+        }
+
+        if (IDLE_TIMEOUT_SECONDS > 0)
+            server_timer_schedule(&conn->idle_timer, IDLE_TIMEOUT_SECONDS, connection_idle_timeout, client_fd);
+
+        LOG_INFO("Client fd=%d connected\n", client_fd);
+    }
+}
+
+// NB: We're using recv and send functions instead of read and write because we're working with socket
+
+// Reads everything available on the socket (edge-triggered: until EAGAIN) and feeds the frame parser
+static void handle_client_readable(Connection *conn) {
+
+    // Scratch buffer shared by every connection, since the reactor runs on a single thread
+    static char read_buffer[READ_BUFFER_SIZE];
+
+    while (!conn->closing) {
+        ssize_t n = recv(conn->fd, read_buffer, sizeof(read_buffer), 0);
 
-    while (remaining > 0) {
-        ssize_t n = recv(fd, p, remaining, 0);
         if (n < 0) {
             if (errno == EINTR) continue;
-            return -1;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            LOG_ERROR("recv() failed for fd=%d\n", conn->fd);
+            conn->closing = 1;
+            return;
         }
+
         if (n == 0) {
-            // peer has closed the connection
-            return 0;
+            //The client has closed the connection.
+            LOG_INFO("Client fd=%d closed the connection\n", conn->fd);
+            conn->closing = 1;
+            return;
         }
 
-        //Let's move forward in the buffer
-        p += n;
-        //We calculate the remainder
-        remaining -= n;
+        if (consume_frame_bytes(conn, read_buffer, (size_t)n) < 0)
+            conn->closing = 1;
     }
+}
 
-    return 1;
+/**
+ * Incremental parser of the length-prefixed frames: [4 bytes length (big endian)] + [JSON body].
+ * A frame can be split across many reads and a read can contain many frames.
+ * @return `0` if every byte has been consumed, `-1` if the connection must be closed.
+ */
+static int consume_frame_bytes(Connection *conn, const char *data, size_t len) {
+
+    while (len > 0 && !conn->closing) {
+
+        // Still reading the 4-byte header (it contains the length of the JSON)
+        if (conn->header_read < sizeof(conn->header)) {
+            size_t missing = sizeof(conn->header) - conn->header_read;
+            size_t chunk = len < missing ? len : missing;
+
+            memcpy(conn->header + conn->header_read, data, chunk);
+            conn->header_read += chunk;
+            data += chunk;
+            len -= chunk;
+
+            if (conn->header_read < sizeof(conn->header))
+                return 0;
+
+            uint32_t len_net;
+            memcpy(&len_net, conn->header, sizeof(len_net));
+            conn->body_len = ntohl(len_net);
+
+            if (conn->body_len == 0) {
+                LOG_WARN("Received empty frame from fd=%d\n", conn->fd);
+                conn->header_read = 0;
+                continue; //I don't know, but I'll keep the connection open.
+            }
+
+            //Maximum limit for security, e.g., 1MB per frame
+            if (conn->body_len > MAX_FRAME_SIZE) {
+                LOG_WARN("Frame too large (%u bytes) from fd=%d\n", conn->body_len, conn->fd);
+                return -1;
+            }
+
+            //I allocate the buffer for JSON
+            conn->body = malloc(conn->body_len + 1);
+            if (!conn->body) {
+                LOG_ERROR("malloc() failed for JSON body (len=%u) fd=%d\n", conn->body_len, conn->fd);
+                return -1;
+            }
+            conn->body_read = 0;
+        }
+
+        // Reading the JSON body
+        size_t missing = conn->body_len - conn->body_read;
+        size_t chunk = len < missing ? len : missing;
+
+        memcpy(conn->body + conn->body_read, data, chunk);
+        conn->body_read += chunk;
+        data += chunk;
+        len -= chunk;
+
+        if (conn->body_read == conn->body_len)
+            dispatch_frame(conn);
+    }
+
+    return 0;
 }
 
-// NB: We're using recv and send functions instead of read and write because we're working with socket
+/**
+ * Hands a complete frame to the workers and gets the parser ready for the next one.
+ * Frames of the same connection are routed one at a time, in arrival order: if a worker is
+ * already serving the connection the frame is appended to its pending list, otherwise a job is queued.
+ * A frame carrying a `req_id` is independent instead: the client matches its response by id,
+ * so it gets a job of its own and runs concurrently with the other frames of the connection.
+ * Past MAX_PENDING_FRAMES the frame is answered "Server busy". An ordered frame that arrives while
+ * earlier ones are still queued gets the answer in its turn, so it never overtakes their responses.
+ */
+static void dispatch_frame(Connection *conn) {
+
+    PendingFrame *frame = malloc(sizeof(PendingFrame));
+    if (!frame) {
+        LOG_ERROR("malloc() failed for pending frame fd=%d\n", conn->fd);
+        conn->closing = 1;
+        return;
+    }
 
-// "worker function" that manages a single client 
-static void *handle_client(void *arg) {
+    //I end the string
+    frame->json_body = conn->body;
+    frame->json_body[conn->body_len] = '\0';
+    frame->req_id = frame_req_id(frame->json_body);
+    frame->conn = conn;
+    frame->next = NULL;
 
-    int client_fd = *(int*)arg;
-    free(arg);
+    conn->body = NULL;
+    conn->body_len = 0;
+    conn->body_read = 0;
+    conn->header_read = 0;
 
-    while (1) {
+    LOG_DEBUG("Full message received: %s\n", frame->json_body);
 
-        //I read the 4-byte header (it contains the length of the JSON)
-        uint32_t len_net = 0;
+    pthread_mutex_lock(&conn->lock);
 
-        int r = recv_all(client_fd, &len_net, sizeof(len_net));
+    conn->last_activity = time(NULL);
 
-        if (r == 0) {
-            //The client has closed the connection.
-            LOG_INFO("Client fd=%d closed the connection (while reading header)\n", client_fd);
-            break;
-        } else if (r < 0) {
-            LOG_ERROR("recv_all() failed on header for fd=%d\n", client_fd);
-            break;
+    if (conn->shut_down) {
+        pthread_mutex_unlock(&conn->lock);
+        free(frame->json_body);
+        free(frame);
+        return;
+    }
+
+    if (conn->pending_count + conn->independent_count >= MAX_PENDING_FRAMES) {
+        LOG_WARN("Too many pending frames on fd=%d, request rejected\n", conn->fd);
+
+        free(frame->json_body);
+        frame->json_body = NULL;
+
+        // An ordered frame is answered in its turn, after the responses of the frames before it
+        if (frame->req_id < 0 && conn->busy) {
+            if (conn->rejected_count >= MAX_REJECTED_FRAMES) {
+                pthread_mutex_unlock(&conn->lock);
+                LOG_WARN("Client fd=%d keeps sending while overloaded, disconnecting it\n", conn->fd);
+                free(frame);
+                conn->closing = 1;
+                return;
+            }
+
+            if (conn->pending_tail)
+                conn->pending_tail->next = frame;
+            else
+                conn->pending_head = frame;
+            conn->pending_tail = frame;
+            conn->rejected_count++;
+            pthread_mutex_unlock(&conn->lock);
+            return;
         }
 
-        uint32_t len = ntohl(len_net);
+        pthread_mutex_unlock(&conn->lock);
+        reject_frame(conn, frame->req_id);
+        free(frame);
+        return;
+    }
 
-        if (len == 0) {
-            LOG_WARN("Received empty frame from fd=%d\n", client_fd);
-            continue; //I don't know, but I'll keep the connection open.
-        }
+    if (frame->req_id >= 0) {
+        conn->independent_count++;
+        conn->refcount++;
+        pthread_mutex_unlock(&conn->lock);
 
-        //(optional) maximum limit for security, e.g., 1MB per open connection
-        if (len > 1024 * 1024) {
-            LOG_WARN("Frame too large (%u bytes) from fd=%d\n", len, client_fd);
-            break;
+        if (worker_pool_submit(&request_pool, process_independent_frame, frame) < 0) {
+            LOG_WARN("Worker queue full, request from fd=%d rejected\n", conn->fd);
+
+            pthread_mutex_lock(&conn->lock);
+            conn->independent_count--;
+            conn->refcount--;
+            pthread_mutex_unlock(&conn->lock);
+
+            reject_frame(conn, frame->req_id);
+            free(frame->json_body);
+            free(frame);
         }
+        return;
+    }
+
+    if (conn->pending_tail)
+        conn->pending_tail->next = frame;
+    else
+        conn->pending_head = frame;
+    conn->pending_tail = frame;
+    conn->pending_count++;
+
+    // The worker already serving this connection will pick the frame up
+    if (conn->busy) {
+        pthread_mutex_unlock(&conn->lock);
+        return;
+    }
+
+    conn->busy = 1;
+    conn->refcount++;
+    pthread_mutex_unlock(&conn->lock);
+
+    if (worker_pool_submit(&request_pool, process_connection_frames, conn) < 0) {
+        LOG_WARN("Worker queue full, request from fd=%d rejected\n", conn->fd);
+
+        // Nobody was serving the connection, so the frame we just appended is the only one
+        pthread_mutex_lock(&conn->lock);
+        drop_pending_frames(conn);
+        conn->busy = 0;
+        conn->refcount--;
+        pthread_mutex_unlock(&conn->lock);
 
-        //I allocate the buffer for JSON
-        char *json_body = malloc(len + 1);
-        if (!json_body) {
-            LOG_ERROR("malloc() failed for JSON body (len=%u) fd=%d\n", len, client_fd);
+        reject_frame(conn, -1);
+    }
+}
+
+// Worker job: routes the pending frames of a connection until none is left
+static void process_connection_frames(void *arg) {
+
+    Connection *conn = arg;
+
+    while (1) {
+        pthread_mutex_lock(&conn->lock);
+
+        PendingFrame *frame = conn->pending_head;
+        if (!frame) {
+            conn->busy = 0;
+            pthread_mutex_unlock(&conn->lock);
             break;
         }
 
-        //I read the JSON body
-        r = recv_all(client_fd, json_body, len);
-        if (r == 0) {
-            LOG_INFO("Client fd=%d closed the connection (while reading body)\n", client_fd);
-            free(json_body);
-            break;
-        } else if (r < 0) {
-            LOG_ERROR("recv_all() failed on body for fd=%d\n", client_fd);
-            free(json_body);
-            break;
+        conn->pending_head = frame->next;
+        if (!conn->pending_head)
+            conn->pending_tail = NULL;
+
+        // A frame without a body was rejected when it arrived, it only holds its place in the order
+        if (!frame->json_body) {
+            conn->rejected_count--;
+            pthread_mutex_unlock(&conn->lock);
+
+            reject_frame(conn, -1);
+            free(frame);
+            continue;
         }
 
-        //I end the string
-        json_body[len] = '\0';
+        conn->pending_count--;
+
+        pthread_mutex_unlock(&conn->lock);
 
-        LOG_INFO("Full message received: %s\n", json_body);
+        route_frame(conn, frame);
 
-        int persistence = 1; //by default, we keep it open
-        route_request(json_body, client_fd, &persistence);
+        // A connection may drain many frames in one job: each request starts from an empty arena
+        arena_reset(arena_thread());
+    }
+
+    connection_release(conn);
+}
 
-        free(json_body);
+// Worker job: routes a single frame that carries a `req_id`
+static void process_independent_frame(void *arg) {
 
-        //If the route tells us that it is a non-persistent connection, we close it.
-        if (persistence == 0) {
-            LOG_INFO("Closing connection with fd=%d (non-persistent)\n", client_fd);
-            break;
+    PendingFrame *frame = arg;
+    Connection *conn = frame->conn;
+
+    pthread_mutex_lock(&conn->lock);
+    int shut_down = conn->shut_down;
+    pthread_mutex_unlock(&conn->lock);
+
+    if (shut_down) {
+        free(frame->json_body);
+        free(frame);
+    } else {
+        route_frame(conn, frame);
+    }
+
+    pthread_mutex_lock(&conn->lock);
+    conn->independent_count--;
+    pthread_mutex_unlock(&conn->lock);
+
+    connection_release(conn);
+}
+
+// Routes a frame and frees it, then closes the connection if the request was non-persistent
+static void route_frame(Connection *conn, PendingFrame *frame) {
+
+    int persistence = 1; //by default, we keep it open
+    connection_cork(conn);
+    route_request(frame->json_body, conn->fd, &persistence);
+    connection_uncork(conn);
+
+    free(frame->json_body);
+    free(frame);
+
+    //If the route tells us that it is a non-persistent connection, we close it.
+    if (persistence == 0) {
+        LOG_INFO("Closing connection with fd=%d (non-persistent)\n", conn->fd);
+
+        // The response may still be queued: the socket is shut down once it has been written,
+        // then the reactor will see the end of the stream and close the connection
+        pthread_mutex_lock(&conn->lock);
+        conn->shut_down = 1;
+        conn->close_after_flush = 1;
+        drop_pending_frames(conn);
+        connection_flush(conn);
+        pthread_mutex_unlock(&conn->lock);
+    }
+}
+
+static const char *skip_json_space(const char *p) {
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+        p++;
+    return p;
+}
+
+// Value of a `req_id` key, `p` points right after its colon. `-1` unless it is an integer in [0, REQUEST_ID_MAX]
+static int64_t parse_req_id_value(const char *p) {
+
+    p = skip_json_space(p);
+    if (*p < '0' || *p > '9')
+        return -1;
+
+    int64_t req_id = 0;
+    for (; *p >= '0' && *p <= '9'; p++) {
+        req_id = req_id * 10 + (*p - '0');
+        if (req_id > REQUEST_ID_MAX)
+            return -1;
+    }
+
+    // A fraction or an exponent makes it a double
+    p = skip_json_space(p);
+    return *p == ',' || *p == '}' ? req_id : -1;
+}
+
+/**
+ * Finds the `req_id` of a frame without parsing it, so the reactor can tell independent frames apart.
+ * Only a key of the top-level object counts: the operations of a batch carry ids of their own.
+ * Strings are skipped whole, so a key or a brace inside a value is never mistaken for one.
+ * The decoder applies the same rules when it reads the key again: a duplicated key keeps its last value.
+ * @return The id, `-1` if the frame has none or it is not an integer in [0, REQUEST_ID_MAX].
+ */
+static int64_t frame_req_id(const char *json_body) {
+
+    const char *p = skip_json_space(json_body);
+    if (*p != '{')
+        return -1;
+
+    int64_t req_id = -1;
+    int depth = 0;
+
+    for (; *p; p++) {
+        switch (*p) {
+            case '{':
+            case '[':
+                depth++;
+                break;
+            case '}':
+            case ']':
+                if (--depth == 0)
+                    return req_id;
+                break;
+            case '"': {
+                const char *string = p + 1;
+                for (p++; *p && *p != '"'; p++) {
+                    if (*p == '\\' && p[1])
+                        p++;
+                }
+                if (!*p)
+                    return -1;
+
+                // A key of the top-level object is a string followed by a colon
+                const char *after = skip_json_space(p + 1);
+                if (depth == 1 && *after == ':' && p - string == 6 && memcmp(string, "req_id", 6) == 0)
+                    req_id = parse_req_id_value(after + 1);
+                break;
+            }
+            default:
+                break;
         }
     }
 
+    return -1;
+}
+
+// Answers a frame that cannot be routed because the server is overloaded
+static void reject_frame(Connection *conn, int64_t req_id) {
+
+    Message *message = serialize_action_error(NULL, "Server busy");
+    if (message && req_id >= 0)
+        message = add_req_id_to_json(message, req_id);
+
+    if (!message || connection_send(conn, message) < 0)
+        LOG_WARN("Error sending the busy response to Client socket %d\n", conn->fd);
+
+    message_release(message);
+}
+
+// Must be called with `conn->lock` held
+static void drop_pending_frames(Connection *conn) {
+
+    PendingFrame *frame = conn->pending_head;
+
+    while (frame) {
+        PendingFrame *next = frame->next;
+        free(frame->json_body);
+        free(frame);
+        frame = next;
+    }
+
+    conn->pending_head = NULL;
+    conn->pending_tail = NULL;
+    conn->pending_count = 0;
+    conn->rejected_count = 0;
+}
+
+static void close_client(int epoll_fd, Connection *conn) {
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+
+    pthread_mutex_lock(&conn->lock);
+    conn->shut_down = 1;
+    conn->write_failed = 1;
+    drop_pending_frames(conn);
+    drop_outbound_messages(conn);
+    pthread_mutex_unlock(&conn->lock);
+
+    free(conn->body);
+    conn->body = NULL;
+
+    connection_release(conn);
+}
+
+/**
+ * Drops a reference to the connection. The socket is closed only by the last owner,
+ * so its fd cannot be reused by a new client while a worker is still answering on it.
+ */
+static void connection_release(Connection *conn) {
+
+    pthread_mutex_lock(&conn->lock);
+    int last = --conn->refcount == 0;
+    pthread_mutex_unlock(&conn->lock);
+
+    if (!last)
+        return;
+
+    // Nobody can take a new reference once the count is zero (see connection_get())
+    pthread_mutex_lock(&connections_lock);
+    if ((size_t)conn->fd < connections_size && connections[conn->fd] == conn)
+        connections[conn->fd] = NULL;
+    pthread_mutex_unlock(&connections_lock);
+
     //Remove the session if it exists
-    session_remove(&session_manager, client_fd);
-    LOG_INFO("Client fd=%d closed the connection\n", client_fd);
+    session_remove(&session_manager, conn->fd);
+    LOG_INFO("Client fd=%d closed the connection\n", conn->fd);
     print_session_list(&session_manager);
 
-    close(client_fd);
-    return NULL;
+    server_timer_cancel(&conn->idle_timer);
+    drop_outbound_messages(conn);
+    close(conn->fd);
+    pthread_mutex_destroy(&conn->lock);
+    free(conn);
 }
 
-static int send_all(int fd, const void *buf, size_t len) {
-    const char *p = buf;
-    while (len > 0) {
-        ssize_t n = send(fd, p, len, 0);
-        if (n < 0) {
-            if (errno == EINTR) continue; 
+// ==================== Timers ====================
+
+// Timers may be scheduled before the server starts (e.g. by the controllers at startup)
+static void timers_init(void) {
+    timer_wheel_init(&server_timers, (uint64_t)time(NULL));
+}
+
+// Worker job: runs the timers expired since the last tick
+static void run_timers(void *arg) {
+    (void)arg;
+
+    timer_wheel_advance(&server_timers, (uint64_t)time(NULL));
+    atomic_store(&timers_tick_queued, 0);
+}
+
+/**
+ * Schedules `callback(key)` in `seconds`, on a worker thread. A timer already scheduled is moved.
+ * The timer must be cancelled with server_timer_cancel() before its memory is released.
+ */
+void server_timer_schedule(Timer *timer, int seconds, TimerCallback callback, int64_t key) {
+    pthread_once(&server_timers_once, timers_init);
+    timer_wheel_schedule(&server_timers, timer, (uint64_t)time(NULL) + (uint64_t)(seconds > 0 ? seconds : 0), callback, key);
+}
+
+void server_timer_cancel(Timer *timer) {
+    pthread_once(&server_timers_once, timers_init);
+    timer_wheel_cancel(&server_timers, timer);
+}
+
+/**
+ * Idle timer of a connection. Frames don't touch the timer, they only update `last_activity`:
+ * when it expires on a connection that was used meanwhile, it is moved to the new deadline.
+ * An idle connection is shut down, then the reactor sees the end of the stream and closes it.
+ */
+static void connection_idle_timeout(int64_t fd) {
+
+    Connection *conn = connection_get((int)fd);
+    if (!conn)
+        return;
+
+    pthread_mutex_lock(&conn->lock);
+
+    time_t now = time(NULL);
+    time_t idle_until = conn->last_activity + IDLE_TIMEOUT_SECONDS;
+
+    // Frames still being routed, ordered or independent, have replies to come: the connection is not idle
+    if (idle_until > now || conn->busy || conn->independent_count > 0) {
+        server_timer_schedule(&conn->idle_timer, idle_until > now ? (int)(idle_until - now) : IDLE_TIMEOUT_SECONDS,
+                              connection_idle_timeout, fd);
+    } else if (!conn->shut_down) {
+        LOG_INFO("Client fd=%d idle for %d seconds, closing the connection\n", conn->fd, IDLE_TIMEOUT_SECONDS);
+        conn->shut_down = 1;
+        shutdown(conn->fd, SHUT_RDWR);
+    }
+
+    pthread_mutex_unlock(&conn->lock);
+
+    connection_release(conn);
+}
+
+// ==================== Connection table ====================
+
+// Makes the connection reachable from its fd, growing the table if needed
+static int connection_register(Connection *conn) {
+
+    pthread_mutex_lock(&connections_lock);
+
+    if ((size_t)conn->fd >= connections_size) {
+        size_t new_size = connections_size ? connections_size : 1024;
+        while (new_size <= (size_t)conn->fd)
+            new_size *= 2;
+
+        Connection **tmp = realloc(connections, new_size * sizeof(Connection*));
+        if (!tmp) {
+            pthread_mutex_unlock(&connections_lock);
+            LOG_ERROR("malloc() failed for connection table (fd=%d)\n", conn->fd);
             return -1;
         }
-        if (n == 0) return -1; // closed connection
-        p   += n;
-        len -= n;
+
+        memset(tmp + connections_size, 0, (new_size - connections_size) * sizeof(Connection*));
+        connections = tmp;
+        connections_size = new_size;
     }
+
+    connections[conn->fd] = conn;
+
+    pthread_mutex_unlock(&connections_lock);
     return 0;
 }
 
-int send_framed_json(int fd, const char *json) {
+/**
+ * Looks up the connection of a fd and takes a reference to it.
+ * @return The connection, to be given back with connection_release(). `NULL` if the fd is not connected.
+ */
+static Connection *connection_get(int fd) {
+
+    if (fd < 0)
+        return NULL;
+
+    pthread_mutex_lock(&connections_lock);
+
+    Connection *conn = (size_t)fd < connections_size ? connections[fd] : NULL;
+    if (conn) {
+        pthread_mutex_lock(&conn->lock);
+        int alive = conn->refcount > 0;     // Zero: already being destroyed by its last owner
+        if (alive)
+            conn->refcount++;
+        pthread_mutex_unlock(&conn->lock);
+        if (!alive)
+            conn = NULL;
+    }
 
-    if (!json) return -1;
-    uint32_t len = (uint32_t)strlen(json);
-    uint32_t len_net = htonl(len);
+    pthread_mutex_unlock(&connections_lock);
+    return conn;
+}
 
-    if (send_all(fd, &len_net, sizeof(len_net)) < 0) {
-        LOG_ERROR("Failed to send length header to fd=%d\n", fd);
+// ==================== Outbound queue ====================
+
+/**
+ * Appends a reference to the message to the outbound queue of the connection, then writes
+ * as much as the socket accepts without blocking. What is left is written by the reactor on EPOLLOUT.
+ * A client that doesn't read lets its queue grow: once more than OUTBOUND_HIGH_WATER_MARK bytes are
+ * waiting it is disconnected instead of holding memory (or worse, a thread) for everybody else.
+ * Only the bytes already queued count, so a single large response to a client that keeps up is still sent.
+ * @return `0` if the message has been queued, `-1` otherwise.
+ */
+static int connection_send(Connection *conn, Message *message) {
+
+    OutboundMessage *out = malloc(sizeof(OutboundMessage));
+    if (!out) {
+        LOG_ERROR("malloc() failed for outbound message fd=%d\n", conn->fd);
         return -1;
     }
 
-    if (send_all(fd, json, len) < 0) {
-        LOG_ERROR("Failed to send JSON body to fd=%d\n", fd);
+    out->message = message;
+    out->sent = 0;
+    out->next = NULL;
+
+    pthread_mutex_lock(&conn->lock);
+
+    if (conn->write_failed) {
+        pthread_mutex_unlock(&conn->lock);
+        free(out);
         return -1;
     }
+
+    if (conn->out_bytes > OUTBOUND_HIGH_WATER_MARK) {
+        LOG_WARN("Client fd=%d is not reading (%zu bytes queued), disconnecting it\n", conn->fd, conn->out_bytes);
+        conn->write_failed = 1;
+        drop_outbound_messages(conn);
+        // The reactor will see the end of the stream and close the connection
+        shutdown(conn->fd, SHUT_RDWR);
+        pthread_mutex_unlock(&conn->lock);
+        free(out);
+        return -1;
+    }
+
+    message_retain(message);
+
+    int was_empty = conn->out_head == NULL;
+
+    if (conn->out_tail)
+        conn->out_tail->next = out;
+    else
+        conn->out_head = out;
+    conn->out_tail = out;
+    conn->out_bytes += message->len;
+
+    // If older messages are queued the socket is full and the reactor is already waiting for EPOLLOUT,
+    // if the connection is corked they will be written when its request is done
+    if (was_empty && !conn->corked)
+        connection_flush(conn);
+
+    pthread_mutex_unlock(&conn->lock);
     return 0;
 }
 
+/**
+ * Writes the queued messages until the queue is empty or the socket buffer is full.
+ * Consecutive frames are gathered in a single sendmsg(), so a burst of responses and notifications
+ * costs one syscall instead of one per frame. Must be called with `conn->lock` held
+ */
+static void connection_flush(Connection *conn) {
+
+    while (conn->out_head && !conn->write_failed) {
+        struct iovec iov[FLUSH_MAX_IOVECS];
+        int iovcnt = 0;
+
+        for (OutboundMessage *out = conn->out_head; out && iovcnt < FLUSH_MAX_IOVECS; out = out->next) {
+            iov[iovcnt].iov_base = out->message->data + out->sent;
+            iov[iovcnt].iov_len = out->message->len - out->sent;
+            iovcnt++;
+        }
+
+        struct msghdr msg = { .msg_iov = iov, .msg_iovlen = iovcnt };
+
+        ssize_t n = sendmsg(conn->fd, &msg, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            LOG_WARN("sendmsg() failed for fd=%d: %s\n", conn->fd, strerror(errno));
+            conn->write_failed = 1;
+            drop_outbound_messages(conn);
+            return;
+        }
+
+        conn->out_bytes -= (size_t)n;
+
+        // Release the frames written completely, the last one may have been written only in part
+        size_t written = (size_t)n;
+        while (written > 0) {
+            OutboundMessage *out = conn->out_head;
+            size_t left = out->message->len - out->sent;
+
+            if (written < left) {
+                out->sent += written;
+                break;
+            }
+
+            written -= left;
+            conn->out_head = out->next;
+            if (!conn->out_head)
+                conn->out_tail = NULL;
+            message_release(out->message);
+            free(out);
+        }
+    }
+
+    if (conn->close_after_flush && !conn->out_head)
+        shutdown(conn->fd, SHUT_RDWR);
+}
+
+// Holds the frames queued on the connection until connection_uncork()
+static void connection_cork(Connection *conn) {
+
+    pthread_mutex_lock(&conn->lock);
+#if SOCKET_TCP_CORK && defined(TCP_CORK)
+    if (conn->corked == 0) {
+        int on = 1;
+        setsockopt(conn->fd, IPPROTO_TCP, TCP_CORK, &on, sizeof(on));
+    }
+#endif
+    conn->corked++;
+    pthread_mutex_unlock(&conn->lock);
+}
+
+/**
+ * Writes every frame queued while the connection was corked. Each request that ends flushes the queue,
+ * so concurrent requests of the same connection never hold each other's responses back.
+ */
+static void connection_uncork(Connection *conn) {
+
+    pthread_mutex_lock(&conn->lock);
+    conn->corked--;
+    connection_flush(conn);
+#if SOCKET_TCP_CORK && defined(TCP_CORK)
+    if (conn->corked == 0) {
+        int off = 0;
+        setsockopt(conn->fd, IPPROTO_TCP, TCP_CORK, &off, sizeof(off));
+    }
+#endif
+    pthread_mutex_unlock(&conn->lock);
+}
+
+// Must be called with `conn->lock` held
+static void drop_outbound_messages(Connection *conn) {
+
+    OutboundMessage *out = conn->out_head;
+
+    while (out) {
+        OutboundMessage *next = out->next;
+        message_release(out->message);
+        free(out);
+        out = next;
+    }
+
+    conn->out_head = NULL;
+    conn->out_tail = NULL;
+    conn->out_bytes = 0;
+}
+
+// Queues a framed message for the client connected on `fd`, the caller keeps its own reference
+int send_framed_message(int fd, Message *message) {
+
+    if (!message) return -1;
+
+    Connection *conn = connection_get(fd);
+    if (!conn) {
+        LOG_WARN("No connection for fd=%d\n", fd);
+        return -1;
+    }
+
+    int result = connection_send(conn, message);
+    connection_release(conn);
+
+    return result;
+}
+
+/**
+ * Takes a reference to the connection of a fd, for a sender that must not lose track of its client:
+ * while it is held the fd cannot be closed, so it cannot be reused by a new client either.
+ * @return The connection, to be given back with server_connection_release(). `NULL` if the fd is not connected.
+ */
+Connection *server_connection_acquire(int fd) {
+    return connection_get(fd);
+}
+
+// Queues a framed message on a connection taken with server_connection_acquire(), the caller keeps its own reference
+int server_connection_send(Connection *conn, Message *message) {
+
+    if (!conn || !message) return -1;
+
+    return connection_send(conn, message);
+}
+
+void server_connection_release(Connection *conn) {
+    connection_release(conn);
+}
 
-int send_server_response(int client_socket, const char *data) {
+int send_server_response(int client_socket, Message *response) {
 
-    if(client_socket < 0 || !data) {
-        LOG_WARN("Invalid parameters: socket = %d, data = %p\n",
-                 client_socket, (void*)data);
+    if(client_socket < 0 || !response) {
+        LOG_WARN("Invalid parameters: socket = %d, response = %p\n",
+                 client_socket, (void*)response);
         return -1;
     }
 
-    if (send_framed_json(client_socket, data) < 0) {
+    if (send_framed_message(client_socket, response) < 0) {
         LOG_ERROR("Failed to send framed JSON to client socket %d\n", client_socket);
         return -1;
     }
@@ -255,28 +1157,56 @@ int send_server_response(int client_socket, const char *data) {
 
 
 
-int send_server_broadcast_message(const char *message, int64_t id_sender) {
+int send_server_broadcast_message(Message *message, int64_t id_sender) {
+
+    if (notifications_deferred)
+        return defer_notification(message, id_sender, -1);
+
+    return broadcast_now(message, id_sender);
+}
 
-    Session session_sender;
+int send_server_unicast_message(Message *message, int64_t id_receiver) {
 
-    if(id_sender > 0) {
-        if(!(session_find_by_id_player(&session_manager, id_sender, &session_sender))) {
-            LOG_WARN("%s", "Session not found");
+    if (notifications_deferred) {
+        // A receiver without a session fails now, as it would if the message were sent right away
+        Session receiverSession;
+        if (!session_find_by_id_player(&session_manager, id_receiver, &receiverSession)) {
+            LOG_WARN("%s", "Receiver session not found\n");
             return -1;
         }
+        return defer_notification(message, -1, id_receiver);
     }
 
-    if (session_broadcast(&session_manager, message, session_sender.fd) < 0) {
+    return unicast_now(message, id_receiver);
+}
+
+static int broadcast_now(Message *message, int64_t id_sender) {
+
+    Session session_sender = { .fd = -1 };
+
+    // A sender without a session (the bot, or a player who just left) has nobody to be excluded
+    if (id_sender > 0 && !session_find_by_id_player(&session_manager, id_sender, &session_sender))
+        session_sender.fd = -1;
+
+    // Framed once by the serializer, every recipient queues a reference to the same buffer
+    if (!message) {
+        LOG_WARN("%s\n", "Broadcast message is empty");
+        return -1;
+    }
+
+    int result = session_broadcast(&session_manager, message, session_sender.fd);
+
+    if (result < 0) {
         LOG_WARN("Error in sending broadcast message from sender %" PRId64 "\n", id_sender);
         return -1;
     } else {
-        LOG_DEBUG("Sent message from sender %" PRId64 ": %s\n", id_sender, message);
+        LOG_DEBUG("Sent message from sender %" PRId64 ": %s\n", id_sender, message_body(message));
     }
 
     return 0;
 }
 
-int send_server_unicast_message(const char *message, int64_t id_receiver) {
+static int unicast_now(Message *message, int64_t id_receiver) {
 
     Session receiverSession;  
 
@@ -293,3 +1223,61 @@ int send_server_unicast_message(const char *message, int64_t id_receiver) {
     int fd = receiverSession.fd; 
     return session_unicast(&session_manager, message, fd);
 }
+
+/**
+ * Holds back the broadcasts and unicasts of the calling thread until server_notifications_flush(),
+ * for a unit of work that may still be rolled back: clients must not hear about state that never existed.
+ */
+void server_notifications_defer(void) {
+    notifications_deferred = true;
+}
+
+/**
+ * Ends server_notifications_defer(): the held notifications are sent in the order they were produced
+ * if `deliver` is true (the work was committed), dropped otherwise.
+ */
+void server_notifications_flush(bool deliver) {
+
+    notifications_deferred = false;
+
+    DeferredNotification *deferred = deferred_head;
+    deferred_head = NULL;
+    deferred_tail = NULL;
+
+    for (; deferred; deferred = deferred->next) {
+        if (deliver) {
+            if (deferred->id_receiver >= 0)
+                unicast_now(deferred->message, deferred->id_receiver);
+            else
+                broadcast_now(deferred->message, deferred->id_sender);
+        }
+        message_release(deferred->message);
+    }
+}
+
+// Keeps a reference to the message until the notifications of the thread are flushed
+static int defer_notification(Message *message, int64_t id_sender, int64_t id_receiver) {
+
+    if (!message) {
+        LOG_WARN("%s\n", "Deferred message is empty");
+        return -1;
+    }
+
+    DeferredNotification *deferred = arena_alloc(arena_thread(), sizeof(DeferredNotification));
+    if (!deferred)
+        return -1;
+
+    message_retain(message);
+    deferred->message = message;
+    deferred->id_sender = id_sender;
+    deferred->id_receiver = id_receiver;
+    deferred->next = NULL;
+
+    if (deferred_tail)
+        deferred_tail->next = deferred;
+    else
+        deferred_head = deferred;
+    deferred_tail = deferred;
+
+    return 0;
+}
@@ -2,13 +2,71 @@
 #define SERVER_H
 
 #include <inttypes.h>
+#include <stdbool.h>
 
-#define MAX_CLIENTS 100
+#include "message.h"
+#include "timer_wheel.h"
+
+#define LISTEN_BACKLOG 1024             // Pending connections queued by the kernel before accept()
+#define MAX_EPOLL_EVENTS 256            // Socket events handled by each epoll_wait() call
+#define READ_BUFFER_SIZE (64 * 1024)    // Bytes read from a socket with a single recv()
+#define MAX_FRAME_SIZE (1024 * 1024)    // Maximum accepted JSON body size (1MB)
+
+// Request workers, can be overridden at compile time (e.g. `make CPPFLAGS=-DWORKER_THREADS=16`)
+#ifndef WORKER_THREADS
+#define WORKER_THREADS 8                // Threads running route_request()
+#endif
+#ifndef WORKER_QUEUE_CAPACITY
+#define WORKER_QUEUE_CAPACITY 1024      // Connections waiting for a worker before answering "Server busy"
+#endif
+#ifndef MAX_PENDING_FRAMES
+#define MAX_PENDING_FRAMES 32           // Frames waiting on a single connection before answering "Server busy"
+#endif
+#ifndef MAX_REJECTED_FRAMES
+#define MAX_REJECTED_FRAMES 1024        // Frames waiting for their "Server busy" answer before the client is disconnected
+#endif
+#ifndef OUTBOUND_HIGH_WATER_MARK
+#define OUTBOUND_HIGH_WATER_MARK (1024 * 1024) // Bytes queued for a client that doesn't read before it is disconnected
+#endif
+#ifndef IDLE_TIMEOUT_SECONDS
+#define IDLE_TIMEOUT_SECONDS 1800       // Connections that send no frame for this long are closed, 0 never closes them
+#endif
+#define TIMER_TICK_MS 1000              // Longest wait of the reactor before the timers are checked (one tick per second)
+#ifndef FLUSH_MAX_IOVECS
+#define FLUSH_MAX_IOVECS 64             // Queued frames coalesced in a single sendmsg()
+#endif
+
+/**
+ * Client socket write policy. Frames produced while a request is being handled are held in the
+ * connection queue and written together when the handler returns (e.g. a move response and the
+ * notifications addressed to the same client), so Nagle only adds latency and is disabled by default.
+ * SOCKET_TCP_CORK also corks the socket in the kernel for the duration of the request (Linux only),
+ * which costs two more syscalls per request but merges frames written by other threads meanwhile.
+ */
+#ifndef SOCKET_TCP_NODELAY
+#define SOCKET_TCP_NODELAY 1
+#endif
+#ifndef SOCKET_TCP_CORK
+#define SOCKET_TCP_CORK 0
+#endif
+
+// A client connection, referenced while a message is queued for it
+typedef struct Connection Connection;
 
 int start_server(int port);
-int send_server_response(int client_socket, const char* data);
-int send_server_broadcast_message(const char *message, int64_t id_sender);
-int send_server_unicast_message(const char *message, int64_t id_receiver);
-int send_framed_json(int fd, const char *json);
+int send_server_response(int client_socket, Message *response);
+int send_server_broadcast_message(Message *message, int64_t id_sender);
+int send_server_unicast_message(Message *message, int64_t id_receiver);
+int send_framed_message(int fd, Message *message);
+
+Connection *server_connection_acquire(int fd);
+int server_connection_send(Connection *conn, Message *message);
+void server_connection_release(Connection *conn);
+
+void server_notifications_defer(void);
+void server_notifications_flush(bool deliver);
+
+void server_timer_schedule(Timer *timer, int seconds, TimerCallback callback, int64_t key);
+void server_timer_cancel(Timer *timer);
 
 #endif
\ No newline at end of file
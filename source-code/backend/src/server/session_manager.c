@@ -1,4 +1,5 @@
 #include <string.h>
+#include <stdlib.h>
 #include <sys/socket.h> 
 #include <inttypes.h>
 #include <stdbool.h>
@@ -7,6 +8,125 @@
 #include "session_manager.h"
 #include "../../include/debug_log.h"
 
+struct SessionNode {
+    Session session;
+    SessionNode *next_by_fd;
+    SessionNode *next_by_id_player;
+    SessionNode *next_by_nickname;
+};
+
+// ===================== Hash indexes =====================
+
+static size_t hash_fd(int fd) {
+    return (size_t)(unsigned int)fd * 2654435761u;
+}
+
+static size_t hash_id_player(int64_t id_player) {
+    uint64_t h = (uint64_t)id_player;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (size_t)h;
+}
+
+// FNV-1a
+static size_t hash_nickname(const char *nickname) {
+    uint64_t h = 1469598103934665603ULL;
+    for (const unsigned char *c = (const unsigned char *)nickname; *c; c++) {
+        h ^= *c;
+        h *= 1099511628211ULL;
+    }
+    return (size_t)h;
+}
+
+static void link_node(SessionManager *manager, SessionNode *node) {
+
+    size_t mask = manager->bucket_count - 1;
+
+    size_t b = hash_fd(node->session.fd) & mask;
+    node->next_by_fd = manager->by_fd[b];
+    manager->by_fd[b] = node;
+
+    b = hash_id_player(node->session.id_player) & mask;
+    node->next_by_id_player = manager->by_id_player[b];
+    manager->by_id_player[b] = node;
+
+    b = hash_nickname(node->session.nickname) & mask;
+    node->next_by_nickname = manager->by_nickname[b];
+    manager->by_nickname[b] = node;
+}
+
+// Removes the node from the id_player and nickname chains, the fd chain is handled by the caller
+static void unlink_node_secondary(SessionManager *manager, SessionNode *node) {
+
+    size_t mask = manager->bucket_count - 1;
+
+    SessionNode **link = &manager->by_id_player[hash_id_player(node->session.id_player) & mask];
+    while (*link && *link != node)
+        link = &(*link)->next_by_id_player;
+    if (*link)
+        *link = node->next_by_id_player;
+
+    link = &manager->by_nickname[hash_nickname(node->session.nickname) & mask];
+    while (*link && *link != node)
+        link = &(*link)->next_by_nickname;
+    if (*link)
+        *link = node->next_by_nickname;
+}
+
+static SessionNode *find_node_by_fd(SessionManager *manager, int fd) {
+
+    SessionNode *node = manager->by_fd[hash_fd(fd) & (manager->bucket_count - 1)];
+    while (node && node->session.fd != fd)
+        node = node->next_by_fd;
+
+    return node;
+}
+
+/**
+ * Doubles the buckets of the three indexes and relinks every session.
+ * @return `0` on success, `-1` if the memory could not be allocated (the indexes are left untouched).
+ */
+static int grow_indexes(SessionManager *manager) {
+
+    size_t new_count = manager->bucket_count * 2;
+
+    SessionNode **by_fd = calloc(new_count, sizeof(SessionNode*));
+    SessionNode **by_id_player = calloc(new_count, sizeof(SessionNode*));
+    SessionNode **by_nickname = calloc(new_count, sizeof(SessionNode*));
+    if (!by_fd || !by_id_player || !by_nickname) {
+        free(by_fd);
+        free(by_id_player);
+        free(by_nickname);
+        return -1;
+    }
+
+    SessionNode **old_by_fd = manager->by_fd;
+    size_t old_count = manager->bucket_count;
+
+    free(manager->by_id_player);
+    free(manager->by_nickname);
+
+    manager->by_fd = by_fd;
+    manager->by_id_player = by_id_player;
+    manager->by_nickname = by_nickname;
+    manager->bucket_count = new_count;
+
+    for (size_t b = 0; b < old_count; b++) {
+        SessionNode *node = old_by_fd[b];
+        while (node) {
+            SessionNode *next = node->next_by_fd;
+            link_node(manager, node);
+            node = next;
+        }
+    }
+
+    free(old_by_fd);
+    return 0;
+}
+
+// ===================== Session management =====================
+
 void session_manager_init(SessionManager *manager) {
 
     if (!manager) {
@@ -15,16 +135,20 @@ void session_manager_init(SessionManager *manager) {
     }
 
     manager->count = 0;
+    manager->bucket_count = SESSION_INITIAL_BUCKETS;
+    manager->by_fd = calloc(SESSION_INITIAL_BUCKETS, sizeof(SessionNode*));
+    manager->by_id_player = calloc(SESSION_INITIAL_BUCKETS, sizeof(SessionNode*));
+    manager->by_nickname = calloc(SESSION_INITIAL_BUCKETS, sizeof(SessionNode*));
     pthread_mutex_init(&manager->lock, NULL);
 
-    for (int i = 0; i < MAX_SESSION; i++) {
-        manager->list[i].fd = -1;                
-        manager->list[i].id_player = -1;         
-        manager->list[i].active = 0;              
-        manager->list[i].nickname[0] = '\0';    
-    }
+    if (!manager->by_fd || !manager->by_id_player || !manager->by_nickname)
+        LOG_ERROR("%s\n", "malloc() failed for session manager indexes");
 }
 
+/**
+ * Binds a player to a connection. If the connection already has a session (e.g. a second sign in),
+ * that session is replaced.
+ */
 void session_add(SessionManager *manager, int fd, int64_t id_player, const char *nickname) {
 
     if (!manager) {
@@ -34,25 +158,48 @@ void session_add(SessionManager *manager, int fd, int64_t id_player, const char
 
     pthread_mutex_lock(&manager->lock);
 
-    if (manager->count >= MAX_SESSION) {
-        LOG_WARN("Cannot add session: session list full (%d active)\n", manager->count);
+    SessionNode *node = find_node_by_fd(manager, fd);
+
+    if (node) {
+        unlink_node_secondary(manager, node);
+
+        // Relink only in the id_player and nickname chains, the fd is the same
+        size_t mask = manager->bucket_count - 1;
+        node->session.id_player = id_player;
+        strncpy(node->session.nickname, nickname, sizeof(node->session.nickname) - 1);
+        node->session.nickname[sizeof(node->session.nickname) - 1] = '\0';
+
+        size_t b = hash_id_player(id_player) & mask;
+        node->next_by_id_player = manager->by_id_player[b];
+        manager->by_id_player[b] = node;
+
+        b = hash_nickname(node->session.nickname) & mask;
+        node->next_by_nickname = manager->by_nickname[b];
+        manager->by_nickname[b] = node;
+
         pthread_mutex_unlock(&manager->lock);
         return;
     }
 
-    for (int i = 0; i < MAX_SESSION; i++) {
-        if (!manager->list[i].active) {
-            manager->list[i].fd = fd;
-            manager->list[i].id_player = id_player;
-            strncpy(manager->list[i].nickname, nickname, sizeof(manager->list[i].nickname) - 1);
-            manager->list[i].nickname[sizeof(manager->list[i].nickname) - 1] = '\0';
-            manager->list[i].active = 1;
-            manager->count++;
+    if ((size_t)manager->count >= manager->bucket_count && grow_indexes(manager) < 0)
+        LOG_WARN("Cannot grow session indexes (%d active), lookups will be slower\n", manager->count);
 
-            break;
-        }
+    node = calloc(1, sizeof(SessionNode));
+    if (!node) {
+        LOG_ERROR("%s\n", "malloc() failed for session");
+        pthread_mutex_unlock(&manager->lock);
+        return;
     }
 
+    node->session.fd = fd;
+    node->session.id_player = id_player;
+    strncpy(node->session.nickname, nickname, sizeof(node->session.nickname) - 1);
+    node->session.nickname[sizeof(node->session.nickname) - 1] = '\0';
+    node->session.active = 1;
+
+    link_node(manager, node);
+    manager->count++;
+
     pthread_mutex_unlock(&manager->lock);
 }
 
@@ -65,17 +212,23 @@ void session_remove(SessionManager *manager, int fd) {
 
     pthread_mutex_lock(&manager->lock);
 
-    for (int i = 0; i < MAX_SESSION; i++) {
-        if (manager->list[i].fd == fd && manager->list[i].active) {
-            manager->list[i].active = 0;
-            manager->count--;
-            break;
-        }
+    SessionNode **link = &manager->by_fd[hash_fd(fd) & (manager->bucket_count - 1)];
+    while (*link && (*link)->session.fd != fd)
+        link = &(*link)->next_by_fd;
+
+    SessionNode *node = *link;
+    if (node) {
+        *link = node->next_by_fd;
+        unlink_node_secondary(manager, node);
+        manager->count--;
+        free(node);
     }
 
     pthread_mutex_unlock(&manager->lock);
 }
 
+// ===================== Find session =====================
+
 int session_find_by_fd(SessionManager *manager, int fd, Session *out) {
 
     if (!manager) {
@@ -85,18 +238,12 @@ int session_find_by_fd(SessionManager *manager, int fd, Session *out) {
 
     pthread_mutex_lock(&manager->lock);
 
-    for (int i = 0; i < MAX_SESSION; i++) {
-        if (manager->list[i].fd == fd && manager->list[i].active) {
-
-            *out = manager->list[i];
-            pthread_mutex_unlock(&manager->lock);
-            return 1;
-
-        }
-    }
+    SessionNode *node = find_node_by_fd(manager, fd);
+    if (node)
+        *out = node->session;
 
     pthread_mutex_unlock(&manager->lock);
-    return 0;
+    return node != NULL;
 }
 
 int session_find_by_id_player(SessionManager *manager, int64_t id_player, Session *out) {
@@ -108,83 +255,103 @@ int session_find_by_id_player(SessionManager *manager, int64_t id_player, Sessio
 
     pthread_mutex_lock(&manager->lock);
 
-    for (int i = 0; i < MAX_SESSION; i++) {
-        if (manager->list[i].id_player == id_player && manager->list[i].active) {
+    SessionNode *node = manager->by_id_player[hash_id_player(id_player) & (manager->bucket_count - 1)];
+    while (node && node->session.id_player != id_player)
+        node = node->next_by_id_player;
 
-            //We do a safe copy
-            *out = manager->list[i];
-            pthread_mutex_unlock(&manager->lock);
-            return 1;
-        }
-    }
+    //We do a safe copy
+    if (node)
+        *out = node->session;
 
     pthread_mutex_unlock(&manager->lock);
-    return 0;
+    return node != NULL;
 }
 
 int session_find_by_nickname(SessionManager *manager, const char *nickname, Session *out) {
 
-    if (!manager) {
-        LOG_WARN("%s\n", "SessionManager pointer is NULL");
+    if (!manager || !nickname) {
+        LOG_WARN("%s\n", "SessionManager pointer or nickname is NULL");
         return 0;
     }
 
     pthread_mutex_lock(&manager->lock);
 
-    for (int i = 0; i < MAX_SESSION; i++) {
-        if (manager->list[i].active && strcmp(manager->list[i].nickname, nickname) == 0) {
-            
-            *out = manager->list[i];
-            pthread_mutex_unlock(&manager->lock);
-            return 1;
-        }
-    }
+    SessionNode *node = manager->by_nickname[hash_nickname(nickname) & (manager->bucket_count - 1)];
+    while (node && strcmp(node->session.nickname, nickname) != 0)
+        node = node->next_by_nickname;
+
+    if (node)
+        *out = node->session;
 
     pthread_mutex_unlock(&manager->lock);
-    return 0;
+    return node != NULL;
 }
 
-int session_broadcast(SessionManager *manager, const char *message, int sender_fd) {
+// ===================== Message sender =====================
+
+int session_broadcast(SessionManager *manager, Message *message, int sender_fd) {
 
     if (!manager) {
         LOG_WARN("%s\n", "SessionManager pointer is NULL");
         return -1;
     }
 
-    if (!message || strlen(message) == 0) {
+    if (!message) {
         LOG_WARN("%s\n", "Broadcast message is empty");
         return -1;
     }
 
+    // Snapshot the recipients, then queue the message without holding the lock:
+    // sending never waits on a slow client, but it shouldn't hold up session lookups either.
+    // Each recipient is referenced while the session still lists it, so a client that disconnects
+    // meanwhile keeps its fd until the message is queued and a new client can't receive it.
     pthread_mutex_lock(&manager->lock);
 
-    int result = 0; // 0 = ok, -1 se almeno un invio fallisce
+    Connection **conns = malloc((size_t)(manager->count > 0 ? manager->count : 1) * sizeof(Connection *));
+    if (!conns) {
+        pthread_mutex_unlock(&manager->lock);
+        LOG_ERROR("%s\n", "malloc() failed for broadcast recipients");
+        return -1;
+    }
 
-    for (int i = 0; i < MAX_SESSION; i++) {
-        if (manager->list[i].active && manager->list[i].fd != sender_fd) {
-            int fd = manager->list[i].fd;
+    int n_conns = 0;
+    for (size_t b = 0; b < manager->bucket_count; b++) {
+        for (SessionNode *node = manager->by_fd[b]; node; node = node->next_by_fd) {
+            if (node->session.fd == sender_fd)
+                continue;
 
-            if (send_framed_json(fd, message) < 0) {
-                LOG_WARN("Broadcast send() failed for fd %d\n", fd);
-                result = -1;  // segniamo l'errore ma continuiamo con gli altri
-            }
+            Connection *conn = server_connection_acquire(node->session.fd);
+            if (conn)
+                conns[n_conns++] = conn;
         }
     }
 
     pthread_mutex_unlock(&manager->lock);
 
+    int result = 0; // 0 = ok, -1 se almeno un invio fallisce
+
+    for (int i = 0; i < n_conns; i++) {
+        if (server_connection_send(conns[i], message) < 0) {
+            LOG_WARN("%s\n", "Broadcast send() failed for a recipient");
+            result = -1;  // segniamo l'errore ma continuiamo con gli altri
+        }
+        server_connection_release(conns[i]);
+    }
+
+    free(conns);
+
     return result;
 }
 
 
-int session_unicast(SessionManager *manager, const char *message, int receiver_fd) {
+int session_unicast(SessionManager *manager, Message *message, int receiver_fd) {
 
     if (!manager) {
         LOG_WARN("%s\n", "SessionManager pointer is NULL");
         return -1;
     }
 
-    if (!message || strlen(message) == 0) {
+    if (!message) {
         LOG_WARN("%s\n", "Unicast message is empty");
         return -1;
     }
@@ -202,28 +369,21 @@ int session_unicast(SessionManager *manager, const char *message, int receiver_f
         return -1;
     }
 
-    bool found = false;
-
-    for (int i = 0; i < MAX_SESSION; i++) {
-        if (manager->list[i].active && manager->list[i].fd == receiver_fd) {
-            found = true;
+    // The connection is referenced while the session still lists it, see session_broadcast()
+    Connection *conn = find_node_by_fd(manager, receiver_fd) ? server_connection_acquire(receiver_fd) : NULL;
 
-            int fd = manager->list[i].fd;
-
-            if (send_framed_json(fd, message) < 0) {
-                LOG_WARN("send() failed for fd %d\n", receiver_fd);
-                pthread_mutex_unlock(&manager->lock);
-                return -1;
-            }
+    pthread_mutex_unlock(&manager->lock);
 
-            break;
-        }
+    if (!conn) {
+        LOG_WARN("Unicast failed: receiver fd %d not found in active sessions\n", receiver_fd);
+        return -1;
     }
 
-    pthread_mutex_unlock(&manager->lock);
+    int result = server_connection_send(conn, message);
+    server_connection_release(conn);
 
-    if (!found) {
-        LOG_WARN("Unicast failed: receiver fd %d not found in active sessions\n", receiver_fd);
+    if (result < 0) {
+        LOG_WARN("send() failed for fd %d\n", receiver_fd);
         return -1;
     }
 
@@ -232,15 +392,21 @@ int session_unicast(SessionManager *manager, const char *message, int receiver_f
 
 void print_session_list(SessionManager *manager) {
 
-    if(!manager) {
+    // Walking every session on each disconnection is only worth it when debugging
+    if(!manager || !LOG_ENABLED(LOG_SEVERITY_DEBUG)) {
         return;
     }
 
-    LOG_INFO("%s\n", "Connection List:");
-    for(int i=0; i<MAX_SESSION; i++) {
-        if(manager->list[i].active == 1) {
-            LOG_INFO(" %d) Player ID: %" PRId64 ",\t Nickname: %s,\t fd: %d,\t", i, manager->list[i].id_player, manager->list->nickname, manager->list[i].fd);
+    pthread_mutex_lock(&manager->lock);
+
+    LOG_DEBUG("Connection List (%d):\n", manager->count);
+    int i = 0;
+    for (size_t b = 0; b < manager->bucket_count; b++) {
+        for (SessionNode *node = manager->by_fd[b]; node; node = node->next_by_fd) {
+            LOG_DEBUG(" %d) Player ID: %" PRId64 ",\t Nickname: %s,\t fd: %d,\t", i++, node->session.id_player, node->session.nickname, node->session.fd);
         }
     }
 
+    pthread_mutex_unlock(&manager->lock);
+
 }
@@ -3,9 +3,13 @@
 
 #include <pthread.h>
 #include <stdint.h>
+#include <stddef.h>
 
+#include "message.h"
 
-#define MAX_SESSION 100
+
+// Buckets of each index when the manager is created, they double whenever the sessions outnumber them
+#define SESSION_INITIAL_BUCKETS 64
 
 // This struct rapresents the single user session  
  typedef struct {
@@ -16,13 +20,21 @@
 } Session;
 
 
+// A session linked in the three indexes of the manager
+typedef struct SessionNode SessionNode;
+
 /**
  * This struct rapresents the user session container.
+ * Every session is reachable in O(1) from its fd, its id_player and its nickname through three hash tables
+ * with separate chaining, which grow with the number of sessions.
  * In this struct we have a mutex which provides a secure access to resource since
- * we have multiple threads that can modify the list simultaneosuly
+ * we have multiple threads that can modify the sessions simultaneosuly
  */
 typedef struct {
-    Session list[MAX_SESSION];      // We use array because we have a few sessions (We should use different structures)
+    SessionNode **by_fd;            // Buckets indexed by fd
+    SessionNode **by_id_player;     // Buckets indexed by id_player
+    SessionNode **by_nickname;      // Buckets indexed by nickname
+    size_t bucket_count;            // Buckets of each index, always a power of two
     int count;                      // Active session number
     pthread_mutex_t lock;           // Mutex "by structure"
 } SessionManager;
@@ -41,8 +53,8 @@ int session_find_by_nickname(SessionManager *manager, const char* nickname, Sess
 
 // ===================== Message sender =====================
 
-int session_broadcast(SessionManager *manager, const char *message, int sender_fd);
-int session_unicast(SessionManager *manager, const char *message, int receiver_fd);
+int session_broadcast(SessionManager *manager, Message *message, int sender_fd);
+int session_unicast(SessionManager *manager, Message *message, int receiver_fd);
 
 // ===================== Utilities =====================
 
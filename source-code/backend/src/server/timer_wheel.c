@@ -0,0 +1,173 @@
+#include "timer_wheel.h"
+
+#define FIRE_BATCH 64                   // Callbacks collected before releasing the lock to run them
+
+typedef struct {
+    TimerCallback callback;
+    int64_t key;
+} ExpiredTimer;
+
+// ==================== Private functions ====================
+
+static void link_timer(TimerWheel *wheel, Timer *timer, uint64_t earliest);
+static void unlink_timer(Timer *timer);
+static void cascade(TimerWheel *wheel, uint64_t tick);
+
+// ===========================================================
+
+void timer_wheel_init(TimerWheel *wheel, uint64_t now) {
+
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for (int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+            Timer *head = &wheel->slots[level][slot];
+            head->prev = head;
+            head->next = head;
+        }
+    }
+
+    wheel->now = now;
+    wheel->count = 0;
+    pthread_mutex_init(&wheel->lock, NULL);
+}
+
+/**
+ * Puts the timer in the slot of its expiry, at the lowest level whose range reaches it.
+ * Expired timers go off at `earliest`, the first tick not processed yet,
+ * the ones beyond the last level wait in its farthest slot.
+ * Must be called with `wheel->lock` held.
+ */
+static void link_timer(TimerWheel *wheel, Timer *timer, uint64_t earliest) {
+
+    uint64_t expires = timer->expires > earliest ? timer->expires : earliest;
+    uint64_t delta = expires - wheel->now;
+
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >> (TIMER_WHEEL_BITS * (level + 1)))
+        level++;
+
+    if (delta >> (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))
+        expires = wheel->now + ((uint64_t)1 << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1;
+
+    Timer *head = &wheel->slots[level][(expires >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1)];
+
+    timer->next = head;
+    timer->prev = head->prev;
+    head->prev->next = timer;
+    head->prev = timer;
+}
+
+static void unlink_timer(Timer *timer) {
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->prev = NULL;
+    timer->next = NULL;
+}
+
+/**
+ * (Re)schedules a timer to run `callback(key)` at tick `expires`.
+ */
+void timer_wheel_schedule(TimerWheel *wheel, Timer *timer, uint64_t expires, TimerCallback callback, int64_t key) {
+
+    pthread_mutex_lock(&wheel->lock);
+
+    if (timer->next)
+        unlink_timer(timer);
+    else
+        wheel->count++;
+
+    timer->expires = expires;
+    timer->callback = callback;
+    timer->key = key;
+    link_timer(wheel, timer, wheel->now + 1);
+
+    pthread_mutex_unlock(&wheel->lock);
+}
+
+// Unschedules the timer, if it is scheduled. It must be called before freeing a scheduled timer
+void timer_wheel_cancel(TimerWheel *wheel, Timer *timer) {
+
+    pthread_mutex_lock(&wheel->lock);
+
+    if (timer->next) {
+        unlink_timer(timer);
+        wheel->count--;
+    }
+
+    pthread_mutex_unlock(&wheel->lock);
+}
+
+/**
+ * Moves the timers of the upper levels whose slot starts at `tick` one level closer to expiry.
+ * Must be called with `wheel->lock` held.
+ */
+static void cascade(TimerWheel *wheel, uint64_t tick) {
+
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+
+        uint64_t span = (uint64_t)1 << (TIMER_WHEEL_BITS * level);
+        if (tick & (span - 1))
+            return;
+
+        Timer *head = &wheel->slots[level][(tick >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1)];
+        if (head->next == head)
+            continue;
+
+        // Detach the whole list first: a timer may be linked back into the same slot
+        Timer *timer = head->next;
+        head->prev->next = NULL;
+        head->prev = head;
+        head->next = head;
+
+        while (timer) {
+            Timer *next = timer->next;
+            link_timer(wheel, timer, tick);
+            timer = next;
+        }
+    }
+}
+
+/**
+ * Processes every tick up to `now`, running the callbacks of the expired timers.
+ * Callbacks run without the lock held, so they can schedule or cancel timers themselves.
+ */
+void timer_wheel_advance(TimerWheel *wheel, uint64_t now) {
+
+    ExpiredTimer expired[FIRE_BATCH];
+
+    pthread_mutex_lock(&wheel->lock);
+
+    // Nothing to run: skip the idle ticks at once
+    if (wheel->count == 0 && wheel->now < now)
+        wheel->now = now;
+
+    while (wheel->now < now) {
+
+        uint64_t tick = ++wheel->now;
+        cascade(wheel, tick);
+
+        Timer *head = &wheel->slots[0][tick & (TIMER_WHEEL_SLOTS - 1)];
+
+        while (head->next != head) {
+            int count = 0;
+
+            while (head->next != head && count < FIRE_BATCH) {
+                Timer *timer = head->next;
+                unlink_timer(timer);
+                wheel->count--;
+
+                expired[count].callback = timer->callback;
+                expired[count].key = timer->key;
+                count++;
+            }
+
+            pthread_mutex_unlock(&wheel->lock);
+
+            for (int i = 0; i < count; i++)
+                expired[i].callback(expired[i].key);
+
+            pthread_mutex_lock(&wheel->lock);
+        }
+    }
+
+    pthread_mutex_unlock(&wheel->lock);
+}
@@ -0,0 +1,46 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TIMER_WHEEL_LEVELS 4            // 64^4 ticks (about six months of seconds) can be scheduled ahead
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+
+/**
+ * Function run when a timer expires. It only gets the key given to timer_wheel_schedule(),
+ * never the timer itself: the owner may free the timer while the callback is running,
+ * so the callback looks the owner up again and checks the deadline still holds.
+ */
+typedef void (*TimerCallback)(int64_t key);
+
+// Intrusive timer, embedded in the structure it belongs to and zero-initialized
+typedef struct Timer {
+    struct Timer *prev;
+    struct Timer *next;                 // `NULL` while the timer is not scheduled
+    uint64_t expires;                   // Tick of expiry
+    TimerCallback callback;
+    int64_t key;
+} Timer;
+
+/**
+ * Hierarchical timer wheel: level `l` has 64 slots of 64^l ticks each.
+ * A timer is linked in the slot of its expiry at the lowest level that can hold it and moves one
+ * level down when the wheel reaches that slot, so scheduling and cancelling are O(1)
+ * and every tick only visits the timers that are due.
+ */
+typedef struct {
+    Timer slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS]; // Sentinel heads of circular lists
+    uint64_t now;                       // Last tick processed
+    size_t count;                       // Timers scheduled
+    pthread_mutex_t lock;
+} TimerWheel;
+
+void timer_wheel_init(TimerWheel *wheel, uint64_t now);
+void timer_wheel_schedule(TimerWheel *wheel, Timer *timer, uint64_t expires, TimerCallback callback, int64_t key);
+void timer_wheel_cancel(TimerWheel *wheel, Timer *timer);
+void timer_wheel_advance(TimerWheel *wheel, uint64_t now);
+
+#endif
@@ -0,0 +1,136 @@
+#include <stdlib.h>
+
+#include "../../include/debug_log.h"
+
+#include "arena.h"
+#include "worker_pool.h"
+
+// ==================== Private functions ====================
+
+static void *worker_loop(void *arg);
+
+// ===========================================================
+
+/**
+ * Starts `thread_count` workers waiting on a queue of at most `capacity` jobs.
+ * @return `0` on success, `-1` if the pool could not be created.
+ */
+int worker_pool_init(WorkerPool *pool, int thread_count, size_t capacity) {
+
+    if (!pool || thread_count <= 0 || capacity == 0) {
+        LOG_WARN("%s\n", "Invalid worker pool parameters");
+        return -1;
+    }
+
+    pool->threads = calloc((size_t)thread_count, sizeof(pthread_t));
+    pool->queue = calloc(capacity, sizeof(WorkerJob));
+    if (!pool->threads || !pool->queue) {
+        LOG_ERROR("%s\n", "malloc() failed for worker pool");
+        free(pool->threads);
+        free(pool->queue);
+        return -1;
+    }
+
+    pool->thread_count = 0;
+    pool->capacity = capacity;
+    pool->head = 0;
+    pool->count = 0;
+    pool->stopping = 0;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->not_empty, NULL);
+
+    for (int i = 0; i < thread_count; i++) {
+        if (pthread_create(&pool->threads[i], NULL, worker_loop, pool) != 0) {
+            LOG_ERROR("pthread_create() failed for worker %d\n", i);
+            worker_pool_shutdown(pool);
+            return -1;
+        }
+        pool->thread_count++;
+    }
+
+    LOG_INFO("Worker pool started: %d threads, queue capacity %zu\n", thread_count, capacity);
+    return 0;
+}
+
+/**
+ * Enqueues a job without blocking the caller.
+ * @return `0` if the job has been queued, `-1` if the queue is full (the caller keeps ownership of `arg`).
+ */
+int worker_pool_submit(WorkerPool *pool, WorkerJobFunction function, void *arg) {
+
+    if (!pool || !function)
+        return -1;
+
+    pthread_mutex_lock(&pool->lock);
+
+    if (pool->stopping || pool->count == pool->capacity) {
+        pthread_mutex_unlock(&pool->lock);
+        return -1;
+    }
+
+    size_t tail = (pool->head + pool->count) % pool->capacity;
+    pool->queue[tail].function = function;
+    pool->queue[tail].arg = arg;
+    pool->count++;
+
+    pthread_cond_signal(&pool->not_empty);
+    pthread_mutex_unlock(&pool->lock);
+
+    return 0;
+}
+
+// Stops the workers once the queued jobs have been executed and releases the pool
+void worker_pool_shutdown(WorkerPool *pool) {
+
+    if (!pool)
+        return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->not_empty);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->thread_count; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->not_empty);
+
+    free(pool->threads);
+    free(pool->queue);
+    pool->threads = NULL;
+    pool->queue = NULL;
+    pool->thread_count = 0;
+}
+
+static void *worker_loop(void *arg) {
+
+    WorkerPool *pool = arg;
+
+    while (1) {
+        pthread_mutex_lock(&pool->lock);
+
+        while (pool->count == 0 && !pool->stopping)
+            pthread_cond_wait(&pool->not_empty, &pool->lock);
+
+        // The queue is drained before stopping
+        if (pool->count == 0 && pool->stopping) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+
+        WorkerJob job = pool->queue[pool->head];
+        pool->head = (pool->head + 1) % pool->capacity;
+        pool->count--;
+
+        pthread_mutex_unlock(&pool->lock);
+
+        job.function(job.arg);
+
+        // Whatever the job took from the arena of this thread is released at once
+        arena_reset(arena_thread());
+    }
+
+    arena_destroy(arena_thread());
+    return NULL;
+}
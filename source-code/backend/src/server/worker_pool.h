@@ -0,0 +1,38 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+// Function executed by a worker thread, `arg` is the pointer given to worker_pool_submit()
+typedef void (*WorkerJobFunction)(void *arg);
+
+typedef struct {
+    WorkerJobFunction function;
+    void *arg;
+} WorkerJob;
+
+/**
+ * Fixed-size pool of threads consuming a bounded job queue.
+ * The queue is a ring buffer protected by a mutex, so any thread can submit (multi-producer)
+ * and any worker can take the next job (multi-consumer).
+ */
+typedef struct {
+    pthread_t *threads;
+    int thread_count;
+
+    WorkerJob *queue;           // Ring buffer of `capacity` jobs
+    size_t capacity;
+    size_t head;                // Index of the next job to run
+    size_t count;               // Jobs waiting in the queue
+
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;   // Signaled when a job is submitted or the pool is stopping
+    int stopping;
+} WorkerPool;
+
+int worker_pool_init(WorkerPool *pool, int thread_count, size_t capacity);
+int worker_pool_submit(WorkerPool *pool, WorkerJobFunction function, void *arg);
+void worker_pool_shutdown(WorkerPool *pool);
+
+#endif